@@ -0,0 +1,292 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_C11_SPSC_RING_H
+#define LIFTOFF_CLI_C11_SPSC_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A bounded, lock-free ring buffer which passes
+ * values from exactly one producer thread to exactly one
+ * consumer thread. This is implemented for C++11.
+ *
+ * Either side may close the ring. The consumer still
+ * receives every value pushed before the ring was closed,
+ * while any later push fails, so a consumer that stops
+ * early does not leave the producer blocked.
+ *
+ * A side blocked on a full or empty ring spins briefly,
+ * then yields, and then parks on a condition variable
+ * which the other side signals, so an idle ring does not
+ * keep a core busy.
+ *
+ * @tparam T the type of value passed through the ring
+ */
+template<typename T>
+class c11_spsc_ring {
+private:
+    /**
+     * The number of times to retry a full or empty ring
+     * before yielding the thread.
+     */
+    static const int SPIN_LIMIT = 64;
+    /**
+     * The number of times to yield the thread before
+     * parking it.
+     */
+    static const int YIELD_LIMIT = 16;
+    /**
+     * The longest time a parked thread waits before
+     * checking the ring again, ms.
+     */
+    static const int PARK_TIMEOUT_MS = 10;
+
+    /**
+     * The storage for the values, the size is a power of 2.
+     */
+    std::vector<T> slots;
+    /**
+     * The mask applied to the positions to obtain a slot
+     * index.
+     */
+    const size_t mask;
+
+    /**
+     * The number of values popped, written only by the
+     * consumer. On its own cache line to avoid false
+     * sharing with the producer.
+     */
+    alignas(64) std::atomic<size_t> head{0};
+    /**
+     * The number of values pushed, written only by the
+     * producer.
+     */
+    alignas(64) std::atomic<size_t> tail{0};
+    /**
+     * Whether the ring has been closed.
+     */
+    alignas(64) std::atomic<bool> closed{false};
+
+    /**
+     * The number of threads parked on the ring.
+     */
+    alignas(64) std::atomic<int> parked{0};
+    /**
+     * Guards parking so that a signal cannot be lost
+     * between checking the ring and waiting.
+     */
+    std::mutex park_mutex;
+    /**
+     * Signalled whenever a value is pushed or popped, or
+     * the ring is closed, while a thread is parked.
+     */
+    std::condition_variable park_cv;
+
+    /**
+     * Rounds the given capacity up to the next power of 2.
+     *
+     * @param capacity the requested capacity
+     * @return the slot count
+     */
+    static size_t slot_count(size_t capacity) {
+        size_t count = 1;
+        while (count < capacity) {
+            count <<= 1;
+        }
+
+        return count;
+    }
+
+    /**
+     * Waits a little before retrying, first by spinning,
+     * then by yielding to the other side and finally by
+     * parking until the other side signals or the park
+     * times out.
+     *
+     * @param spins the number of retries so far
+     * @param ready determines whether the ring may now be
+     * retried
+     */
+    template<typename P>
+    void back_off(int &spins, P ready) {
+        if (spins < SPIN_LIMIT) {
+            ++spins;
+        } else if (spins < SPIN_LIMIT + YIELD_LIMIT) {
+            ++spins;
+            std::this_thread::yield();
+        } else {
+            std::unique_lock<std::mutex> lock{park_mutex};
+            parked.fetch_add(1, std::memory_order_seq_cst);
+            // Pairs with the fence in signal(), either the
+            // check sees the other side's update or it sees
+            // this thread parked
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            park_cv.wait_for(lock, std::chrono::milliseconds(PARK_TIMEOUT_MS), ready);
+            parked.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Wakes any thread parked on the ring.
+     */
+    void signal() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock{park_mutex};
+            park_cv.notify_all();
+        }
+    }
+
+public:
+    /**
+     * Creates a new, open ring which holds at least the
+     * given number of values.
+     *
+     * @param capacity the minimum number of values that
+     * can be buffered
+     */
+    explicit c11_spsc_ring(size_t capacity) :
+            slots(slot_count(capacity)), mask(slot_count(capacity) - 1) {
+    }
+
+    c11_spsc_ring(const c11_spsc_ring &) = delete;
+
+    c11_spsc_ring &operator=(const c11_spsc_ring &) = delete;
+
+    /**
+     * Attempts to push the given value without blocking.
+     *
+     * Must only be called by the producer.
+     *
+     * @param value the value to push
+     * @return true if the value was pushed, false if the
+     * ring is full or closed
+     */
+    bool try_push(const T &value) {
+        if (closed.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        size_t pos = tail.load(std::memory_order_relaxed);
+        if (pos - head.load(std::memory_order_acquire) == slots.size()) {
+            return false;
+        }
+
+        slots[pos & mask] = value;
+        tail.store(pos + 1, std::memory_order_release);
+        signal();
+        return true;
+    }
+
+    /**
+     * Pushes the given value, blocking while the ring is
+     * full.
+     *
+     * Must only be called by the producer.
+     *
+     * @param value the value to push
+     * @return true if the value was pushed, false if the
+     * ring is closed
+     */
+    bool push(const T &value) {
+        int spins = 0;
+        while (!try_push(value)) {
+            if (closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            back_off(spins, [this] {
+                return closed.load(std::memory_order_acquire) ||
+                       tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) < slots.size();
+            });
+        }
+
+        return true;
+    }
+
+    /**
+     * Attempts to pop the next value without blocking.
+     *
+     * Must only be called by the consumer.
+     *
+     * @param value the value to write the result
+     * @return true if a value was popped, false if the
+     * ring is empty
+     */
+    bool try_pop(T &value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        if (pos == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = slots[pos & mask];
+        head.store(pos + 1, std::memory_order_release);
+        signal();
+        return true;
+    }
+
+    /**
+     * Pops the next value, blocking while the ring is
+     * empty.
+     *
+     * Must only be called by the consumer.
+     *
+     * @param value the value to write the result
+     * @return true if a value was popped, false if the
+     * ring is closed and every value has been popped
+     */
+    bool pop(T &value) {
+        int spins = 0;
+        while (!try_pop(value)) {
+            if (closed.load(std::memory_order_acquire)) {
+                // Values pushed before closing are visible
+                // once closed is
+                return try_pop(value);
+            }
+
+            back_off(spins, [this] {
+                return closed.load(std::memory_order_acquire) ||
+                       head.load(std::memory_order_relaxed) != tail.load(std::memory_order_acquire);
+            });
+        }
+
+        return true;
+    }
+
+    /**
+     * Closes the ring so that no more values can be
+     * pushed.
+     */
+    void close() {
+        closed.store(true, std::memory_order_release);
+        signal();
+    }
+
+    /**
+     * Determines whether the ring has been closed.
+     *
+     * @return true if no more values can be pushed
+     */
+    bool is_closed() const {
+        return closed.load(std::memory_order_acquire);
+    }
+};
+
+template<typename T>
+const int c11_spsc_ring<T>::SPIN_LIMIT;
+
+template<typename T>
+const int c11_spsc_ring<T>::YIELD_LIMIT;
+
+template<typename T>
+const int c11_spsc_ring<T>::PARK_TIMEOUT_MS;
+
+#endif // LIFTOFF_CLI_C11_SPSC_RING_H
@@ -0,0 +1,467 @@
+#include "dispersion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#include "rocket_sim.h"
+#include "telemetry_sink.h"
+#include "velocity_source.h"
+
+// The number of histogram bins per tick used to estimate the percentile envelopes
+static const size_t HISTOGRAM_BINS = 1024;
+// The number of runs whose trajectories are kept to size the histograms
+static const size_t PILOT_RUNS = 64;
+// The histograms span this multiple of the range seen by the pilot runs
+static const double HISTOGRAM_SPAN = 3;
+// Smallest relative histogram span, for ticks where the pilot runs all agree
+static const double MIN_RELATIVE_SPAN = 1e-9;
+// The runs are reduced in this many chunks regardless of the number of threads so
+// that the results are the same on any machine
+static const size_t DISPERSION_CHUNKS = 512;
+
+/**
+ * Mixes the given value into a well distributed 64-bit
+ * value (SplitMix64), used to derive independent seeds
+ * for each run.
+ *
+ * @param x the value to mix
+ * @return the mixed value
+ */
+static uint64_t split_mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+double param_distribution::sample(double nominal, std::mt19937_64 &rng) const {
+    switch (kind) {
+        case distribution_kind::normal:
+            return std::normal_distribution<double>{a, b}(rng);
+        case distribution_kind::uniform:
+            return std::uniform_real_distribution<double>{a, b}(rng);
+        default:
+            return nominal;
+    }
+}
+
+bool parse_param_distribution(const std::string &spec, dispersion_config &config) {
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos) {
+        return false;
+    }
+
+    std::string name = spec.substr(0, eq);
+    param_distribution *target;
+    if (name == "cd") {
+        target = &config.cd;
+    } else if (name == "thrust") {
+        target = &config.max_thrust;
+    } else if (name == "isp") {
+        target = &config.isp;
+    } else if (name == "s1_dry") {
+        target = &config.stage_1_dry_mass;
+    } else if (name == "s1_fuel") {
+        target = &config.stage_1_fuel_mass;
+    } else if (name == "s2_dry") {
+        target = &config.stage_2_dry_mass;
+    } else if (name == "s2_fuel") {
+        target = &config.stage_2_fuel_mass;
+    } else if (name == "payload") {
+        target = &config.payload_mass;
+    } else {
+        return false;
+    }
+
+    std::string rest = spec.substr(eq + 1);
+    size_t colon = rest.find(':');
+    std::string kind = rest.substr(0, colon);
+    if (kind == "fixed") {
+        *target = {};
+        return colon == std::string::npos;
+    }
+
+    param_distribution dist;
+    if (kind == "normal") {
+        dist.kind = distribution_kind::normal;
+    } else if (kind == "uniform") {
+        dist.kind = distribution_kind::uniform;
+    } else {
+        return false;
+    }
+
+    if (colon == std::string::npos) {
+        return false;
+    }
+
+    const char *values = rest.c_str() + colon + 1;
+    char *end;
+    dist.a = std::strtod(values, &end);
+    if (end == values || *end != ':') {
+        return false;
+    }
+
+    const char *second = end + 1;
+    dist.b = std::strtod(second, &end);
+    if (end == second || *end != '\0') {
+        return false;
+    }
+
+    if ((dist.kind == distribution_kind::normal && dist.b < 0) ||
+        (dist.kind == distribution_kind::uniform && dist.b < dist.a)) {
+        return false;
+    }
+
+    *target = dist;
+    return true;
+}
+
+vehicle_params sample_vehicle_params(const dispersion_config &config, const vehicle_params &nominal, size_t run) {
+    std::mt19937_64 rng{split_mix(config.seed ^ split_mix(run))};
+
+    vehicle_params params = nominal;
+    params.cd = config.cd.sample(nominal.cd, rng);
+    params.max_thrust = config.max_thrust.sample(nominal.max_thrust, rng);
+    params.isp = config.isp.sample(nominal.isp, rng);
+    params.stage_1_dry_mass = config.stage_1_dry_mass.sample(nominal.stage_1_dry_mass, rng);
+    params.stage_1_fuel_mass = config.stage_1_fuel_mass.sample(nominal.stage_1_fuel_mass, rng);
+    params.stage_2_dry_mass = config.stage_2_dry_mass.sample(nominal.stage_2_dry_mass, rng);
+    params.stage_2_fuel_mass = config.stage_2_fuel_mass.sample(nominal.stage_2_fuel_mass, rng);
+    params.payload_mass = config.payload_mass.sample(nominal.payload_mass, rng);
+
+    return params;
+}
+
+double dispersion_result::meco_percentile(double p) const {
+    if (meco_propellant.empty()) {
+        return NAN;
+    }
+
+    // Linear interpolation between the closest ranks
+    double rank = p / 100 * static_cast<double>(meco_propellant.size() - 1);
+    auto lo = static_cast<size_t>(std::floor(rank));
+    size_t hi = std::min(lo + 1, meco_propellant.size() - 1);
+    double frac = rank - static_cast<double>(lo);
+
+    return meco_propellant[lo] + (meco_propellant[hi] - meco_propellant[lo]) * frac;
+}
+
+/**
+ * @brief Counts the values of a channel at each tick in a
+ * fixed range of bins, shared between every worker.
+ */
+class channel_histogram {
+private:
+    /**
+     * The lower bound of the first bin of each tick.
+     */
+    std::vector<double> lo;
+    /**
+     * The width of the bins of each tick.
+     */
+    std::vector<double> width;
+    /**
+     * The number of values in each bin of each tick.
+     */
+    std::vector<std::atomic<uint32_t>> counts;
+
+public:
+    /**
+     * Creates the histograms spanning a multiple of the
+     * range of the given pilot values at each tick.
+     *
+     * @param pilot the values of each pilot run at each
+     * tick, NAN where a run produced no frame
+     * @param ticks the number of ticks
+     */
+    channel_histogram(const std::vector<std::vector<double>> &pilot, size_t ticks) :
+            lo(ticks), width(ticks), counts(ticks * HISTOGRAM_BINS) {
+        for (size_t t = 0; t < ticks; ++t) {
+            double min = INFINITY;
+            double max = -INFINITY;
+            for (const std::vector<double> &run : pilot) {
+                if (!std::isnan(run[t])) {
+                    min = std::min(min, run[t]);
+                    max = std::max(max, run[t]);
+                }
+            }
+
+            if (min > max) {
+                min = 0;
+                max = 0;
+            }
+
+            double span = std::max((max - min) * HISTOGRAM_SPAN,
+                                   std::max(std::abs(min), std::abs(max)) * MIN_RELATIVE_SPAN);
+            if (span == 0) {
+                span = MIN_RELATIVE_SPAN;
+            }
+
+            double centre = (min + max) / 2;
+            lo[t] = centre - span / 2;
+            width[t] = span / HISTOGRAM_BINS;
+        }
+    }
+
+    /**
+     * Counts the given value at the given tick, values
+     * outside of the range are counted in the end bins.
+     *
+     * @param tick the tick index
+     * @param x the value
+     */
+    void add(size_t tick, double x) {
+        double pos = (x - lo[tick]) / width[tick];
+        size_t bin = 0;
+        if (pos >= HISTOGRAM_BINS) {
+            bin = HISTOGRAM_BINS - 1;
+        } else if (pos > 0) {
+            bin = static_cast<size_t>(pos);
+        }
+
+        counts[tick * HISTOGRAM_BINS + bin].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Estimates the given percentile at the given tick by
+     * interpolating within the bin which holds its rank.
+     *
+     * @param tick the tick index
+     * @param p the percentile, between 0 and 100
+     * @param total the number of values at this tick
+     * @return the percentile, or NAN if there are no
+     * values
+     */
+    double percentile(size_t tick, double p, size_t total) const {
+        if (total == 0) {
+            return NAN;
+        }
+
+        double rank = p / 100 * static_cast<double>(total);
+        double cumulative = 0;
+        const std::atomic<uint32_t> *row = &counts[tick * HISTOGRAM_BINS];
+        for (size_t bin = 0; bin < HISTOGRAM_BINS; ++bin) {
+            double count = row[bin].load(std::memory_order_relaxed);
+            if (count > 0 && cumulative + count >= rank) {
+                return lo[tick] + (static_cast<double>(bin) + (rank - cumulative) / count) * width[tick];
+            }
+
+            cumulative += count;
+        }
+
+        return lo[tick] + static_cast<double>(HISTOGRAM_BINS) * width[tick];
+    }
+};
+
+/**
+ * @brief Keeps the altitude and velocity at each tick of
+ * a single run.
+ */
+class trajectory_sink : public telemetry_sink {
+private:
+    const double time_step;
+
+public:
+    std::vector<double> altitude;
+    std::vector<double> velocity;
+
+    trajectory_sink(double ts_time_step, size_t ticks) :
+            time_step(ts_time_step), altitude(ticks, NAN), velocity(ticks, NAN) {
+    }
+
+    void record(const telemetry_frame &frame) override {
+        auto tick = static_cast<size_t>(std::lround(frame.time / time_step));
+        if (tick < altitude.size()) {
+            altitude[tick] = frame.altitude;
+            velocity[tick] = frame.velocity;
+        }
+    }
+};
+
+/**
+ * @brief Records the frames of a single run into the
+ * statistics of the chunk and the shared histograms.
+ */
+class dispersion_sink : public telemetry_sink {
+private:
+    const double time_step;
+    std::vector<liftoff::running_stats> &altitude;
+    std::vector<liftoff::running_stats> &velocity;
+    channel_histogram &altitude_hist;
+    channel_histogram &velocity_hist;
+
+public:
+    dispersion_sink(double ds_time_step,
+                    std::vector<liftoff::running_stats> &ds_altitude,
+                    std::vector<liftoff::running_stats> &ds_velocity,
+                    channel_histogram &ds_altitude_hist,
+                    channel_histogram &ds_velocity_hist) :
+            time_step(ds_time_step), altitude(ds_altitude), velocity(ds_velocity),
+            altitude_hist(ds_altitude_hist), velocity_hist(ds_velocity_hist) {
+    }
+
+    void add(size_t tick, double alt, double vel) {
+        altitude[tick].add(alt);
+        velocity[tick].add(vel);
+        altitude_hist.add(tick, alt);
+        velocity_hist.add(tick, vel);
+    }
+
+    void record(const telemetry_frame &frame) override {
+        auto tick = static_cast<size_t>(std::lround(frame.time / time_step));
+        if (tick < altitude.size()) {
+            add(tick, frame.altitude, frame.velocity);
+        }
+    }
+};
+
+/**
+ * Computes the percentile envelopes of the given channel.
+ *
+ * @param channel the channel to fill
+ * @param hist the histogram of the channel
+ */
+static void fill_percentiles(dispersion_channel &channel, const channel_histogram &hist) {
+    size_t ticks = channel.stats.size();
+    channel.p5.resize(ticks);
+    channel.p50.resize(ticks);
+    channel.p95.resize(ticks);
+    for (size_t t = 0; t < ticks; ++t) {
+        size_t total = channel.stats[t].count();
+        channel.p5[t] = hist.percentile(t, 5, total);
+        channel.p50[t] = hist.percentile(t, 50, total);
+        channel.p95[t] = hist.percentile(t, 95, total);
+    }
+}
+
+dispersion_result run_dispersion(const dispersion_config &config, const velocity_flight_profile &profile,
+                                 double time_step, double duration, liftoff::thread_pool &pool) {
+    const vehicle_params nominal{FALCON_9};
+    auto ticks = static_cast<size_t>(duration / time_step);
+
+    std::vector<double> meco_propellant(config.runs, NAN);
+    std::atomic<size_t> burnouts{0};
+    auto simulate = [&](size_t run, telemetry_sink &sink) {
+        vehicle_params params = sample_vehicle_params(config, nominal, run);
+
+        profile_velocity_source source{profile};
+        rocket_sim sim{source, params, time_step, duration};
+        sim.run(sink);
+
+        meco_propellant[run] = sim.get_meco_propellant();
+        if (!std::isnan(sim.get_burnout_time())) {
+            burnouts.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    // The first runs keep their trajectories to size the
+    // histograms at each tick, then are reduced like the rest
+    size_t pilot_runs = std::min(config.runs, PILOT_RUNS);
+    std::vector<std::vector<double>> pilot_altitude(pilot_runs);
+    std::vector<std::vector<double>> pilot_velocity(pilot_runs);
+    pool.parallel_for(pilot_runs, 1, [&](size_t begin, size_t end) {
+        for (size_t run = begin; run < end; ++run) {
+            trajectory_sink sink{time_step, ticks};
+            simulate(run, sink);
+
+            pilot_altitude[run] = std::move(sink.altitude);
+            pilot_velocity[run] = std::move(sink.velocity);
+        }
+    });
+
+    channel_histogram altitude_hist{pilot_altitude, ticks};
+    channel_histogram velocity_hist{pilot_velocity, ticks};
+
+    // The pilot runs take the first slot and every chunk of
+    // the remaining runs reduces into its own slot, which are
+    // merged in order so the result does not depend on which
+    // worker finished first
+    size_t remaining = config.runs - pilot_runs;
+    size_t grain = (remaining + DISPERSION_CHUNKS - 1) / DISPERSION_CHUNKS;
+    if (grain == 0) {
+        grain = 1;
+    }
+    size_t chunks = (remaining + grain - 1) / grain;
+    std::vector<std::vector<liftoff::running_stats>> slot_altitude(chunks + 1);
+    std::vector<std::vector<liftoff::running_stats>> slot_velocity(chunks + 1);
+
+    slot_altitude[0].resize(ticks);
+    slot_velocity[0].resize(ticks);
+    dispersion_sink pilot_sink{time_step, slot_altitude[0], slot_velocity[0], altitude_hist, velocity_hist};
+    for (size_t run = 0; run < pilot_runs; ++run) {
+        for (size_t t = 0; t < ticks; ++t) {
+            if (!std::isnan(pilot_altitude[run][t])) {
+                pilot_sink.add(t, pilot_altitude[run][t], pilot_velocity[run][t]);
+            }
+        }
+    }
+
+    pool.parallel_for(remaining, grain, [&](size_t begin, size_t end) {
+        size_t slot = begin / grain + 1;
+        std::vector<liftoff::running_stats> &altitude = slot_altitude[slot];
+        std::vector<liftoff::running_stats> &velocity = slot_velocity[slot];
+        altitude.resize(ticks);
+        velocity.resize(ticks);
+
+        dispersion_sink sink{time_step, altitude, velocity, altitude_hist, velocity_hist};
+        for (size_t i = begin; i < end; ++i) {
+            simulate(pilot_runs + i, sink);
+        }
+    });
+
+    dispersion_result result;
+    result.times.resize(ticks);
+    for (size_t t = 0; t < ticks; ++t) {
+        result.times[t] = static_cast<double>(t) * time_step;
+    }
+
+    result.altitude.stats.resize(ticks);
+    result.velocity.stats.resize(ticks);
+    for (size_t c = 0; c < slot_altitude.size(); ++c) {
+        for (size_t t = 0; t < ticks; ++t) {
+            result.altitude.stats[t].merge(slot_altitude[c][t]);
+            result.velocity.stats[t].merge(slot_velocity[c][t]);
+        }
+    }
+
+    fill_percentiles(result.altitude, altitude_hist);
+    fill_percentiles(result.velocity, velocity_hist);
+
+    for (double prop : meco_propellant) {
+        if (!std::isnan(prop)) {
+            result.meco_propellant.push_back(prop);
+            result.meco_stats.add(prop);
+        }
+    }
+    std::sort(result.meco_propellant.begin(), result.meco_propellant.end());
+    result.burnouts = burnouts.load();
+
+    return result;
+}
+
+bool write_dispersion_csv(const std::string &path, const dispersion_result &result) {
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::fputs("time,runs,"
+               "altitude_mean,altitude_stddev,altitude_p5,altitude_p50,altitude_p95,"
+               "velocity_mean,velocity_stddev,velocity_p5,velocity_p50,velocity_p95\n", file);
+    for (size_t t = 0; t < result.times.size(); ++t) {
+        const liftoff::running_stats &alt = result.altitude.stats[t];
+        const liftoff::running_stats &vel = result.velocity.stats[t];
+        std::fprintf(file, "%.17g,%zu,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g\n",
+                     result.times[t], alt.count(),
+                     alt.get_mean(), alt.stddev(),
+                     result.altitude.p5[t], result.altitude.p50[t], result.altitude.p95[t],
+                     vel.get_mean(), vel.stddev(),
+                     result.velocity.p5[t], result.velocity.p50[t], result.velocity.p95[t]);
+    }
+
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,242 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_DISPERSION_H
+#define LIFTOFF_CLI_DISPERSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <liftoff-physics/running_stats.h>
+#include <liftoff-physics/thread_pool.h>
+
+#include "vehicle_params.h"
+#include "velocity_flight_profile.h"
+
+/**
+ * @brief The kinds of distribution a dispersed parameter
+ * can be drawn from.
+ */
+enum class distribution_kind {
+    /**
+     * Always the nominal value.
+     */
+    fixed,
+    /**
+     * Normally distributed with mean a and standard
+     * deviation b.
+     */
+    normal,
+    /**
+     * Uniformly distributed between a and b.
+     */
+    uniform
+};
+
+/**
+ * @brief The distribution of a single vehicle parameter.
+ */
+struct param_distribution {
+    /**
+     * The kind of distribution.
+     */
+    distribution_kind kind{distribution_kind::fixed};
+    /**
+     * The mean or the lower bound.
+     */
+    double a{0};
+    /**
+     * The standard deviation or the upper bound.
+     */
+    double b{0};
+
+    /**
+     * Draws a value of the parameter.
+     *
+     * @param nominal the value used by a fixed distribution
+     * @param rng the random number generator to draw from
+     * @return the parameter value
+     */
+    double sample(double nominal, std::mt19937_64 &rng) const;
+};
+
+/**
+ * @brief The parameters of a Monte-Carlo dispersion of the
+ * rocket simulation.
+ */
+struct dispersion_config {
+    /**
+     * The number of simulations to run.
+     */
+    size_t runs{0};
+    /**
+     * The seed from which the random stream of every run
+     * is derived.
+     */
+    uint64_t seed{0};
+
+    /**
+     * The distribution of the coefficient of drag.
+     */
+    param_distribution cd;
+    /**
+     * The distribution of the engine maximum thrust, N.
+     */
+    param_distribution max_thrust;
+    /**
+     * The distribution of the engine specific impulse, s.
+     */
+    param_distribution isp;
+    /**
+     * The distribution of the first stage dry mass, kg.
+     */
+    param_distribution stage_1_dry_mass;
+    /**
+     * The distribution of the first stage propellant mass,
+     * kg.
+     */
+    param_distribution stage_1_fuel_mass;
+    /**
+     * The distribution of the second stage dry mass, kg.
+     */
+    param_distribution stage_2_dry_mass;
+    /**
+     * The distribution of the second stage propellant
+     * mass, kg.
+     */
+    param_distribution stage_2_fuel_mass;
+    /**
+     * The distribution of the payload mass, kg.
+     */
+    param_distribution payload_mass;
+};
+
+/**
+ * Parses a parameter distribution of the form
+ * name=kind:a:b, for example cd=normal:0.25:0.02, into the
+ * given configuration.
+ *
+ * The names are cd, thrust, isp, s1_dry, s1_fuel, s2_dry,
+ * s2_fuel and payload. The kinds are fixed, normal and
+ * uniform.
+ *
+ * @param spec the distribution specification
+ * @param config the configuration to update
+ * @return false if the specification is malformed
+ */
+bool parse_param_distribution(const std::string &spec, dispersion_config &config);
+
+/**
+ * Draws the vehicle parameters for the given run.
+ *
+ * Each run has its own random stream derived from the
+ * seed and the run index, so the results do not depend on
+ * which thread runs it.
+ *
+ * @param config the dispersion configuration
+ * @param nominal the nominal vehicle parameters
+ * @param run the index of the run
+ * @return the parameters of the run
+ */
+vehicle_params sample_vehicle_params(const dispersion_config &config, const vehicle_params &nominal, size_t run);
+
+/**
+ * @brief The statistics of a telemetry channel over every
+ * run at each tick.
+ */
+struct dispersion_channel {
+    /**
+     * The mean and variance at each tick.
+     */
+    std::vector<liftoff::running_stats> stats;
+    /**
+     * The 5th percentile at each tick.
+     */
+    std::vector<double> p5;
+    /**
+     * The median at each tick.
+     */
+    std::vector<double> p50;
+    /**
+     * The 95th percentile at each tick.
+     */
+    std::vector<double> p95;
+};
+
+/**
+ * @brief The results of a Monte-Carlo dispersion.
+ */
+struct dispersion_result {
+    /**
+     * The time of each tick.
+     */
+    std::vector<double> times;
+    /**
+     * The altitude envelope.
+     */
+    dispersion_channel altitude;
+    /**
+     * The velocity magnitude envelope.
+     */
+    dispersion_channel velocity;
+
+    /**
+     * The propellant remaining at MECO for every run
+     * which reached it, sorted ascending.
+     */
+    std::vector<double> meco_propellant;
+    /**
+     * The mean and variance of the MECO propellant.
+     */
+    liftoff::running_stats meco_stats;
+    /**
+     * The number of runs which ran out of propellant.
+     */
+    size_t burnouts{0};
+
+    /**
+     * Obtains the given percentile of the propellant
+     * remaining at MECO.
+     *
+     * @param p the percentile, between 0 and 100
+     * @return the propellant, or NAN if no run reached
+     * MECO
+     */
+    double meco_percentile(double p) const;
+};
+
+/**
+ * Runs the rocket simulation once for each run of the
+ * given configuration across the given pool, reducing the
+ * altitude, velocity and MECO propellant of each run as it
+ * completes so that no trajectory is stored.
+ *
+ * The percentile envelopes are estimated from per-tick
+ * histograms sized from the spread of the first runs,
+ * while the mean, variance and MECO percentiles are exact.
+ *
+ * @param config the dispersion configuration
+ * @param profile the velocity profile every run follows
+ * @param time_step the time step of each tick
+ * @param duration the duration of each run
+ * @param pool the pool to run the simulations on
+ * @return the reduced results
+ */
+dispersion_result run_dispersion(const dispersion_config &config, const velocity_flight_profile &profile,
+                                 double time_step, double duration, liftoff::thread_pool &pool);
+
+/**
+ * Writes the per-tick envelopes of the given results to a
+ * CSV file.
+ *
+ * @param path the path of the file to write
+ * @param result the dispersion results
+ * @return true if the file was written
+ */
+bool write_dispersion_csv(const std::string &path, const dispersion_result &result);
+
+#endif // LIFTOFF_CLI_DISPERSION_H
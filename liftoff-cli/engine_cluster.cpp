@@ -0,0 +1,28 @@
+#include "engine_cluster.h"
+
+engine_cluster::engine_cluster(const engine &ec_unit, int ec_count) : unit(ec_unit), count(ec_count) {
+}
+
+int engine_cluster::get_count() const {
+    return count;
+}
+
+const engine &engine_cluster::get_engine() const {
+    return unit;
+}
+
+void engine_cluster::set_throttle(double pct) {
+    unit.set_throttle(pct);
+}
+
+double engine_cluster::get_throttle() const {
+    return unit.get_throttle();
+}
+
+double engine_cluster::get_thrust() const {
+    return count * unit.get_thrust();
+}
+
+double engine_cluster::get_prop_flow_rate() const {
+    return count * unit.get_prop_flow_rate();
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_ENGINE_CLUSTER_H
+#define LIFTOFF_CLI_ENGINE_CLUSTER_H
+
+#include "engine.h"
+
+/**
+ * @brief Represents a cluster of identical engines which
+ * are throttled together, such that the thrust and the
+ * propellant flow of the whole cluster are those of a
+ * single engine scaled by the engine count.
+ */
+class engine_cluster {
+private:
+    // The engine model shared by the cluster, holding the
+    // common throttle
+    engine unit;
+    // Number of engines in the cluster
+    int count;
+
+public:
+    /**
+     * Creates a new cluster of engines.
+     *
+     * @param ec_unit the model of each engine
+     * @param ec_count the number of engines
+     */
+    engine_cluster(const engine &ec_unit, int ec_count);
+
+    /**
+     * Obtains the number of engines in this cluster.
+     *
+     * @return the engine count
+     */
+    int get_count() const;
+
+    /**
+     * Obtains the model shared by every engine in this
+     * cluster.
+     *
+     * @return the engine model
+     */
+    const engine &get_engine() const;
+
+    /**
+     * Sets the throttle of every engine, see
+     * engine::set_throttle().
+     *
+     * @param pct the thrust percentage
+     */
+    void set_throttle(double pct);
+
+    /**
+     * Determines the throttle last set by set_throttle().
+     *
+     * @return the current engine throttle
+     */
+    double get_throttle() const;
+
+    /**
+     * Determines the thrust force of the whole cluster.
+     *
+     * @return the thrust force
+     */
+    double get_thrust() const;
+
+    /**
+     * Obtains the propellant mass flow rate through the
+     * whole cluster.
+     *
+     * @return the propellant mass flow rate
+     */
+    double get_prop_flow_rate() const;
+};
+
+#endif // LIFTOFF_CLI_ENGINE_CLUSTER_H
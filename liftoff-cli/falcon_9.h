@@ -0,0 +1,39 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_FALCON_9_H
+#define LIFTOFF_CLI_FALCON_9_H
+
+#include <cmath>
+
+static constexpr double ACCEL_G = 9.80665;
+
+// Coefficient of drag
+// https://space.stackexchange.com/questions/16883/whats-the-atmospheric-drag-coefficient-of-a-falcon-9-at-launch-sub-sonic-larg#16885
+static constexpr double F9_CD = 0.25;
+// Frontal surface area, m^2
+// https://www.spacex.com/sites/spacex/files/falcon_users_guide_10_2019.pdf
+static constexpr double F9_A = M_PI * 2.6 * 2.6;
+
+// Stage and payload masses, kg
+// Source: https://www.spaceflightinsider.com/hangar/falcon-9/
+static constexpr double F9_STAGE_1_DRY_MASS = 25600;
+static constexpr double F9_STAGE_1_FUEL_MASS = 395700;
+static constexpr double F9_STAGE_2_DRY_MASS = 3900;
+static constexpr double F9_STAGE_2_FUEL_MASS = 92670;
+static constexpr double F9_PAYLOAD_MASS = 6800;
+
+// Merlin 1D Max Thrust @ SL, N
+// https://www.spacex.com/sites/spacex/files/falcon_users_guide_10_2019.pdf
+static constexpr double MERLIN_MAX_THRUST = 854000;
+// Merlin 1D I_sp (or as good of a guess as people get), s
+// https://en.wikipedia.org/wiki/Falcon_Heavy#cite_note-5
+static constexpr double MERLIN_ISP = 282;
+// Merlin 1D nozzle exit area,
+// Estimates: https://forum.nasaspaceflight.com/index.php?topic=32983.45
+// Estimates: https://www.reddit.com/r/spacex/comments/4icycu/basic_analysis_of_the_merlin_1d_engine/d2x26pn/
+// 0.95 m seems to be a fair diameter compromise
+static constexpr double MERLIN_A = M_PI * 0.475 * 0.475;
+
+#endif // LIFTOFF_CLI_FALCON_9_H
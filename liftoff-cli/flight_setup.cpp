@@ -0,0 +1,294 @@
+#include "flight_setup.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <liftoff-physics/event_detector.h>
+#include <liftoff-physics/linalg.h>
+#include <liftoff-physics/piecewise_polynomial.h>
+#include <liftoff-physics/telem_proc.h>
+#include <liftoff-physics/time_series.h>
+#include <liftoff-physics/trace.h>
+
+#include "spacextract_reader.h"
+#include "telemetry_cache.h"
+
+const std::vector<bool> STAGING_EVENTS = {true, false, true};
+
+const char *const STAGING_EVENT_NAMES[] = {"MECO", "SES-1", "SECO-1"};
+
+// The lowest altitude of the fits of legs 1 and 3, m
+static const double OUTER_LEG_FLOOR = 0;
+
+/**
+ * Parses the SpaceXtract telemetry file from the given
+ * path into the given flight profile.
+ *
+ * @param raw the raw flight profile to parse data into
+ * @param path the path to the telemetry data file
+ * @return false if the file could not be opened
+ */
+static bool parse_telem(telemetry_flight_profile &raw, const std::string &path) {
+    LIFTOFF_TRACE_SCOPE("parse");
+
+    spacextract_reader reader{path};
+    if (!reader.is_open()) {
+        std::cout << "Cannot find file '" << path << "'" << std::endl;
+        return false;
+    }
+
+    raw.reserve(reader.count_lines());
+
+    telemetry_sample sample{};
+    while (reader.next(sample)) {
+        raw.put_velocity(sample.time, sample.velocity);
+        raw.put_altitude(sample.time, km_to_m(sample.altitude));
+    }
+
+    if (reader.get_skipped() != 0) {
+        std::cout << "Skipped " << reader.get_skipped() << " malformed lines in '" << path << "'" << std::endl;
+    }
+
+    return true;
+}
+
+/**
+ * Fits the altitude of leg 1 or 3 of the flight, keeping
+ * the state continuous with leg 2.
+ *
+ * @param fitted the processed data
+ * @param times the timestamps of each leg
+ * @param legs the altitudes of each leg
+ * @param l the index of the leg, 0 or 2
+ * @param pool the pool to sum the leg on, or nullptr
+ * @param alt_fit the polynomial to write the fit to
+ */
+static void fit_outer_leg(const telemetry_flight_profile &fitted,
+                          const std::vector<std::vector<double>> &times,
+                          const std::vector<std::vector<double>> &legs,
+                          int l, liftoff::thread_pool *pool, liftoff::polynomial &alt_fit) {
+    const liftoff::time_series &alt_fitted = fitted.get_altitudes();
+
+    // Determine which points to force on the curve fit in
+    // order to maintain the correct state between legs
+    std::vector<std::pair<double, double>> force_points;
+    liftoff::force(force_points, alt_fitted, times[1], l == 0 ? 1 : -1);
+
+    // Increase the order of the least-squares curve
+    // regression
+    alt_fit = liftoff::fit(4 + force_points.size(), times[l], legs[l], force_points, pool);
+}
+
+/**
+ * Determines the points to force on the curve fit from the
+ * altitudes of the profile at the given times, the same
+ * way as liftoff::force() but reading through the altitude
+ * fit of the profile.
+ *
+ * @param out the points to append to
+ * @param fitted the processed data
+ * @param times the timestamps of the leg
+ * @param count the number of points from the beginning of
+ * the leg, or from the end if negative
+ */
+static void force_fitted(std::vector<std::pair<double, double>> &out, const telemetry_flight_profile &fitted,
+                         const std::vector<double> &times, int count) {
+    size_t n = std::min<size_t>(std::abs(count), times.size());
+    for (size_t k = 0; k < n; ++k) {
+        double t = count >= 0 ? times[k] : times[times.size() - 1 - k];
+        out.emplace_back(t, fitted.get_altitude(t));
+    }
+}
+
+/**
+ * Builds the altitude fit of the profile from the fit of
+ * each leg, where each leg begins at the event ending the
+ * previous one.
+ *
+ * @param fit the fit of each leg
+ * @return the altitude fit
+ */
+static liftoff::piecewise_polynomial make_altitude_fit(const flight_profile_fit &fit) {
+    liftoff::piecewise_polynomial alt_fit;
+    for (size_t l = 0; l < fit.legs.size(); ++l) {
+        double begin = l == 0 ? -INFINITY : fit.events[l - 1];
+        double floor = l == 1 ? -INFINITY : OUTER_LEG_FLOOR;
+        alt_fit.add_segment(begin, fit.events[l], fit.legs[l], floor);
+    }
+
+    return alt_fit;
+}
+
+bool setup_flight_profile(telemetry_flight_profile &raw,
+                          telemetry_flight_profile &fitted,
+                          const std::string &path,
+                          const flight_setup_params &params,
+                          liftoff::thread_pool *pool) {
+    LIFTOFF_TRACE_SCOPE("setup");
+    raw.set_range(params.range);
+
+    std::string cache_path = path + ".lftc";
+    flight_profile_fit fit;
+    if (load_telemetry_cache(cache_path, path, params.event_search_time, raw, fitted, fit)) {
+        fitted.set_altitude_fit(make_altitude_fit(fit));
+        return true;
+    }
+
+    if (!parse_telem(raw, path) || raw.get_velocities().empty() || raw.get_altitudes().empty()) {
+        return false;
+    }
+
+    // Perform linear interpolation for velocity and altitude,
+    // which share their timestamps, in one pass. Each thread
+    // keeps its scratch columns for the next profile
+    static thread_local liftoff::channel_interp interp;
+    interp.run({&fitted.get_velocities(), &fitted.get_altitudes()},
+               {&raw.get_velocities(), &raw.get_altitudes()});
+
+    // Find MECO/SES/SECO events
+    const liftoff::time_series &v_fitted = fitted.get_velocities();
+    size_t search_idx = std::max<size_t>(1, v_fitted.lower_bound(params.event_search_time));
+    std::vector<size_t> event_idx;
+    size_t found = liftoff::detect_events(v_fitted.time_data() + search_idx, v_fitted.value_data() + search_idx,
+                                          v_fitted.size() - search_idx, STAGING_EVENTS,
+                                          liftoff::event_detector_params{}, event_idx);
+    if (found != STAGING_EVENTS.size()) {
+        std::cout << "Cannot find the MECO, SES-1 and SECO-1 events in '" << path << "'" << std::endl;
+        return false;
+    }
+
+    // events contains timestamps for beginning of the next leg
+    // i.e. leg 1 < meco; meco <= leg 2
+    std::vector<double> events;
+    for (size_t idx : event_idx) {
+        events.push_back(v_fitted.time_at(search_idx + idx));
+    }
+    int n_events = events.size();
+
+    const liftoff::time_series &alt_fitted = fitted.get_altitudes();
+
+    // Divide the data by each leg of the mission
+    std::vector<std::vector<double>> times;
+    std::vector<std::vector<double>> legs;
+    liftoff::collect(times, legs, alt_fitted, events);
+
+    // Step 1: Force points are the same for leg 1 and 3
+
+    // Legs 1 and 3 only read the leg 2 altitudes and only
+    // write their own, so they are fitted at the same time
+    std::vector<liftoff::polynomial> alt_fit(n_events);
+    if (pool != nullptr) {
+        liftoff::task_group group{*pool};
+        group.run([&] { fit_outer_leg(fitted, times, legs, 0, pool, alt_fit[0]); });
+        group.run([&] { fit_outer_leg(fitted, times, legs, 2, pool, alt_fit[2]); });
+        group.wait();
+    } else {
+        fit_outer_leg(fitted, times, legs, 0, pool, alt_fit[0]);
+        fit_outer_leg(fitted, times, legs, 2, pool, alt_fit[2]);
+    }
+
+    // Step 2: change the number of forced points for leg 2
+
+    // Find the correct forced points for leg 2 from the
+    // fits of legs 1 and 3, with leg 2 still unfitted
+    liftoff::piecewise_polynomial outer_fit;
+    outer_fit.add_segment(-INFINITY, events[0], alt_fit[0], OUTER_LEG_FLOOR);
+    outer_fit.add_segment(events[1], events[2], alt_fit[2], OUTER_LEG_FLOOR);
+    fitted.set_altitude_fit(outer_fit);
+
+    std::vector<std::pair<double, double>> force_points;
+    force_fitted(force_points, fitted, times[0], -3);
+    force_fitted(force_points, fitted, times[2], 3);
+
+    // Use the same order as forced points to avoid
+    // deviation due to sharp changes in altitude
+    liftoff::polynomial lip_fit = liftoff::lip(force_points);
+
+    fit.events = events;
+    fit.event_search_time = params.event_search_time;
+    fit.legs = {alt_fit[0], lip_fit, alt_fit[2]};
+
+    // The samples of each leg are only evaluated from the
+    // fit once they are looked up
+    fitted.set_altitude_fit(make_altitude_fit(fit));
+    if (!write_telemetry_cache(cache_path, path, raw, fitted, fit)) {
+        std::cout << "Cannot write telemetry cache '" << cache_path << "'" << std::endl;
+    }
+
+    return true;
+}
+
+void condition_flight_profile(telemetry_flight_profile &fitted, double max_time) {
+    LIFTOFF_TRACE_SCOPE("condition");
+
+    double time_step = fitted.get_time_step();
+    int total_steps = static_cast<int>(max_time / time_step);
+
+    // Whenever there is not enough velocity to move the
+    // rocket to the next recorded altitude, the profile up
+    // to that point (the break-even) is replaced by the
+    // velocity integral and the rest of it is translated
+    // down so that it connects with the integral. Then the
+    // velocities and altitudes are compared again from
+    // there on until they match over the entire profile.
+    //
+    // The translation only ever moves the rest of the
+    // profile down further, and the rest of the profile is
+    // the original one translated by the largest offset
+    // found so far, so it is tracked by that offset alone
+    // and applied to the profile once at the end
+    std::vector<double> orig_alt(total_steps);
+    std::vector<double> v_integral(total_steps);
+    std::vector<double> velocity(total_steps);
+    double integral = 0;
+    for (int i = 0; i < total_steps; ++i) {
+        double t = i * time_step;
+        orig_alt[i] = fitted.get_altitude(t);
+        velocity[i] = fitted.get_velocity(t);
+
+        // Integrate velocity using Euler's method
+        integral += velocity[i] * time_step;
+        v_integral[i] = integral;
+    }
+
+    int break_even = 0;
+    double offset = 0;
+    double last_t = 0;
+    double last_alt = 0;
+    for (int i = 0; i < total_steps; ++i) {
+        double t = i * time_step;
+        double alt = orig_alt[i] - offset;
+
+        double dt = t - last_t;
+        double target_error = alt - last_alt;
+        double target_v = target_error / dt;
+        if (velocity[i] < target_v && break_even < i) {
+            break_even = i;
+
+            // Translate the rest of the profile so that it
+            // continues from the velocity integral unless it
+            // is already below it
+            double break_even_offset = orig_alt[i - 1] - v_integral[i - 1];
+            if (break_even_offset > offset) {
+                offset = break_even_offset;
+                alt = orig_alt[i] - offset;
+            }
+        }
+
+        last_t = t;
+        last_alt = alt;
+    }
+
+    // The conditioning is applied to every lookup, and the
+    // ticks which the replay looks up are memoised so that
+    // the fit is not evaluated again
+    if (break_even != 0) {
+        v_integral.resize(break_even);
+        fitted.set_altitude_conditioning(std::move(v_integral), offset);
+    }
+
+    fitted.cache_altitude_ticks(total_steps);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_FLIGHT_SETUP_H
+#define LIFTOFF_CLI_FLIGHT_SETUP_H
+
+#include <string>
+#include <vector>
+
+#include <liftoff-physics/thread_pool.h>
+
+#include "telemetry_flight_profile.h"
+
+/**
+ * @brief The parameters of the flight profile setup which
+ * differ between missions.
+ */
+struct flight_setup_params {
+    /**
+     * The downrange distance of the mission, m. Defaults to
+     * JCSAT-18/KACIFIC1, see
+     * https://everydayastronaut.com/prelaunch-preview-falcon-9-block-5-jcsat-18-kacific-1/
+     */
+    double range{651000};
+    /**
+     * The time from which to search for MECO, s, which
+     * skips over any drop in velocity earlier in the
+     * telemetry.
+     */
+    double event_search_time{0};
+};
+
+/**
+ * Converts the given number of kilometers to the
+ * equivalent number of meters.
+ *
+ * @param km the number of kilometers
+ * @return the equivalent number of meters
+ */
+inline double km_to_m(double km) {
+    return km * 1000;
+}
+
+/**
+ * Whether each of the MECO, SES-1 and SECO-1 events, in
+ * the order in which they occur, is a decrease in velocity.
+ */
+extern const std::vector<bool> STAGING_EVENTS;
+
+/**
+ * The names of the events in STAGING_EVENTS.
+ */
+extern const char *const STAGING_EVENT_NAMES[];
+
+/**
+ * Performs the telemetry data parsing and then smooths the
+ * data using interpolation and curve fitting.
+ *
+ * The results are cached next to the telemetry data file
+ * so that later runs over the same file map the cache
+ * instead of parsing and fitting again.
+ *
+ * @param raw the raw telemetry data
+ * @param fitted the processed data
+ * @param path the path to the telemetry data file
+ * @param params the mission parameters
+ * @param pool the pool to fit the legs of the flight on in
+ * parallel, or nullptr to fit them on the calling thread
+ * @return false if the telemetry could not be read or
+ * does not contain the MECO, SES-1 and SECO-1 events
+ */
+bool setup_flight_profile(telemetry_flight_profile &raw,
+                          telemetry_flight_profile &fitted,
+                          const std::string &path,
+                          const flight_setup_params &params = flight_setup_params{},
+                          liftoff::thread_pool *pool = nullptr);
+
+/**
+ * Translates the altitude of the processed profile down
+ * wherever there is not enough velocity to reach the next
+ * recorded altitude, until the velocity integral and the
+ * altitudes agree over the entire profile.
+ *
+ * The conditioning applies to every altitude lookup of
+ * the profile, and the altitude of each tick up to the
+ * given time is memoised, so looking it up afterwards does
+ * not evaluate the fit of the leg again.
+ *
+ * @param fitted the processed profile to condition
+ * @param max_time the time at which to stop conditioning
+ */
+void condition_flight_profile(telemetry_flight_profile &fitted, double max_time);
+
+#endif // LIFTOFF_CLI_FLIGHT_SETUP_H
@@ -0,0 +1,169 @@
+#include "json_scan.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Powers of 10 that are exactly representable as a double
+static const double EXACT_POW_10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_EXACT_POW_10 = 22;
+// Largest integer below which every integer is exactly representable as a double
+static const uint64_t MAX_EXACT_MANTISSA = static_cast<uint64_t>(1) << 53;
+// The number of significant digits that fit into the 64-bit mantissa accumulator
+static const int MAX_MANTISSA_DIGITS = 19;
+// Longest number that is handed to strtod() when the fast path cannot be used
+static const size_t MAX_NUMBER_LENGTH = 64;
+
+bool json_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+const char *json_skip_space(const char *p, const char *end) {
+    while (p < end && json_is_space(*p)) {
+        ++p;
+    }
+
+    return p;
+}
+
+// The digits are accumulated into an integer and scaled by a single exact power of
+// 10, which is correctly rounded whenever both fit into a double (Clinger's fast
+// path). Anything else is rare enough to be handed over to strtod().
+const char *json_parse_number(const char *p, const char *end, double &out) {
+    const char *start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exp_10 = 0;
+    bool any_digits = false;
+    bool truncated = false;
+
+    for (; p < end && is_digit(*p); ++p) {
+        any_digits = true;
+        if (digits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) {
+                ++digits;
+            }
+        } else {
+            truncated = true;
+            ++exp_10;
+        }
+    }
+
+    if (p < end && *p == '.') {
+        for (++p; p < end && is_digit(*p); ++p) {
+            any_digits = true;
+            if (digits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa != 0) {
+                    ++digits;
+                }
+                --exp_10;
+            } else {
+                truncated = true;
+            }
+        }
+    }
+
+    if (!any_digits) {
+        return nullptr;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negative_exp = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative_exp = *p == '-';
+            ++p;
+        }
+
+        if (p == end || !is_digit(*p)) {
+            return nullptr;
+        }
+
+        int exp = 0;
+        for (; p < end && is_digit(*p); ++p) {
+            if (exp < 10000) {
+                exp = exp * 10 + (*p - '0');
+            }
+        }
+
+        exp_10 += negative_exp ? -exp : exp;
+    }
+
+    if (!truncated && mantissa <= MAX_EXACT_MANTISSA &&
+        exp_10 >= -MAX_EXACT_POW_10 && exp_10 <= MAX_EXACT_POW_10) {
+        double value = static_cast<double>(mantissa);
+        if (exp_10 < 0) {
+            value /= EXACT_POW_10[-exp_10];
+        } else {
+            value *= EXACT_POW_10[exp_10];
+        }
+
+        out = negative ? -value : value;
+        return p;
+    }
+
+    size_t length = p - start;
+    if (length >= MAX_NUMBER_LENGTH) {
+        return nullptr;
+    }
+
+    char buf[MAX_NUMBER_LENGTH];
+    std::memcpy(buf, start, length);
+    buf[length] = '\0';
+    out = std::strtod(buf, nullptr);
+    return p;
+}
+
+const char *json_skip_string(const char *p, const char *end) {
+    for (++p; p < end; ++p) {
+        if (*p == '\\') {
+            ++p;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+
+    return nullptr;
+}
+
+const char *json_skip_value(const char *p, const char *end) {
+    int depth = 0;
+    while (p < end) {
+        char c = *p;
+        if (c == '"') {
+            p = json_skip_string(p, end);
+            if (p == nullptr) {
+                return nullptr;
+            }
+
+            continue;
+        }
+
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == ']' || (c == '}' && depth > 0)) {
+            --depth;
+        } else if (depth == 0 && (c == ',' || c == '}')) {
+            return p;
+        }
+
+        ++p;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file
+ *
+ * Allocation-free helpers for scanning flat JSON objects in
+ * place, shared by the telemetry and manifest readers.
+ */
+
+#ifndef LIFTOFF_CLI_JSON_SCAN_H
+#define LIFTOFF_CLI_JSON_SCAN_H
+
+/**
+ * Determines whether the given character is JSON
+ * whitespace.
+ *
+ * @param c the character to check
+ * @return true if the character is whitespace
+ */
+bool json_is_space(char c);
+
+/**
+ * Skips over any whitespace.
+ *
+ * @param p the first character to check
+ * @param end one past the last character
+ * @return the first non-whitespace character, or end
+ */
+const char *json_skip_space(const char *p, const char *end);
+
+/**
+ * Parses the JSON number at the given position without
+ * allocating.
+ *
+ * @param p the first character of the number
+ * @param end one past the last character
+ * @param out the value to write the result to
+ * @return the position after the number, or nullptr if
+ * there is no number at p
+ */
+const char *json_parse_number(const char *p, const char *end, double &out);
+
+/**
+ * Skips over the JSON string whose opening quote is at the
+ * given position.
+ *
+ * @param p the opening quote
+ * @param end one past the last character
+ * @return the position after the closing quote, or nullptr
+ * if the string is unterminated
+ */
+const char *json_skip_string(const char *p, const char *end);
+
+/**
+ * Skips over a JSON value which is not needed.
+ *
+ * @param p the first character of the value
+ * @param end one past the last character
+ * @return the position of the ',' or '}' following the
+ * value, or nullptr if it is malformed
+ */
+const char *json_skip_value(const char *p, const char *end);
+
+#endif // LIFTOFF_CLI_JSON_SCAN_H
@@ -0,0 +1,332 @@
+#include "live_feed.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "json_scan.h"
+
+// The number of bytes read from the feed at once
+static const size_t READ_CHUNK = 64 * 1024;
+// Longest line kept while waiting for its end, anything longer is skipped as malformed
+static const size_t MAX_LINE_LENGTH = 64 * 1024;
+// How long the reader waits before retrying a coalesced sample when no new data
+// arrives, ms
+static const int COALESCE_RETRY_MS = 1;
+
+bool parse_overflow_policy(const std::string &name, overflow_policy &policy) {
+    if (name == "block") {
+        policy = overflow_policy::block;
+    } else if (name == "drop") {
+        policy = overflow_policy::drop;
+    } else if (name == "coalesce") {
+        policy = overflow_policy::coalesce;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+static bool set_non_blocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Connects to the UNIX stream socket at the given path, returns -1 on failure
+static int connect_unix(const std::string &path, std::string &error) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        error = "socket path is too long";
+        return -1;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        error = std::strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+
+        return -1;
+    }
+
+    return fd;
+}
+
+// Connects to the given host:port over TCP, returns -1 on failure
+static int connect_tcp(const std::string &address, std::string &error) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        error = "expected tcp:<host>:<port>";
+        return -1;
+    }
+
+    std::string host = address.substr(0, colon);
+    std::string port = address.substr(colon + 1);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo *results;
+    int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &results);
+    if (status != 0) {
+        error = gai_strerror(status);
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo *ai = results; ai != nullptr; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+
+        error = std::strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    freeaddrinfo(results);
+    return fd;
+}
+
+live_feed::live_feed(const std::string &lf_source, size_t lf_capacity, overflow_policy lf_policy) :
+        policy(lf_policy), ring(lf_capacity) {
+    if (lf_source == "-") {
+        fd = dup(STDIN_FILENO);
+        if (fd < 0) {
+            error = std::strerror(errno);
+        }
+    } else if (lf_source.compare(0, 5, "unix:") == 0) {
+        fd = connect_unix(lf_source.substr(5), error);
+    } else if (lf_source.compare(0, 4, "tcp:") == 0) {
+        fd = connect_tcp(lf_source.substr(4), error);
+    } else {
+        error = "unknown source, expected -, unix:<path> or tcp:<host>:<port>";
+    }
+
+    if (fd < 0) {
+        ring.close();
+        return;
+    }
+
+    // The reader polls before every read, so the feed does
+    // not need to be non-blocking. The duplicate of stdin
+    // shares its flags with the caller's stdin, which must
+    // not be left non-blocking once the CLI exits
+    bool from_stdin = lf_source == "-";
+    if ((!from_stdin && !set_non_blocking(fd)) || pipe(wake) != 0 || !set_non_blocking(wake[0])) {
+        error = std::strerror(errno);
+        close(fd);
+        fd = -1;
+        ring.close();
+        return;
+    }
+
+    reader = std::thread{&live_feed::read_loop, this};
+}
+
+live_feed::~live_feed() {
+    stop();
+
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    for (int end : wake) {
+        if (end >= 0) {
+            close(end);
+        }
+    }
+}
+
+void live_feed::read_loop() {
+    std::vector<char> chunk(READ_CHUNK);
+    std::string line;
+    bool overlong = false;
+
+    live_sample held{};
+    bool has_held = false;
+
+    // Passes the sample on according to the policy,
+    // returns false if the ring was closed by stop()
+    auto deliver = [&](const live_sample &sample) {
+        switch (policy) {
+            case overflow_policy::block:
+                return ring.push(sample);
+            case overflow_policy::drop:
+                if (!ring.try_push(sample)) {
+                    ++dropped;
+                }
+
+                return true;
+            case overflow_policy::coalesce:
+                if (has_held && ring.try_push(held)) {
+                    has_held = false;
+                }
+
+                if (has_held) {
+                    ++coalesced;
+                    held = sample;
+                } else if (!ring.try_push(sample)) {
+                    held = sample;
+                    has_held = true;
+                }
+
+                return true;
+        }
+
+        return true;
+    };
+
+    // Parses a complete line, returns false if the ring was
+    // closed by stop()
+    auto consume = [&](const char *begin, const char *end,
+                       std::chrono::steady_clock::time_point arrival) {
+        live_sample sample{{}, arrival};
+        if (parse_spacextract_line(begin, end, sample.sample)) {
+            ++received;
+            return deliver(sample);
+        }
+
+        if (json_skip_space(begin, end) != end) {
+            ++malformed;
+        }
+
+        return true;
+    };
+
+    bool running = true;
+    while (running) {
+        if (has_held && ring.try_push(held)) {
+            has_held = false;
+        }
+
+        pollfd fds[2] = {{fd, POLLIN, 0}, {wake[0], POLLIN, 0}};
+        int ready = poll(fds, 2, has_held ? COALESCE_RETRY_MS : -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        if (fds[1].revents != 0) {
+            // Stopped
+            return;
+        }
+
+        if (fds[0].revents == 0) {
+            continue;
+        }
+
+        ssize_t n = read(fd, chunk.data(), chunk.size());
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            continue;
+        }
+
+        if (n <= 0) {
+            // The feed ended, the last line may not have a
+            // line break
+            if (!overlong && !line.empty()) {
+                consume(line.data(), line.data() + line.size(), std::chrono::steady_clock::now());
+            }
+
+            break;
+        }
+
+        auto arrival = std::chrono::steady_clock::now();
+        const char *p = chunk.data();
+        const char *end = p + n;
+        while (running && p < end) {
+            auto *newline = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            const char *line_end = newline != nullptr ? newline : end;
+
+            if (overlong) {
+                // Skip the rest of the line
+            } else if (line.size() + (line_end - p) > MAX_LINE_LENGTH) {
+                ++malformed;
+                overlong = true;
+                line.clear();
+            } else if (newline != nullptr && line.empty()) {
+                // Parse whole lines in place
+                running = consume(p, line_end, arrival);
+            } else {
+                line.append(p, line_end);
+                if (newline != nullptr) {
+                    running = consume(line.data(), line.data() + line.size(), arrival);
+                    line.clear();
+                }
+            }
+
+            if (newline == nullptr) {
+                break;
+            }
+
+            overlong = false;
+            p = newline + 1;
+        }
+    }
+
+    if (has_held) {
+        ring.push(held);
+    }
+    ring.close();
+}
+
+bool live_feed::is_open() const {
+    return fd >= 0;
+}
+
+const std::string &live_feed::get_error() const {
+    return error;
+}
+
+c11_spsc_ring<live_sample> &live_feed::get_ring() {
+    return ring;
+}
+
+void live_feed::stop() {
+    if (!reader.joinable()) {
+        return;
+    }
+
+    // Closing the ring releases a reader blocked on a full
+    // ring, the pipe one blocked on the feed
+    ring.close();
+    char byte = 0;
+    while (write(wake[1], &byte, 1) < 0 && errno == EINTR) {
+    }
+
+    reader.join();
+}
+
+size_t live_feed::get_received() const {
+    return received.load();
+}
+
+size_t live_feed::get_dropped() const {
+    return dropped.load();
+}
+
+size_t live_feed::get_coalesced() const {
+    return coalesced.load();
+}
+
+size_t live_feed::get_malformed() const {
+    return malformed.load();
+}
@@ -0,0 +1,216 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_LIVE_FEED_H
+#define LIFTOFF_CLI_LIVE_FEED_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "c11_spsc_ring.h"
+#include "spacextract_reader.h"
+
+/**
+ * @brief What the reader does with a sample that arrives
+ * while the consumer is too far behind to accept it.
+ */
+enum class overflow_policy {
+    /**
+     * Stop reading until the consumer catches up, which
+     * pushes back on the sender.
+     */
+    block,
+    /**
+     * Discard the sample that arrived.
+     */
+    drop,
+    /**
+     * Hold on to the newest sample only, replacing any
+     * older one held, and deliver it once there is room.
+     */
+    coalesce
+};
+
+/**
+ * Parses the name of an overflow policy.
+ *
+ * @param name block, drop or coalesce
+ * @param policy the policy to write the result
+ * @return false if the name is not a policy
+ */
+bool parse_overflow_policy(const std::string &name, overflow_policy &policy);
+
+/**
+ * @brief A telemetry sample received from a live feed.
+ */
+struct live_sample {
+    /**
+     * The parsed sample.
+     */
+    telemetry_sample sample;
+    /**
+     * When the line holding the sample was read.
+     */
+    std::chrono::steady_clock::time_point arrival;
+};
+
+/**
+ * @brief Reads SpaceXtract lines from a live feed on its
+ * own thread and passes the parsed samples to a single
+ * consumer through a lock-free ring.
+ *
+ * The source is one of:
+ *
+ *   - "-": the standard input, e.g. a pipe
+ *   - "unix:<path>": a UNIX stream socket
+ *   - "tcp:<host>:<port>": a TCP connection
+ *
+ * The reader waits for data with poll() on a non-blocking
+ * descriptor, so stop() wakes it up immediately rather
+ * than after the next line. The ring is closed once the
+ * feed ends or the reader is stopped, after every sample
+ * read before that has been pushed.
+ */
+class live_feed {
+private:
+    /**
+     * The descriptor of the feed, or -1 if it could not be
+     * opened.
+     */
+    int fd{-1};
+    /**
+     * The pipe written to by stop() to wake the reader.
+     */
+    int wake[2]{-1, -1};
+    /**
+     * The reason the feed could not be opened.
+     */
+    std::string error;
+
+    /**
+     * The policy applied when the ring is full.
+     */
+    const overflow_policy policy;
+    /**
+     * The ring which the reader pushes samples into.
+     */
+    c11_spsc_ring<live_sample> ring;
+    /**
+     * The reader thread.
+     */
+    std::thread reader;
+
+    /**
+     * The number of samples parsed from the feed.
+     */
+    std::atomic<size_t> received{0};
+    /**
+     * The number of samples discarded by the drop policy.
+     */
+    std::atomic<size_t> dropped{0};
+    /**
+     * The number of samples replaced by newer ones under
+     * the coalesce policy.
+     */
+    std::atomic<size_t> coalesced{0};
+    /**
+     * The number of non-empty lines that could not be
+     * parsed.
+     */
+    std::atomic<size_t> malformed{0};
+
+    /**
+     * Runs the reader loop until the feed ends or the
+     * reader is stopped.
+     */
+    void read_loop();
+
+public:
+    /**
+     * Opens the given source and starts reading it.
+     *
+     * @param lf_source the source of the feed, see the
+     * class description
+     * @param lf_capacity the minimum number of samples
+     * buffered for the consumer
+     * @param lf_policy the policy applied when the buffer
+     * is full
+     */
+    live_feed(const std::string &lf_source, size_t lf_capacity, overflow_policy lf_policy);
+
+    live_feed(const live_feed &) = delete;
+
+    live_feed &operator=(const live_feed &) = delete;
+
+    /**
+     * Stops the reader and closes the feed.
+     */
+    ~live_feed();
+
+    /**
+     * Determines whether the source was successfully
+     * opened.
+     *
+     * @return true if the feed is being read
+     */
+    bool is_open() const;
+
+    /**
+     * Obtains the reason the source could not be opened.
+     *
+     * @return the error message
+     */
+    const std::string &get_error() const;
+
+    /**
+     * Obtains the ring which the samples are pushed into,
+     * which must have a single consumer.
+     *
+     * @return the sample ring
+     */
+    c11_spsc_ring<live_sample> &get_ring();
+
+    /**
+     * Stops reading the feed and closes the ring. Samples
+     * already in the ring can still be popped.
+     */
+    void stop();
+
+    /**
+     * Obtains the number of samples parsed from the feed.
+     *
+     * @return the received sample count
+     */
+    size_t get_received() const;
+
+    /**
+     * Obtains the number of samples discarded because the
+     * consumer was behind.
+     *
+     * @return the dropped sample count
+     */
+    size_t get_dropped() const;
+
+    /**
+     * Obtains the number of samples replaced by newer ones
+     * because the consumer was behind.
+     *
+     * @return the coalesced sample count
+     */
+    size_t get_coalesced() const;
+
+    /**
+     * Obtains the number of non-empty lines that could not
+     * be parsed.
+     *
+     * @return the malformed line count
+     */
+    size_t get_malformed() const;
+};
+
+#endif // LIFTOFF_CLI_LIVE_FEED_H
@@ -2,868 +2,657 @@
  * @file
  */
 
+#include <chrono>
 #include <cmath>
-#include <fstream>
+#include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
-#include <FL/Fl.H>
-#include <mgl2/mgl.h>
+#ifdef LIFTOFF_CLI_GUI
 #include <mgl2/fltk.h>
-#include <nlohmann/json.hpp>
 
-#include <liftoff-physics/body.h>
-#include <liftoff-physics/drag.h>
-#include <liftoff-physics/linalg.h>
-#include <liftoff-physics/telem_proc.h>
-#include <liftoff-physics/velocity_driven_body.h>
+#include "plot_sink.h"
+#endif
 
-#include "c11_binary_latch.h"
-#include "pidf_controller.h"
-#include "rocket.h"
-#include "engine.h"
+#include <liftoff-physics/event_detector.h>
+#include <liftoff-physics/linalg.h>
+#include <liftoff-physics/running_stats.h>
+#include <liftoff-physics/trace.h>
+
+#include "c11_spsc_ring.h"
+#include "dispersion.h"
+#include "flight_setup.h"
+#include "live_feed.h"
+#include "mission_manifest.h"
+#include "mission_scheduler.h"
+#include "rocket_sim.h"
 #include "telemetry_flight_profile.h"
+#include "telemetry_replay.h"
+#include "telemetry_sink.h"
+#include "tuning.h"
 #include "velocity_flight_profile.h"
+#include "vehicle_params.h"
+#include "velocity_source.h"
 
 static const double TICKS_PER_SEC = 1;
 static const double TIME_STEP = 1.0 / TICKS_PER_SEC;
 
-static const double ACCEL_G = 9.80665;
-
-// Coefficient of drag
-// https://space.stackexchange.com/questions/16883/whats-the-atmospheric-drag-coefficient-of-a-falcon-9-at-launch-sub-sonic-larg#16885
-static const double F9_CD = 0.25;
-// Frontal surface area, m^2
-// https://www.spacex.com/sites/spacex/files/falcon_users_guide_10_2019.pdf
-static const double F9_A = M_PI * 2.6 * 2.6;
-
-// Merlin 1D Max Thrust @ SL, N
-// https://www.spacex.com/sites/spacex/files/falcon_users_guide_10_2019.pdf
-static const double MERLIN_MAX_THRUST = 854000;
-// Merlin 1D I_sp (or as good of a guess as people get), s
-// https://en.wikipedia.org/wiki/Falcon_Heavy#cite_note-5
-static const double MERLIN_ISP = 282;
-// Merlin 1D nozzle exit area,
-// Estimates: https://forum.nasaspaceflight.com/index.php?topic=32983.45
-// Estimates: https://www.reddit.com/r/spacex/comments/4icycu/basic_analysis_of_the_merlin_1d_engine/d2x26pn/
-// 0.95 m seems to be a fair diameter compromise
-static const double MERLIN_A = M_PI * 0.475 * 0.475;
+// Duration of the telemetry replay, s
+static const double REPLAY_DURATION = 500;
+// Duration of the rocket simulation, s
+static const double SIM_DURATION = 400;
+// The number of velocity samples buffered between the replay and the simulation
+static const size_t FEED_CAPACITY = 256;
+// The number of bytes in a mebibyte, the unit of the memory budget
+static const size_t MIB = 1 << 20;
+// The number of live telemetry samples buffered between the reader and the replay
+static const size_t LIVE_CAPACITY = 1024;
+// The order and the number of samples of the sliding fit smoothing the live altitude
+static const unsigned int LIVE_FIT_ORDER = 2;
+static const size_t LIVE_FIT_SAMPLES = 32;
+// The smoothing and the hysteresis of the staging event detection on the live velocity,
+// which only updates about once a second between repeated samples
+static const double LIVE_EVENT_SMOOTHING = 2;
+static const double LIVE_EVENT_THRESHOLD = 1;
 
 /**
- * Converts the given number of seconds to ticks used in
- * the simulation.
- *
- * @param seconds the number of seconds
- * @return the equivalent number of ticks
+ * @brief The options given on the command line.
  */
-static long double to_ticks(int seconds) {
-    return seconds * TICKS_PER_SEC;
-}
+struct cli_options {
+    /**
+     * Whether to run without opening any windows.
+     */
+    bool headless{false};
+    /**
+     * The sink used in headless mode: csv, binary or null.
+     */
+    std::string sink{"csv"};
+    /**
+     * The path prefix of the files written by the file
+     * sinks.
+     */
+    std::string output{"liftoff"};
+    /**
+     * The path to the telemetry data file.
+     */
+    std::string data{"./data/data.json"};
+    /**
+     * The dispersion to run instead of a single rocket
+     * simulation if it has any runs.
+     */
+    dispersion_config dispersion;
+    /**
+     * The path to the manifest of the missions to run
+     * instead of the single mission, if not empty.
+     */
+    std::string manifest;
+    /**
+     * The estimated memory the missions of a batch may use
+     * at once, MiB, or 0 for no limit.
+     */
+    size_t memory_budget{0};
+    /**
+     * The live feed to replay instead of the telemetry data
+     * file, if not empty.
+     */
+    std::string live;
+    /**
+     * What to do with live samples that arrive while the
+     * replay is behind.
+     */
+    overflow_policy live_policy{overflow_policy::block};
+    /**
+     * The number of worker threads for the leg fits,
+     * dispersions and batches, or 0 for one per hardware
+     * thread.
+     */
+    size_t threads{0};
+    /**
+     * The path of the Chrome trace to write at exit, if
+     * not empty.
+     */
+    std::string trace;
+    /**
+     * The parameters to fit to the telemetry instead of
+     * running the simulations, if not empty.
+     */
+    std::string tune;
+    /**
+     * The most replays or simulations the refinement of
+     * the fit may run.
+     */
+    size_t tune_evaluations{200};
+};
 
 /**
- * Converts the given number of kilometers to the
- * equivalent number of meters.
+ * Prints the command line usage.
  *
- * @param km the number of kilometers
- * @return the equivalent number of meters
+ * @param program the name of the executable
  */
-static double km_to_m(double km) {
-    return km * 1000;
+static void print_usage(const char *program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl
+              << "  --headless         run both stages without opening any windows" << std::endl
+              << "  --sink <type>      headless output: csv (default), binary or null" << std::endl
+              << "  --output <prefix>  prefix of the headless output files (default: liftoff)" << std::endl
+              << "  --data <path>      telemetry data file (default: ./data/data.json)" << std::endl
+              << "  --dispersion <n>   run n dispersed rocket simulations, writing <prefix>-dispersion.csv" << std::endl
+              << "  --disperse <spec>  parameter distribution, e.g. cd=normal:0.25:0.02 or isp=uniform:275:290" << std::endl
+              << "                     (cd, thrust, isp, s1_dry, s1_fuel, s2_dry, s2_fuel, payload)" << std::endl
+              << "  --seed <n>         dispersion random seed (default: 0)" << std::endl
+              << "  --manifest <path>  run every mission in the NDJSON manifest, writing <prefix>-missions.csv" << std::endl
+              << "  --memory-budget <MiB>  estimated memory the missions may use at once (default: no limit)" << std::endl
+              << "  --live <source>    replay a live feed: - (stdin), unix:<path> or tcp:<host>:<port>" << std::endl
+              << "  --live-policy <p>  when the replay falls behind: block (default), drop or coalesce" << std::endl
+              << "  --threads <n>      worker threads for fitting, dispersions and batches (default: one per hardware thread)"
+              << std::endl
+              << "  --trace <path>     print the time spent in each stage and write a Chrome trace at exit"
+              << std::endl
+              << "                     (requires building with LIFTOFF_ENABLE_TRACE)" << std::endl
+              << "  --tune <target>    fit pidf (replay gains) or cd (drag coefficient) to the raw altitude" << std::endl
+              << "  --tune-evals <n>   most evaluations refining the fit after the grid sweep (default: 200)"
+              << std::endl;
 }
 
 /**
- * Determines the sign of the given number.
+ * Parses the command line into the given options.
  *
- * @param x the number which to determine the sign
- * @return -1 if negative, 1 if positive, 0 if 0
+ * @param argc the number of arguments
+ * @param argv the arguments
+ * @param options the options to write
+ * @return false if the arguments are invalid or help was
+ * requested
  */
-static int signum(double x) {
-    return (x > 0) - (x < 0);
+static bool parse_args(int argc, char **argv, cli_options &options) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "--headless") == 0) {
+            options.headless = true;
+        } else if (std::strcmp(arg, "--sink") == 0 && has_value) {
+            options.sink = argv[++i];
+            if (options.sink != "csv" && options.sink != "binary" && options.sink != "null") {
+                std::cout << "Unknown sink '" << options.sink << "'" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--output") == 0 && has_value) {
+            options.output = argv[++i];
+        } else if (std::strcmp(arg, "--data") == 0 && has_value) {
+            options.data = argv[++i];
+        } else if (std::strcmp(arg, "--dispersion") == 0 && has_value) {
+            options.dispersion.runs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--disperse") == 0 && has_value) {
+            if (!parse_param_distribution(argv[++i], options.dispersion)) {
+                std::cout << "Invalid distribution '" << argv[i] << "'" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--seed") == 0 && has_value) {
+            options.dispersion.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--manifest") == 0 && has_value) {
+            options.manifest = argv[++i];
+        } else if (std::strcmp(arg, "--memory-budget") == 0 && has_value) {
+            options.memory_budget = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--live") == 0 && has_value) {
+            options.live = argv[++i];
+        } else if (std::strcmp(arg, "--live-policy") == 0 && has_value) {
+            if (!parse_overflow_policy(argv[++i], options.live_policy)) {
+                std::cout << "Unknown policy '" << argv[i] << "'" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--threads") == 0 && has_value) {
+            options.threads = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--trace") == 0 && has_value) {
+            options.trace = argv[++i];
+        } else if (std::strcmp(arg, "--tune") == 0 && has_value) {
+            options.tune = argv[++i];
+            tuning_target target;
+            if (!parse_tuning_target(options.tune, target)) {
+                std::cout << "Unknown tuning target '" << options.tune << "'" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--tune-evals") == 0 && has_value) {
+            options.tune_evaluations = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            if (std::strcmp(arg, "--help") != 0) {
+                std::cout << "Unknown option '" << arg << "'" << std::endl;
+            }
+
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /**
- * Helper function used to update the given MathGL window
- * from another thread. This must be called using the
- * Fl::update() function.
+ * Creates the headless sink for the given stage.
  *
- * @param data the pointer to the MathGL window
+ * @param options the command line options
+ * @param stage the name of the stage, used as the file
+ * name suffix
+ * @return the sink, or nullptr if its file cannot be
+ * opened
  */
-static void update_wnd(void *data) {
-    auto *gr = static_cast<mglWnd *>(data);
-    gr->Update();
+static std::unique_ptr<telemetry_sink> make_sink(const cli_options &options, const std::string &stage) {
+    std::string path = options.output + "-" + stage;
+    std::unique_ptr<telemetry_sink> sink = make_telemetry_sink(options.sink, path);
+    if (!sink) {
+        std::cout << "Cannot write to '" << path << "'" << std::endl;
+    }
+
+    return sink;
 }
 
 /**
- * Parses the SpaceXtract telemetry file from the given
- * path into the given flight profile.
+ * Reports whether the headless sink for the given stage
+ * could not write all of its frames.
  *
- * @param raw the raw flight profile to parse data into
- * @param path the path to the telemetry data file
+ * @param options the command line options
+ * @param stage the name of the stage, used as the file
+ * name suffix
+ * @param sink the sink, after its stage has ended
+ * @return true if the output of the stage is incomplete
  */
-static void parse_telem(telemetry_flight_profile &raw, const std::string &path) {
-    std::ifstream data_file{path};
-    if (!data_file.good()) {
-        std::cout << "Cannot find file '" << path << "'" << std::endl;
-        data_file.close();
-        return;
+static bool sink_failed(const cli_options &options, const std::string &stage, const telemetry_sink &sink) {
+    if (!sink.has_failed()) {
+        return false;
     }
 
-    std::string line;
-    while (std::getline(data_file, line)) {
-        const auto &json = nlohmann::json::parse(line);
-        double time = json["time"];
-        double velocity = json["velocity"];
-        double altitude = json["altitude"];
-
-        raw.put_velocity(time, velocity);
-        raw.put_altitude(time, km_to_m(altitude));
-    }
-    data_file.close();
+    std::cout << "Failed to write '" << options.output << "-" << stage << "'" << std::endl;
+    return true;
 }
 
 /**
- * Performs the telemetry data parsing and then smooths the
- * data using interpolation and curve fitting.
+ * Prints the propellant remaining at MECO and when the
+ * first stage ran out of propellant, if it did.
  *
- * @param raw the raw telemetry data
- * @param fitted the processed data
- * @param path the path to the telemetry data file
+ * @param sim the completed rocket simulation
  */
-static void setup_flight_profile(telemetry_flight_profile &raw,
-                                 telemetry_flight_profile &fitted,
-                                 const std::string &path) {
-    // JCSAT-18/KACIFIC1
-
-    // https://everydayastronaut.com/prelaunch-preview-falcon-9-block-5-jcsat-18-kacific-1/
-    raw.set_range(651000);
-    parse_telem(raw, path);
-
-    // Perform linear interpolation for velocity
-    liftoff::interp_lin(fitted.get_velocities(), raw.get_velocities());
-
-    // Find MECO/SES/SECO events
-    const std::map<double, double> &v_fitted = fitted.get_velocities();
-    auto meco_ptr = liftoff::find_event_time(++v_fitted.cbegin(), v_fitted, true);
-    auto ses_1_ptr = liftoff::find_event_time(meco_ptr, v_fitted, false);
-    auto seco_1_ptr = liftoff::find_event_time(ses_1_ptr, v_fitted, true);
-
-    // events contains timestamps for beginning of the next leg
-    // i.e. leg 1 < meco; meco <= leg 2
-    std::vector<double> events = {meco_ptr->first, ses_1_ptr->first, seco_1_ptr->first};
-    int n_events = events.size();
-
-    // Perform linear interpolation for altitude
-    const std::map<double, double> &alt_fitted = fitted.get_altitudes();
-    liftoff::interp_lin(fitted.get_altitudes(), raw.get_altitudes());
-
-    // Divide the data by each leg of the mission
-    std::vector<std::vector<double>> times;
-    std::vector<std::vector<double>> legs;
-    liftoff::collect(times, legs, alt_fitted, events);
-
-    // Step 1: Force points are the same for leg 1 and 3
-
-    // Determine which points to force on the curve fit in
-    // order to maintain the correct state between legs for
-    // legs 1 and 3
-    std::vector<liftoff::polynomial> alt_fit;
-    for (int l = 0; l < n_events; ++l) {
-        std::vector<std::pair<double, double>> force_points;
-        if (l == 0) {
-            liftoff::force(force_points, alt_fitted, times[1], 1);
-        } else if (l == 2) {
-            liftoff::force(force_points, alt_fitted, times[1], -1);
-        }
-
-        // Increase the order of the least-squares curve
-        // regression
-        alt_fit.push_back(liftoff::fit(4 + force_points.size(), times[l], legs[l], force_points));
-    }
-
-    // Re-write the curve-fitted values into the profile
-    for (const auto &it : alt_fitted) {
-        double t = it.first;
-        double alt = it.second;
-        for (int i = 0; i < n_events; ++i) {
-            if (t < events[i]) {
-                if (i == 1) {
-                    break;
-                }
-
-                alt = alt_fit[i].val(t);
-                if (alt < 0) {
-                    alt = 0;
-                }
-
-                fitted.put_altitude(t, alt);
-                break;
-            }
-        }
+static void print_sim_summary(const rocket_sim &sim) {
+    if (!std::isnan(sim.get_burnout_time())) {
+        std::cout << sim.get_burnout_time() << ": No propellant" << std::endl;
     }
 
-    // Step 2: change the number of forced points for leg 2
-
-    // Find the correct forced points for leg 2
-    std::vector<std::pair<double, double>> force_points;
-    liftoff::force(force_points, alt_fitted, times[0], -3);
-    liftoff::force(force_points, alt_fitted, times[2], 3);
-
-    // Re-write curve-fitted values for leg 2 into the
-    // profile
-    // Use the same order as forced points to avoid
-    // deviation due to sharp changes in altitude
-    liftoff::polynomial lip_fit = liftoff::lip(force_points);
-    for (const auto &t : times[1]) {
-        fitted.put_altitude(t, lip_fit.val(t));
+    if (!std::isnan(sim.get_meco_propellant())) {
+        std::cout << "MECO: Remaining propellant = " << sim.get_meco_propellant() << " kg" << std::endl;
     }
 }
 
 /**
- * Uses the Pythagorean theorem to determine the vertical
- * velocity based on the total velocity and altitude delta.
+ * Runs the telemetry replay and the rocket simulation,
+ * recording both into the sinks selected on the command
+ * line.
  *
- * This procedure supports only X and Y components.
+ * The replay runs on its own thread and passes each tick
+ * to the simulation on this thread as soon as it is
+ * produced.
  *
- * @param pidf the PIDF controller containing to compute
- * the altitude delta and the time step
- * @param cur_v the current velocity vector
- * @param mag_v the magnitude of the velocity for which
- * to compute the next velocity
- * @return the new desired velocity
+ * @param options the command line options
+ * @param fitted the conditioned flight profile
+ * @return 0 if successful
  */
-static liftoff::vector adjust_velocity(pidf_controller &pidf, const liftoff::vector &cur_v, double mag_v) {
-    double target_x_velocity;
-    double target_y_velocity;
-
-    if (pidf.get_setpoint() == 0) {
-        // 0 setpoint, must be around liftoff so the velocity
-        // must be exactly vertical
-        target_x_velocity = 0;
-        target_y_velocity = mag_v;
-    } else {
-        double error = pidf.compute_error();
-        target_y_velocity = error / pidf.get_time_step();
-
-        // The velocity needed to reach the setpoint is
-        // greater than the next velocity magnitude, so
-        // set the Y velocity to the entire magnitude of
-        // velocity
-        if (std::abs(target_y_velocity) > mag_v) {
-            target_y_velocity = signum(target_y_velocity) * mag_v;
-        }
-
-        // Otherwise, to reach the velocity magnitude,
-        // there needs to be an additional horizontal
-        // component
-        target_x_velocity = std::sqrt((double) (mag_v * mag_v - target_y_velocity * target_y_velocity));
+static int run_headless(const cli_options &options, const telemetry_flight_profile &fitted) {
+    std::unique_ptr<telemetry_sink> replay_sink = make_sink(options, "replay");
+    std::unique_ptr<telemetry_sink> sim_sink = make_sink(options, "sim");
+    if (!replay_sink || !sim_sink) {
+        return 1;
     }
 
-    return {target_x_velocity, target_y_velocity, 0};
+    velocity_flight_profile result{TIME_STEP};
+    c11_spsc_ring<velocity_sample> feed{FEED_CAPACITY};
+
+    telemetry_replay replay{fitted, result, REPLAY_DURATION};
+    replay.set_feed(&feed);
+    std::thread replay_thread{[&] {
+        replay.run(*replay_sink);
+    }};
+
+    ring_velocity_source source{feed};
+    rocket_sim sim{source, FALCON_9, TIME_STEP, SIM_DURATION};
+    sim.run(*sim_sink);
+    print_sim_summary(sim);
+
+    // Let the replay finish without waiting on the
+    // simulation
+    feed.close();
+    replay_thread.join();
+
+    bool replay_failed = sink_failed(options, "replay", *replay_sink);
+    bool sim_failed = sink_failed(options, "sim", *sim_sink);
+    return replay_failed || sim_failed ? 1 : 0;
 }
 
 /**
- * Post-curve fitting adjustment to the altitude to
- * converge the velocity integral and the altitude profile.
- * Running this in a loop to determine the break-even will
- * find the "pitch time" or the time where the rocket
- * begins begin to travel horizontally rather than
- * just vertically.
+ * Runs the telemetry replay to obtain the velocity profile
+ * and then the dispersed rocket simulations across a
+ * thread pool, writing the envelopes to a CSV file and
+ * summarizing the MECO propellant.
  *
- * @param orig the original flight profile
- * @param fitted the curve-fit profile to write the results
- * @param break_even the time at which the velocity
- * integral and the altitude are to break even
- * @param max_time the maximum time to limit the
- * velocity integration range
+ * @param options the command line options
+ * @param fitted the conditioned flight profile
+ * @param pool the pool to run the simulations on
+ * @return 0 if successful
  */
-static void adjust_altitude(const telemetry_flight_profile &orig,
-                            telemetry_flight_profile &fitted,
-                            double break_even,
-                            double max_time) {
-    double last_t = 0;
-    double last_alt = 0;
-    double v_integral = 0;
-    for (int i = 0; i < max_time / fitted.get_time_step(); ++i) {
-        double t = i * fitted.get_time_step();
-        double alt = fitted.get_altitude(t);
-        double v = fitted.get_velocity(t);
-
-        // Integrate velocity using Euler's method
-        double dt = fitted.get_time_step();
-        v_integral += v * dt;
-
-        if (t < break_even) {
-            // Re-fit the altitude with the velocity integral
-            fitted.put_altitude(t, v_integral);
-            last_alt = v_integral;
-        } else {
-            // Then for the rest of the profile, adjust the
-            // altitude and translate downwards from the
-            // original flight profile so the rest of the
-            // profile connects with the velocity integral
-            // break-even
-            double target_error = orig.get_altitude(t) - orig.get_altitude(last_t);
-            double target_alt = last_alt + target_error;
-            if (target_alt >= alt) {
-                break;
-            }
+static int run_dispersion_mode(const cli_options &options, const telemetry_flight_profile &fitted,
+                               liftoff::thread_pool &pool) {
+    velocity_flight_profile result{TIME_STEP};
+    null_sink replay_sink;
+    telemetry_replay replay{fitted, result, REPLAY_DURATION};
+    replay.run(replay_sink);
 
-            fitted.put_altitude(t, target_alt);
-            last_alt = target_alt;
-        }
+    dispersion_result dispersion = run_dispersion(options.dispersion, result, TIME_STEP, SIM_DURATION, pool);
 
-        last_t = t;
+    std::string path = options.output + "-dispersion.csv";
+    if (!write_dispersion_csv(path, dispersion)) {
+        std::cout << "Cannot write to '" << path << "'" << std::endl;
+        return 1;
     }
+
+    const liftoff::running_stats &meco = dispersion.meco_stats;
+    std::cout << options.dispersion.runs << " runs on " << pool.size() << " threads, "
+              << dispersion.burnouts << " ran out of propellant" << std::endl;
+    std::cout << "MECO: Remaining propellant mean = " << meco.get_mean()
+              << " kg, stddev = " << meco.stddev() << " kg" << std::endl;
+    std::cout << "MECO: Remaining propellant p5 = " << dispersion.meco_percentile(5)
+              << " kg, p50 = " << dispersion.meco_percentile(50)
+              << " kg, p95 = " << dispersion.meco_percentile(95) << " kg" << std::endl;
+
+    return 0;
 }
 
 /**
- * @brief Runs the full flight profile parsed directly from
- * data and then conditioned to obtain the X/Y resulting
- * velocity profile.
+ * Runs every mission in the manifest across a thread pool,
+ * writing the outcome of each one to a CSV file.
+ *
+ * @param options the command line options
+ * @param pool the pool to run the missions on
+ * @return 0 if every mission in the manifest succeeded
  */
-class run_telemetry_profile : public mglDraw {
-private:
-    /**
-     * The resulting flight profile with the extracted
-     * horizontal velocity component.
-     */
-    velocity_flight_profile &profile;
-    /**
-     * The simulation completion latch.
-     */
-    c11_binary_latch latch;
+static int run_batch_mode(const cli_options &options, liftoff::thread_pool &pool) {
+    std::vector<mission> missions;
+    std::vector<std::string> errors;
+    if (!load_mission_manifest(options.manifest, missions, errors)) {
+        std::cout << "Cannot find file '" << options.manifest << "'" << std::endl;
+        return 1;
+    }
 
-    /**
-     * The data used for plotting on the window.
-     */
-    mglData plot_data;
-    /**
-     * The plot window to update with the data.
-     */
-    mglWnd *wnd_inst{nullptr};
-public:
-    /**
-     * Creates a new instance of the telemetry data
-     * plotting class with the given flight profile to
-     * store the results of running the simulation.
-     *
-     * @param profile the result of running the simulation
-     * and processing the data
-     */
-    explicit run_telemetry_profile(velocity_flight_profile &profile) :
-            profile(profile) {
+    for (const std::string &error : errors) {
+        std::cout << error << std::endl;
     }
 
-    /**
-     * Obtains the profile generated from running the
-     * simulation.
-     *
-     * Not valid before get_latch().wait() returns.
-     *
-     * @return the X/Y profile computed from the
-     * conditioned telemetry data
-     */
-    const velocity_flight_profile &get_profile() const {
-        return profile;
+    scheduler_config config;
+    config.time_step = TIME_STEP;
+    config.replay_duration = REPLAY_DURATION;
+    config.sim_duration = SIM_DURATION;
+    config.sink = options.sink;
+    config.memory_budget = options.memory_budget * MIB;
+
+    std::vector<mission_result> results = run_missions(missions, config, pool);
+
+    size_t failed = 0;
+    for (const mission_result &result : results) {
+        if (!result.ok) {
+            ++failed;
+            std::cout << result.name << ": Failed: " << result.error << std::endl;
+        } else if (!std::isnan(result.meco_propellant)) {
+            std::cout << result.name << ": MECO: Remaining propellant = " << result.meco_propellant << " kg"
+                      << std::endl;
+        } else {
+            std::cout << result.name << ": " << result.burnout_time << ": No propellant" << std::endl;
+        }
     }
 
-    /**
-     * Obtains the completion latch, which will be released
-     * when the simulation ends.
-     *
-     * @return the latch which completes at the end of the
-     * telemetry replay
-     */
-    c11_binary_latch &get_latch() {
-        return latch;
+    std::string path = options.output + "-missions.csv";
+    if (!write_mission_results_csv(path, results)) {
+        std::cout << "Cannot write to '" << path << "'" << std::endl;
+        return 1;
     }
 
-    /**
-     * Sets the window initialized by this MathGL drawing
-     * class.
-     *
-     * @param wnd the pointer to the window
-     */
-    void set_window(mglWnd *wnd) {
-        wnd_inst = wnd;
+    std::cout << results.size() << " missions on " << pool.size() << " threads, " << failed << " failed" << std::endl;
+    return failed == 0 && errors.empty() ? 0 : 1;
+}
+
+/**
+ * Replays a live telemetry feed as its samples arrive and
+ * runs the rocket simulation alongside it, recording both
+ * into the sinks selected on the command line.
+ *
+ * The feed is read on its own thread. The replay thread
+ * appends each sample to the profile, smoothing the
+ * altitude with a sliding fit, and replays every tick up
+ * to the time of the sample before taking the next one.
+ * The staging events are reported as soon as they are
+ * detected.
+ * It ends once the feed does or the replay duration has
+ * passed.
+ *
+ * @param options the command line options
+ * @return 0 if successful
+ */
+static int run_live_mode(const cli_options &options) {
+    std::unique_ptr<telemetry_sink> replay_sink = make_sink(options, "replay");
+    std::unique_ptr<telemetry_sink> sim_sink = make_sink(options, "sim");
+    if (!replay_sink || !sim_sink) {
+        return 1;
     }
 
-    int Draw(mglGraph *gr) override {
-        gr->Clf();
-
-        gr->SubPlot(2, 2, 0);
-        gr->Title("Position");
-        gr->Label('x', "Downrange Distance (m)");
-        gr->Label('y', "Altitude (m)");
-        gr->Grid();
-        gr->Box();
-        gr->SetRanges(plot_data.SubData(-1, 0, 0), plot_data.SubData(-1, 0, 1));
-        gr->Axis("xy");
-        gr->Plot(plot_data.SubData(-1, 0, 0), plot_data.SubData(-1, 0, 1));
-
-        gr->SubPlot(2, 2, 1);
-        gr->Title("Velocity");
-        gr->Label('x', "Time (s)");
-        gr->Label('y', "Y Velocity (m/s)");
-        gr->Grid();
-        gr->Box();
-        gr->SetRanges(plot_data.SubData(-1, 1, 0), plot_data.SubData(-1, 1, 1));
-        gr->Axis("xy");
-        gr->Plot(plot_data.SubData(-1, 1, 0), plot_data.SubData(-1, 1, 1));
-
-        gr->SubPlot(2, 2, 2);
-        gr->Title("Acceleration");
-        gr->Label('x', "Time (s)");
-        gr->Label('y', "Y Acceleration (m/s^2)");
-        gr->Grid();
-        gr->Box();
-        gr->SetRanges(plot_data.SubData(-1, 2, 0), plot_data.SubData(-1, 2, 1));
-        gr->Axis("xy");
-        gr->Plot(plot_data.SubData(-1, 2, 0), plot_data.SubData(-1, 2, 1));
-
-        gr->SubPlot(2, 2, 3);
-        gr->Title("Jerk");
-        gr->Label('x', "Time (s)");
-        gr->Label('y', "Y Jerk (m/s^3)");
-        gr->Grid();
-        gr->Box();
-        gr->SetRanges(plot_data.SubData(-1, 3, 0), plot_data.SubData(-1, 3, 1));
-        gr->Axis("xy");
-        gr->Plot(plot_data.SubData(-1, 3, 0), plot_data.SubData(-1, 3, 1));
-
-        return 0;
+    live_feed feed{options.live, LIVE_CAPACITY, options.live_policy};
+    if (!feed.is_open()) {
+        std::cout << "Cannot open live feed '" << options.live << "': " << feed.get_error() << std::endl;
+        return 1;
     }
 
-    void Calc() override {
-        // Rocket setup
-        // Source: https://www.spaceflightinsider.com/hangar/falcon-9/
-        const double stage_1_dry_mass_kg = 25600;
-        const double stage_1_fuel_mass_kg = 395700;
-        const double stage_2_dry_mass_kg = 3900;
-        const double stage_2_fuel_mass_kg = 92670;
-        const double payload_mass_kg = 6800;
-
-        double total_mass = stage_1_dry_mass_kg + stage_1_fuel_mass_kg +
-                            stage_2_dry_mass_kg + stage_2_fuel_mass_kg +
-                            payload_mass_kg;
-
-        double time_step = 1;
-        liftoff::velocity_driven_body body{total_mass, 4, time_step};
-
-        // Flight profile setup
-        telemetry_flight_profile raw{time_step};
-        telemetry_flight_profile fitted{time_step};
-        setup_flight_profile(raw, fitted, "./data/data.json");
-        const telemetry_flight_profile orig = fitted;
-
-        double max_time = 500;
-        int total_steps = static_cast<int>(max_time / time_step);
-
-        // Final conditioning step
-        double last_corrected_time = 0;
-        while (true) {
-            bool valid = true;
-            double last_t = 0;
-            double last_alt = 0;
-            for (int i = 0; i < total_steps; ++i) {
-                double t = i * time_step;
-                double alt = fitted.get_altitude(t);
-
-                double dt = t - last_t;
-                double target_error = alt - last_alt;
-                double target_v = target_error / dt;
-                double v = fitted.get_velocity(t);
-
-                // This loop ensures that there is enough
-                // velocity in order to move the rocket to
-                // the next recorded altitude
-                // If there is not enough velocity, the
-                // flight profile's altitude needs to be
-                // translated down to match with the
-                // velocity integral
-                // Recursively do so until we can ensure
-                // the entire profile velocity/altitudes
-                // match
-                if (v < target_v && last_corrected_time < t) {
-                    last_corrected_time = t;
-                    adjust_altitude(orig, fitted, t, max_time);
-
-                    valid = false;
-                    break;
-                }
-
-                last_t = t;
-                last_alt = alt;
-            }
+    telemetry_flight_profile live{TIME_STEP};
+    live.set_range(flight_setup_params{}.range);
 
-            if (valid) {
-                break;
+    velocity_flight_profile result{TIME_STEP};
+    c11_spsc_ring<velocity_sample> velocities{FEED_CAPACITY};
+    telemetry_replay replay{live, result, REPLAY_DURATION};
+    replay.set_feed(&velocities);
+
+    // From reading the sample to replaying it, us
+    liftoff::running_stats latency;
+    std::thread replay_thread{[&] {
+        liftoff::streaming_fit alt_fit{LIVE_FIT_ORDER, LIVE_FIT_SAMPLES};
+        liftoff::event_detector_params event_params;
+        event_params.smoothing = LIVE_EVENT_SMOOTHING;
+        event_params.threshold = LIVE_EVENT_THRESHOLD;
+        liftoff::event_detector events{STAGING_EVENTS, event_params};
+        replay_sink->begin(replay.get_total_steps());
+
+        live_sample sample{};
+        while (replay.get_time() < REPLAY_DURATION && feed.get_ring().pop(sample)) {
+            double time = sample.sample.time;
+            double alt = km_to_m(sample.sample.altitude);
+
+            // Keep the raw altitude until the window can
+            // determine the fit
+            alt_fit.push(time, alt);
+            if (alt_fit.size() > LIVE_FIT_ORDER + 1) {
+                alt = alt_fit.val(time);
             }
-        }
-
-        const std::vector<liftoff::vector> &d_mot{body.get_d_mot()};
-
-        // Telemetry
-        const liftoff::vector &p{d_mot[0]};
-        const liftoff::vector &v{d_mot[1]};
-        const liftoff::vector &a{d_mot[2]};
-        const liftoff::vector &j{d_mot[3]};
-
-        std::vector<double> recorded_drag;
-        recorded_drag.push_back(0);
-
-        pidf_controller pidf{time_step, 0, 0, 0, 0};
-
-        plot_data.Create(1, 4, 2);
-        for (int i = 0; i < total_steps; ++i) {
-            double cur_time_s = i * time_step;
 
-            body.pre_compute();
-            pidf.set_last_state(p.get_y());
-
-            // Position/velocity computation
-            double telem_velocity = fitted.get_velocity(cur_time_s);
-            double telem_alt = fitted.get_altitude(cur_time_s);
-            if (!std::isnan(telem_velocity) && !std::isnan(telem_alt)) {
-                pidf.set_setpoint(telem_alt);
-
-                const liftoff::vector &new_velocity = adjust_velocity(pidf, v, telem_velocity);
-                body.set_velocity(new_velocity);
+            live.put_velocity(time, sample.sample.velocity);
+            live.put_altitude(time, alt);
+            if (events.push(time, sample.sample.velocity)) {
+                std::cout << STAGING_EVENT_NAMES[events.get_event_count() - 1] << " at " << time << " s"
+                          << std::endl;
             }
-
-            // Compute drag force
-            double drag_x = liftoff::calc_drag_earth(F9_CD, p.get_y(), v.get_x(), F9_A);
-            double drag_y = liftoff::calc_drag_earth(F9_CD, p.get_y(), v.get_y(), F9_A);
-            liftoff::vector cur_drag{drag_x, drag_y, 0};
-            recorded_drag.push_back(cur_drag.get_y());
-
-            // Computation
-            body.compute_motion();
-            body.post_compute();
-
-            // Record data into the matrix
-            if (i != 0) {
-                plot_data.Insert('x', i);
+            while (replay.get_time() <= time && replay.step(*replay_sink)) {
             }
 
-            plot_data.Put(p.get_x(), i, 0, 0);
-            plot_data.Put(p.get_y(), i, 0, 1);
+            latency.add(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - sample.arrival).count());
+        }
 
-            plot_data.Put(cur_time_s, i, 1, 0);
-            plot_data.Put(v.magnitude(), i, 1, 1);
+        // The feed may outlast the replay
+        feed.stop();
+        replay_sink->end();
+        velocities.close();
+    }};
+
+    ring_velocity_source source{velocities};
+    rocket_sim sim{source, FALCON_9, TIME_STEP, SIM_DURATION};
+    sim.run(*sim_sink);
+    print_sim_summary(sim);
+
+    // Let the replay follow the feed to its end without
+    // waiting on the simulation
+    velocities.close();
+    replay_thread.join();
+
+    std::cout << "Live feed: " << feed.get_received() << " samples, " << feed.get_dropped() << " dropped, "
+              << feed.get_coalesced() << " coalesced, " << feed.get_malformed() << " malformed" << std::endl;
+    if (latency.count() != 0) {
+        std::cout << std::setprecision(3) << "Live latency: mean " << latency.get_mean() << " us, max "
+                  << latency.get_max() << " us" << std::setprecision(16) << std::endl;
+    }
 
-            plot_data.Put(cur_time_s, i, 2, 0);
-            plot_data.Put(a.magnitude(), i, 2, 1);
+    bool replay_failed = sink_failed(options, "replay", *replay_sink);
+    bool sim_failed = sink_failed(options, "sim", *sim_sink);
+    return replay_failed || sim_failed ? 1 : 0;
+}
 
-            plot_data.Put(cur_time_s, i, 3, 0);
-            plot_data.Put(j.magnitude(), i, 3, 1);
+/**
+ * Fits the parameters selected on the command line to the
+ * raw altitude across a thread pool, printing the best
+ * values.
+ *
+ * @param options the command line options
+ * @param raw the unconditioned flight profile
+ * @param fitted the conditioned flight profile
+ * @param pool the pool to evaluate the candidates on
+ * @return 0 if successful
+ */
+static int run_tuning_mode(const cli_options &options, const telemetry_flight_profile &raw,
+                           const telemetry_flight_profile &fitted, liftoff::thread_pool &pool) {
+    tuning_config config;
+    parse_tuning_target(options.tune, config.target);
+    config.refine.max_evaluations = options.tune_evaluations;
+    config.replay_duration = REPLAY_DURATION;
+    config.sim_time_step = TIME_STEP;
+    config.sim_duration = SIM_DURATION;
+    config.nominal = FALCON_9;
+
+    tuning_result result = run_tuning(config, raw, fitted, pool);
+    for (size_t i = 0; i < result.names.size(); ++i) {
+        std::cout << result.names[i] << " = " << result.values[i] << std::endl;
+    }
+    std::cout << "Altitude RMS error = " << result.rms_error << " m, " << result.evaluations
+              << " evaluations on " << pool.size() << " threads" << std::endl;
 
-            // Check for pausing
-            Check();
+    return 0;
+}
 
-            // Update the window
-            Fl::awake(update_wnd, wnd_inst);
+#ifdef LIFTOFF_CLI_GUI
+/**
+ * Runs the telemetry replay and the rocket simulation in
+ * their own windows, with the simulation following each
+ * tick of the replay as soon as it is produced.
+ *
+ * @param fitted the conditioned flight profile
+ * @return the exit code of the FLTK event loop
+ */
+static int run_windowed(const telemetry_flight_profile &fitted) {
+    velocity_flight_profile result{TIME_STEP};
+    c11_spsc_ring<velocity_sample> feed{FEED_CAPACITY};
 
-            // Record data to the result profile
-            profile.put_vx(cur_time_s, v.get_x());
-            profile.put_vy(cur_time_s, v.get_y());
+    // Run the telemetry profile simulation and record the
+    // results to the given flight profile
+    plot_sink replay_plot{[&](telemetry_sink &sink) {
+        telemetry_replay replay{fitted, result, REPLAY_DURATION};
+        replay.set_feed(&feed);
+        replay.run(sink);
+    }};
+    mglFLTK mgl_run_telem{&replay_plot, "SpaceX JCSAT-18/KACIFIC1 Flight Replay"};
+    replay_plot.set_window(&mgl_run_telem);
+    replay_plot.Run();
 
-            /* std::cout << cur_time_s << ", " << v.magnitude() << ", " << p.get_y() << ", " << pidf.compute_error()
-                      << ", "
-                      << p.get_x() << ", " << v.get_x() << ", " << v.get_y() << ", " << a.get_x() << ", " << a.get_y()
-                      << ", " << a.magnitude() << ", " << j.get_x() << ", " << j.get_y() << ", " << j.magnitude()
-                      << ", "
-                      << pidf.get_setpoint() << ", " << pidf.get_last_state() << ", " << raw.get_altitude(cur_time_s)
-                      << ", " << raw.get_altitude(cur_time_s) - p.get_y() << std::endl; */
-        }
+    // Attempt to simulate with the parsed flight profile
+    // data with the test model
+    plot_sink sim_plot{[&](telemetry_sink &sink) {
+        ring_velocity_source source{feed};
+        rocket_sim sim{source, FALCON_9, TIME_STEP, SIM_DURATION};
+        sim.run(sink);
+        print_sim_summary(sim);
+
+        feed.close();
+    }};
+    mglFLTK mgl_run_test{&sim_plot, "SpaceX JCSAT-18/KACIFIC1 Flight Sim"};
+    sim_plot.set_window(&mgl_run_test);
+    sim_plot.Run();
 
-        latch.release();
-    }
-};
+    return mgl_fltk_run();
+}
+#endif
 
 /**
- * @brief Creates a rocket model to run the profile from
- * the flight simulation and then simulate again using
- * parameters that attempt to match the original rocket.
+ * Prints the stage report and writes the Chrome trace
+ * recorded over the run.
+ *
+ * @param options the command line options
  */
-class run_test_rocket : public mglDraw {
-private:
-    /**
-     * The parsing flight simulation used to obtain the
-     * profile to model in this simulation.
-     */
-    run_telemetry_profile &rtp;
-
-    /**
-     * The data used for plotting on the window.
-     */
-    mglData plot_data;
-    /**
-     * The plot window to update with the data.
-     */
-    mglWnd *wnd_inst{nullptr};
-public:
-    /**
-     * Constructs the model using the profile generated by
-     * the given simulation instance.
-     *
-     * @param rtp the simulation that produces the flight
-     * profile for this model
-     */
-    explicit run_test_rocket(run_telemetry_profile &rtp) :
-            rtp(rtp) {
+static void write_trace(const cli_options &options) {
+    if (!liftoff::trace::enabled()) {
+        std::cout << "Built without LIFTOFF_ENABLE_TRACE, no trace was recorded" << std::endl;
+        return;
     }
 
-    /**
-     * Sets the window initialized by this MathGL drawing
-     * class.
-     *
-     * @param wnd the pointer to the window
-     */
-    void set_window(mglWnd *wnd) {
-        wnd_inst = wnd;
+    liftoff::trace::print_report(std::cout);
+    if (!liftoff::trace::write_chrome_trace(options.trace)) {
+        std::cout << "Cannot write to '" << options.trace << "'" << std::endl;
     }
+}
 
-    int Draw(mglGraph *gr) override {
-        gr->Clf();
-
-        gr->SubPlot(2, 2, 0);
-        gr->Title("Position");
-        gr->Label('x', "Downrange Distance (m)");
-        gr->Label('y', "Altitude (m)");
-        gr->Grid();
-        gr->Box();
-        gr->SetRanges(plot_data.SubData(-1, 0, 0), plot_data.SubData(-1, 0, 1));
-        gr->Axis("xy");
-        gr->Plot(plot_data.SubData(-1, 0, 0), plot_data.SubData(-1, 0, 1));
-
-        gr->SubPlot(2, 2, 1);
-        gr->Title("Velocity");
-        gr->Label('x', "Time (s)");
-        gr->Label('y', "Y Velocity (m/s)");
-        gr->Grid();
-        gr->Box();
-        gr->SetRanges(plot_data.SubData(-1, 1, 0), plot_data.SubData(-1, 1, 1));
-        gr->Axis("xy");
-        gr->Plot(plot_data.SubData(-1, 1, 0), plot_data.SubData(-1, 1, 1));
-
-        gr->SubPlot(2, 2, 2);
-        gr->Title("Acceleration");
-        gr->Label('x', "Time (s)");
-        gr->Label('y', "Y Acceleration (m/s^2)");
-        gr->Grid();
-        gr->Box();
-        gr->SetRanges(plot_data.SubData(-1, 2, 0), plot_data.SubData(-1, 2, 1));
-        gr->Axis("xy");
-        gr->Plot(plot_data.SubData(-1, 2, 0), plot_data.SubData(-1, 2, 1));
-
-        gr->SubPlot(2, 2, 3);
-        gr->Title("Jerk");
-        gr->Label('x', "Time (s)");
-        gr->Label('y', "Y Jerk (m/s^3)");
-        gr->Grid();
-        gr->Box();
-        gr->SetRanges(plot_data.SubData(-1, 3, 0), plot_data.SubData(-1, 3, 1));
-        gr->Axis("xy");
-        gr->Plot(plot_data.SubData(-1, 3, 0), plot_data.SubData(-1, 3, 1));
-
-        return 0;
+/**
+ * Runs the mode selected on the command line.
+ *
+ * @param options the command line options
+ * @param pool the pool shared by the leg fits, the
+ * dispersion runs and the missions of a batch
+ * @return 0 if successful
+ */
+static int run_mode(const cli_options &options, liftoff::thread_pool &pool) {
+    if (!options.manifest.empty()) {
+        return run_batch_mode(options, pool);
     }
 
-    void Calc() override {
-        // Wait for the simulation completion
-        rtp.get_latch().wait();
-
-        // Set up the rocket
-        // These numbers come from up there ^^
-        const double stage_1_dry_mass_kg = 25600;
-        const double stage_1_fuel_mass_kg = 395700;
-        const double stage_2_dry_mass_kg = 3900;
-        const double stage_2_fuel_mass_kg = 92670;
-        const double payload_mass_kg = 6800;
-
-        double merlin_p_e = liftoff::calc_pressure_earth(0) * 1000;
-        std::vector<engine> engines;
-        for (int i = 0; i < 9; ++i) {
-            engine e{MERLIN_MAX_THRUST, MERLIN_ISP};
-            engines.push_back(e);
-        }
-
-        rocket body{stage_1_dry_mass_kg + stage_2_dry_mass_kg + payload_mass_kg + stage_2_fuel_mass_kg,
-                    stage_1_fuel_mass_kg,
-                    engines,
-                    4, TIME_STEP};
-
-        std::vector<liftoff::vector> &forces = body.get_forces();
-        const std::vector<liftoff::vector> &d_mot{body.get_d_mot()};
-
-        // Telemetry
-        const liftoff::vector &p{d_mot[0]};
-        const liftoff::vector &v{d_mot[1]};
-        const liftoff::vector &a{d_mot[2]};
-        const liftoff::vector &j{d_mot[3]};
-
-        // Initial state
-        liftoff::vector w{0, -ACCEL_G * body.get_mass(), 0};
-        liftoff::vector n{0, ACCEL_G * body.get_mass(), 0};
-        forces.push_back(w);
-        forces.push_back(n);
-        forces.resize(4);
-
-        plot_data.Create(1, 4, 2);
-        long double sim_duration_ticks = to_ticks(400);
-        for (int i = 0; i < sim_duration_ticks; ++i) {
-            double cur_time_s = i * TIME_STEP;
-
-            // Computation
-            body.pre_compute();
-
-            // Normal force computation
-            liftoff::vector new_n;
-            if (p.get_y() < 0) {
-                for (int k = 0; k < forces.size(); ++k) {
-                    if (k == 1) {
-                        continue;
-                    }
-
-                    liftoff::vector &force = forces[k];
-                    if (force.get_y() < 0) {
-                        new_n.add({0, -force.get_y(), 0});
-                    }
-                }
-
-                // Hitting the ground
-                if (v.get_y() < 0) {
-                    body.set_velocity({});
-                }
-            }
-            forces[1] = new_n;
-
-            // Recompute weight vector
-            double cur_mass = body.get_mass();
-            liftoff::vector cur_weight = {0, -ACCEL_G * cur_mass, 0};
-            forces[0] = cur_weight;
-
-            // Recompute drag for new velocity
-            double v_mag = v.magnitude();
-            liftoff::vector cur_drag;
-            if (v_mag != 0) {
-                double drag = liftoff::calc_drag_earth(F9_CD, p.get_y(), v_mag, F9_A);
-                cur_drag = {-v.get_x() * drag / v_mag, -v.get_y() * drag / v_mag, 0};
-            }
-            forces[2] = cur_drag;
-
-            // Recompute thrust
-            std::vector<engine> &cur_engines{body.get_engines()};
-
-            // Propellant check
-            double prop_rem = body.get_prop_mass();
-            if (prop_rem <= 0) {
-                std::cout << cur_time_s << ": No propellant" << std::endl;
-                continue;
-            }
-
-            const velocity_flight_profile &profile = rtp.get_profile();
-            double vx = profile.get_vx(cur_time_s);
-            double vy = profile.get_vy(cur_time_s);
-
-            // Set engine throttle
-            double dvx;
-            double dvy;
-            double accel;
-            if (!std::isnan(vx) && !std::isnan(vy)) {
-                dvx = vx - v.get_x();
-                dvy = vy - v.get_y();
-
-                accel = std::sqrt(dvx * dvx + dvy * dvy);
-                double f = body.get_mass() * accel;
-                double f_pe = f / engines.size();
-
-                double throttle = f / (engines.size() * MERLIN_MAX_THRUST);
-                /* std::cout << cur_time_s << ", " << vx << ", " << v.get_x() << ", " << dvx << ", " << vy << ", "
-                          << v.get_y()
-                          << ", " << dvy << ", " << accel << ", " << body.get_mass() << ", " << f << ", " << throttle
-                          << std::endl; */
-
-                for (auto &e : cur_engines) {
-                    e.set_throttle(f_pe / e.get_max_thrust());
-                }
-            }
-
-            // Hardcoded MECO times
-            if (cur_time_s == 155) {
-                std::cout << "MECO: Remaining propellant = " << body.get_prop_mass() << " kg" << std::endl;
-
-                // Second stage separation
-                body.set_mass(body.get_mass() - stage_2_dry_mass_kg - stage_2_fuel_mass_kg - payload_mass_kg);
-            }
-
-            // Turn off engines after MECO
-            if (cur_time_s > 155) {
-                for (auto &e : cur_engines) {
-                    e.set_throttle(0);
-                }
-            }
-
-            // Compute the thrust vector and recompute the
-            // rocket mass with the new throttle
-            double thrust_net = 0;
-            for (const auto &e : cur_engines) {
-                thrust_net += e.get_thrust();
-
-                double rate = e.get_prop_flow_rate();
-                double mass_flow = rate / ACCEL_G;
-                double total_prop_mass = mass_flow * TIME_STEP;
-                body.drain_propellant(total_prop_mass);
-            }
-
-            liftoff::vector cur_thrust{0, thrust_net, 0};
-            if (!std::isnan(vx) && !std::isnan(vy)) {
-                double uax = dvx / accel;
-                double uay = dvy / accel;
-
-                cur_thrust.set({uax * thrust_net, uay * thrust_net, 0});
-            }
-            forces[3] = cur_thrust;
-
-            body.compute_forces();
-            body.compute_motion();
-            body.post_compute();
-
-            // Record to the data matrix
-            if (i != 0) {
-                plot_data.Insert('x', i);
-            }
-
-            plot_data.Put(p.get_x(), i, 0, 0);
-            plot_data.Put(p.get_y(), i, 0, 1);
-
-            plot_data.Put(cur_time_s, i, 1, 0);
-            plot_data.Put(v.magnitude(), i, 1, 1);
-
-            plot_data.Put(cur_time_s, i, 2, 0);
-            plot_data.Put(a.magnitude(), i, 2, 1);
+    if (!options.live.empty()) {
+        return run_live_mode(options);
+    }
 
-            plot_data.Put(cur_time_s, i, 3, 0);
-            plot_data.Put(j.magnitude(), i, 3, 1);
+    // Flight profile setup
+    telemetry_flight_profile raw{TIME_STEP};
+    telemetry_flight_profile fitted{TIME_STEP};
+    if (!setup_flight_profile(raw, fitted, options.data, flight_setup_params{}, &pool)) {
+        return 1;
+    }
+    condition_flight_profile(fitted, REPLAY_DURATION);
 
-            // Check for pauses
-            Check();
+    if (!options.tune.empty()) {
+        return run_tuning_mode(options, raw, fitted, pool);
+    }
 
-            // Update the window with data
-            Fl::awake(update_wnd, wnd_inst);
+    if (options.dispersion.runs != 0) {
+        return run_dispersion_mode(options, fitted, pool);
+    }
 
-            /* std::cout << cur_time_s << ", " << v.magnitude() << ", " << p.get_y() << ", " << pidf.compute_error()
-                      << ", "
-                      << p.get_x() << ", " << v.get_x() << ", " << v.get_y() << ", " << a.get_x() << ", " << a.get_y()
-                      << ", " << a.magnitude() << ", " << j.get_x() << ", " << j.get_y() << ", " << j.magnitude()
-                      << ", "
-                      << pidf.get_setpoint() << ", " << pidf.get_last_state() << ", " << raw.get_altitude(cur_time_s)
-                      << ", " << raw.get_altitude(cur_time_s) - p.get_y() << std::endl; */
-        }
+#ifdef LIFTOFF_CLI_GUI
+    if (!options.headless) {
+        return run_windowed(fitted);
     }
-};
+#else
+    if (!options.headless) {
+        std::cout << "Built without MathGL/FLTK, running headless" << std::endl;
+    }
+#endif
+
+    return run_headless(options, fitted);
+}
 
 /**
  * Runs two flight simulations: firstly, the flight replay,
@@ -873,24 +662,23 @@ public:
  *
  * @return 0 if successful
  */
-int main() {
+int main(int argc, char **argv) {
     std::cout << std::setprecision(16);
 
-    velocity_flight_profile result{TIME_STEP};
+    cli_options options;
+    if (!parse_args(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
 
-    // Run the telemetry profile simulation and record the
-    // results to the given flight profile
-    run_telemetry_profile rtp{result};
-    mglFLTK mgl_run_telem{&rtp, "SpaceX JCSAT-18/KACIFIC1 Flight Replay"};
-    rtp.set_window(&mgl_run_telem);
-    rtp.Run();
+    // Shared by the leg fits, the dispersion runs and the
+    // missions of a batch
+    liftoff::thread_pool pool{options.threads};
+    int status = run_mode(options, pool);
 
-    // Attempt to simulate with the parsed flight profile
-    // data with the test model
-    run_test_rocket rtr{rtp};
-    mglFLTK mgl_run_test{&rtr, "SpaceX JCSAT-18/KACIFIC1 Flight Sim"};
-    rtr.set_window(&mgl_run_test);
-    rtr.Run();
+    if (!options.trace.empty()) {
+        write_trace(options);
+    }
 
-    return mgl_fltk_run();
+    return status;
 }
@@ -0,0 +1,201 @@
+#include "mission_manifest.h"
+
+#include <cmath>
+#include <fstream>
+
+#include "json_scan.h"
+
+// Most engines a mission may cluster, which also keeps the cast of the parsed count
+// to int defined
+static const int MAX_ENGINES = 1000;
+
+// Parses the JSON string whose opening quote is at p, returns the position after the
+// closing quote or nullptr if it is unterminated
+static const char *parse_string(const char *p, const char *end, std::string &out) {
+    out.clear();
+    for (++p; p < end; ++p) {
+        char c = *p;
+        if (c == '"') {
+            return p + 1;
+        }
+
+        if (c == '\\') {
+            if (++p == end) {
+                return nullptr;
+            }
+
+            switch (*p) {
+                case 'n':
+                    c = '\n';
+                    break;
+                case 't':
+                    c = '\t';
+                    break;
+                case 'r':
+                    c = '\r';
+                    break;
+                default:
+                    c = *p;
+                    break;
+            }
+        }
+
+        out.push_back(c);
+    }
+
+    return nullptr;
+}
+
+// Parses the JSON number at p, returns the position after it or nullptr if there is
+// no finite number at p
+static const char *parse_number(const char *p, const char *end, double &out) {
+    p = json_parse_number(p, end, out);
+    return p != nullptr && std::isfinite(out) ? p : nullptr;
+}
+
+// Obtains the numeric field of the mission with the given key, or nullptr if there is
+// no such field
+static double *number_field(mission &m, const std::string &key) {
+    vehicle_params &v = m.vehicle;
+    if (key == "range") {
+        return &m.setup.range;
+    } else if (key == "event_search_time") {
+        return &m.setup.event_search_time;
+    } else if (key == "cd") {
+        return &v.cd;
+    } else if (key == "area") {
+        return &v.area;
+    } else if (key == "thrust") {
+        return &v.max_thrust;
+    } else if (key == "isp") {
+        return &v.isp;
+    } else if (key == "s1_dry") {
+        return &v.stage_1_dry_mass;
+    } else if (key == "s1_fuel") {
+        return &v.stage_1_fuel_mass;
+    } else if (key == "s2_dry") {
+        return &v.stage_2_dry_mass;
+    } else if (key == "s2_fuel") {
+        return &v.stage_2_fuel_mass;
+    } else if (key == "payload") {
+        return &v.payload_mass;
+    } else if (key == "meco") {
+        return &v.meco_time;
+    }
+
+    return nullptr;
+}
+
+bool parse_mission_line(const char *begin, const char *end, mission &out, std::string &error) {
+    mission m;
+
+    const char *p = json_skip_space(begin, end);
+    if (p == end || *p != '{') {
+        error = "expected a JSON object";
+        return false;
+    }
+
+    std::string key;
+    std::string text;
+    ++p;
+    while (true) {
+        p = json_skip_space(p, end);
+        if (p < end && *p == '}') {
+            break;
+        }
+
+        if (p == end || *p != '"' || (p = parse_string(p, end, key)) == nullptr) {
+            error = "expected a key";
+            return false;
+        }
+
+        p = json_skip_space(p, end);
+        if (p == end || *p != ':') {
+            error = "expected ':' after '" + key + "'";
+            return false;
+        }
+        p = json_skip_space(p + 1, end);
+
+        if (key == "name" || key == "data" || key == "output") {
+            if (p == end || *p != '"' || (p = parse_string(p, end, text)) == nullptr) {
+                error = "expected a string for '" + key + "'";
+                return false;
+            }
+
+            (key == "name" ? m.name : key == "data" ? m.data : m.output) = text;
+        } else if (key == "engines") {
+            double engines;
+            if ((p = parse_number(p, end, engines)) == nullptr || engines < 1 || engines > MAX_ENGINES ||
+                engines != std::floor(engines)) {
+                error = "expected an integer from 1 to " + std::to_string(MAX_ENGINES) + " for 'engines'";
+                return false;
+            }
+
+            m.vehicle.engine_count = static_cast<int>(engines);
+        } else {
+            double *field = number_field(m, key);
+            if (field == nullptr) {
+                error = "unknown key '" + key + "'";
+                return false;
+            }
+
+            if ((p = parse_number(p, end, *field)) == nullptr) {
+                error = "expected a number for '" + key + "'";
+                return false;
+            }
+        }
+
+        p = json_skip_space(p, end);
+        if (p < end && *p == ',') {
+            ++p;
+        } else if (p == end || *p != '}') {
+            error = "expected ',' or '}'";
+            return false;
+        }
+    }
+
+    if (json_skip_space(p + 1, end) != end) {
+        error = "unexpected characters after the object";
+        return false;
+    }
+
+    if (m.data.empty()) {
+        error = "missing 'data'";
+        return false;
+    }
+
+    if (m.name.empty()) {
+        m.name = m.data;
+    }
+
+    out = std::move(m);
+    return true;
+}
+
+bool load_mission_manifest(const std::string &path, std::vector<mission> &missions,
+                           std::vector<std::string> &errors) {
+    std::ifstream in{path};
+    if (!in) {
+        return false;
+    }
+
+    std::string line;
+    for (size_t line_no = 1; std::getline(in, line); ++line_no) {
+        const char *begin = line.data();
+        const char *end = begin + line.size();
+        const char *first = json_skip_space(begin, end);
+        if (first == end || *first == '#') {
+            continue;
+        }
+
+        mission m;
+        std::string error;
+        if (parse_mission_line(begin, end, m, error)) {
+            missions.push_back(std::move(m));
+        } else {
+            errors.push_back(path + ":" + std::to_string(line_no) + ": " + error);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_MISSION_MANIFEST_H
+#define LIFTOFF_CLI_MISSION_MANIFEST_H
+
+#include <string>
+#include <vector>
+
+#include "flight_setup.h"
+#include "vehicle_params.h"
+
+/**
+ * @brief A single mission to process in a batch.
+ */
+struct mission {
+    /**
+     * The name identifying the mission in the results.
+     */
+    std::string name;
+    /**
+     * The path to the telemetry data file.
+     */
+    std::string data;
+    /**
+     * The path prefix of the files written for this mission,
+     * or empty to write none.
+     */
+    std::string output;
+    /**
+     * The parameters of the flight profile setup.
+     */
+    flight_setup_params setup;
+    /**
+     * The parameters of the rocket model.
+     */
+    vehicle_params vehicle;
+};
+
+/**
+ * Parses a single line of a mission manifest, which is a
+ * flat JSON object. The "data" key is required, every
+ * other key defaults to the JCSAT-18/KACIFIC1 mission:
+ *
+ *   - name, output: strings
+ *   - range, event_search_time: the flight profile setup
+ *   - cd, area, engines, thrust, isp, s1_dry, s1_fuel,
+ *     s2_dry, s2_fuel, payload, meco: the rocket model
+ *
+ * @param begin the first character of the line
+ * @param end one past the last character of the line
+ * @param out the mission to write the values to
+ * @param error the reason the line was rejected
+ * @return true if the line describes a mission
+ */
+bool parse_mission_line(const char *begin, const char *end, mission &out, std::string &error);
+
+/**
+ * Reads the mission manifest at the given path, which has
+ * one mission per line as described by
+ * parse_mission_line(). Empty lines and lines starting
+ * with '#' are skipped.
+ *
+ * Malformed lines are reported and skipped so that the
+ * rest of the batch can still run.
+ *
+ * @param path the path to the manifest
+ * @param missions the missions to append to
+ * @param errors the messages for each rejected line to
+ * append to
+ * @return false if the manifest could not be opened
+ */
+bool load_mission_manifest(const std::string &path, std::vector<mission> &missions,
+                           std::vector<std::string> &errors);
+
+#endif // LIFTOFF_CLI_MISSION_MANIFEST_H
@@ -0,0 +1,284 @@
+#include "mission_scheduler.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include <sys/stat.h>
+
+#include <liftoff-physics/trace.h>
+
+#include "rocket_sim.h"
+#include "telemetry_flight_profile.h"
+#include "telemetry_replay.h"
+#include "telemetry_sink.h"
+#include "velocity_flight_profile.h"
+#include "velocity_source.h"
+
+// Peak memory used per byte of telemetry data, which is parsed into the raw profile,
+// interpolated into the fitted profile and cached, measured on the demo data
+static const size_t MEMORY_PER_DATA_BYTE = 4;
+// Memory used by a mission regardless of its telemetry, for the replay and
+// simulation profiles and the fits
+static const size_t MISSION_BASE_MEMORY = 1 << 20;
+
+/**
+ * @brief Limits the estimated memory of the missions
+ * running at once.
+ */
+class memory_budget {
+private:
+    /**
+     * The memory that may be in use at once, or 0 for no
+     * limit.
+     */
+    size_t limit;
+    /**
+     * The memory of the missions currently running.
+     */
+    size_t used{0};
+    /**
+     * Guards the memory in use.
+     */
+    std::mutex mutex;
+    /**
+     * Signalled whenever memory is released.
+     */
+    std::condition_variable released;
+
+public:
+    /**
+     * Creates a budget with the given limit.
+     *
+     * @param mb_limit the memory that may be in use at
+     * once, or 0 for no limit
+     */
+    explicit memory_budget(size_t mb_limit) : limit(mb_limit) {
+    }
+
+    /**
+     * Waits until the given amount of memory fits into the
+     * budget, or until nothing else is running if it is
+     * larger than the whole budget, and reserves it.
+     *
+     * @param bytes the memory to reserve
+     */
+    void acquire(size_t bytes) {
+        std::unique_lock<std::mutex> lock{mutex};
+        released.wait(lock, [&] {
+            return limit == 0 || used == 0 || used + bytes <= limit;
+        });
+        used += bytes;
+    }
+
+    /**
+     * Releases memory previously reserved with acquire().
+     *
+     * @param bytes the memory to release
+     */
+    void release(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            used -= bytes;
+        }
+
+        released.notify_all();
+    }
+};
+
+/**
+ * @brief Releases a reservation of a memory budget once it
+ * goes out of scope.
+ */
+class budget_reservation {
+private:
+    /**
+     * The budget reserved from.
+     */
+    memory_budget &budget;
+    /**
+     * The memory reserved.
+     */
+    size_t bytes;
+
+public:
+    /**
+     * Takes over memory already reserved from the budget
+     * with memory_budget::acquire().
+     *
+     * @param br_budget the budget reserved from
+     * @param br_bytes the memory reserved
+     */
+    budget_reservation(memory_budget &br_budget, size_t br_bytes) : budget(br_budget), bytes(br_bytes) {
+    }
+
+    budget_reservation(const budget_reservation &) = delete;
+
+    budget_reservation &operator=(const budget_reservation &) = delete;
+
+    ~budget_reservation() {
+        budget.release(bytes);
+    }
+};
+
+size_t estimate_mission_memory(const mission &m) {
+    struct stat st{};
+    if (stat(m.data.c_str(), &st) != 0) {
+        return MISSION_BASE_MEMORY;
+    }
+
+    return MISSION_BASE_MEMORY + MEMORY_PER_DATA_BYTE * static_cast<size_t>(st.st_size);
+}
+
+/**
+ * Creates the sink for the given stage of the mission.
+ *
+ * @param m the mission
+ * @param config the configuration of the batch
+ * @param stage the name of the stage, used as the file
+ * name suffix
+ * @param result the result to record the error in
+ * @return the sink, or nullptr if its file cannot be
+ * opened
+ */
+static std::unique_ptr<telemetry_sink> make_mission_sink(const mission &m, const scheduler_config &config,
+                                                         const std::string &stage, mission_result &result) {
+    if (m.output.empty()) {
+        return std::unique_ptr<telemetry_sink>{new null_sink};
+    }
+
+    std::string path = m.output + "-" + stage;
+    std::unique_ptr<telemetry_sink> sink = make_telemetry_sink(config.sink, path);
+    if (!sink) {
+        result.error = "cannot write to '" + path + "'";
+    }
+
+    return sink;
+}
+
+/**
+ * Runs every stage of a single mission.
+ *
+ * @param m the mission
+ * @param config the configuration of the batch
+ * @param pool the pool to fit the legs of the flight on
+ * @param result the result to write
+ */
+static void run_mission(const mission &m, const scheduler_config &config, liftoff::thread_pool &pool,
+                        mission_result &result) {
+    LIFTOFF_TRACE_CONTEXT(m.name);
+
+    telemetry_flight_profile raw{config.time_step};
+    telemetry_flight_profile fitted{config.time_step};
+    if (!setup_flight_profile(raw, fitted, m.data, m.setup, &pool)) {
+        result.error = "cannot process the telemetry in '" + m.data + "'";
+        return;
+    }
+    condition_flight_profile(fitted, config.replay_duration);
+
+    std::unique_ptr<telemetry_sink> replay_sink = make_mission_sink(m, config, "replay", result);
+    if (!replay_sink) {
+        return;
+    }
+
+    std::unique_ptr<telemetry_sink> sim_sink = make_mission_sink(m, config, "sim", result);
+    if (!sim_sink) {
+        return;
+    }
+
+    velocity_flight_profile profile{config.time_step};
+    telemetry_replay replay{fitted, profile, config.replay_duration};
+    replay.run(*replay_sink);
+
+    profile_velocity_source source{profile};
+    rocket_sim sim{source, m.vehicle, config.time_step, config.sim_duration};
+    sim.run(*sim_sink);
+
+    if (replay_sink->has_failed() || sim_sink->has_failed()) {
+        result.error = "cannot write to '" + m.output + "-" + (replay_sink->has_failed() ? "replay" : "sim") + "'";
+        return;
+    }
+
+    result.meco_propellant = sim.get_meco_propellant();
+    result.burnout_time = sim.get_burnout_time();
+    result.ok = true;
+}
+
+std::vector<mission_result> run_missions(const std::vector<mission> &missions, const scheduler_config &config,
+                                         liftoff::thread_pool &pool) {
+    std::vector<mission_result> results(missions.size());
+    memory_budget budget{config.memory_budget};
+
+    for (size_t i = 0; i < missions.size(); ++i) {
+        // Waits for the budget here rather than in the task,
+        // so that no worker is held up by the missions
+        // running on the others
+        size_t bytes = estimate_mission_memory(missions[i]);
+        budget.acquire(bytes);
+
+        pool.submit([&, i, bytes] {
+            budget_reservation reservation{budget, bytes};
+            const mission &m = missions[i];
+            mission_result &result = results[i];
+            result.name = m.name;
+
+            auto start = std::chrono::steady_clock::now();
+
+            // A mission that throws must not take the rest of
+            // the batch down with it
+            try {
+                run_mission(m, config, pool, result);
+            } catch (const std::exception &e) {
+                result.ok = false;
+                result.error = e.what();
+            } catch (...) {
+                result.ok = false;
+                result.error = "unknown error";
+            }
+
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        });
+    }
+
+    pool.wait();
+    return results;
+}
+
+/**
+ * Writes the given text as a quoted CSV field.
+ *
+ * @param file the file to write to
+ * @param text the field text
+ */
+static void write_csv_string(FILE *file, const std::string &text) {
+    std::fputc('"', file);
+    for (char c : text) {
+        if (c == '"') {
+            std::fputc('"', file);
+        }
+
+        std::fputc(c, file);
+    }
+    std::fputc('"', file);
+}
+
+bool write_mission_results_csv(const std::string &path, const std::vector<mission_result> &results) {
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::fputs("name,ok,meco_propellant,burnout_time,seconds,error\n", file);
+    for (const mission_result &result : results) {
+        write_csv_string(file, result.name);
+        std::fprintf(file, ",%d,%.17g,%.17g,%.6f,", result.ok ? 1 : 0,
+                     result.meco_propellant, result.burnout_time, result.seconds);
+        write_csv_string(file, result.error);
+        std::fputc('\n', file);
+    }
+
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_MISSION_SCHEDULER_H
+#define LIFTOFF_CLI_MISSION_SCHEDULER_H
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <liftoff-physics/thread_pool.h>
+
+#include "mission_manifest.h"
+
+/**
+ * @brief The configuration shared by every mission in a
+ * batch.
+ */
+struct scheduler_config {
+    /**
+     * The time step of the flight profiles, s.
+     */
+    double time_step{1};
+    /**
+     * The duration of the telemetry replay, s.
+     */
+    double replay_duration{500};
+    /**
+     * The duration of the rocket simulation, s.
+     */
+    double sim_duration{400};
+    /**
+     * The sink used for the missions with an output: csv,
+     * binary or null.
+     */
+    std::string sink{"csv"};
+    /**
+     * The estimated memory that the missions running at
+     * once may use, bytes, or 0 for no limit. A mission
+     * larger than the budget runs on its own.
+     */
+    size_t memory_budget{0};
+};
+
+/**
+ * @brief The outcome of a single mission in a batch.
+ */
+struct mission_result {
+    /**
+     * The name of the mission.
+     */
+    std::string name;
+    /**
+     * Whether every stage of the mission completed.
+     */
+    bool ok{false};
+    /**
+     * The reason the mission failed.
+     */
+    std::string error;
+    /**
+     * The propellant remaining at MECO, kg, or NAN if the
+     * simulation did not reach MECO.
+     */
+    double meco_propellant{NAN};
+    /**
+     * The time at which the first stage ran out of
+     * propellant, s, or NAN if it did not.
+     */
+    double burnout_time{NAN};
+    /**
+     * The wall clock time spent on the mission, s.
+     */
+    double seconds{0};
+};
+
+/**
+ * Estimates the peak memory that processing the mission
+ * uses, which is dominated by the parsed telemetry.
+ *
+ * @param m the mission
+ * @return the estimated memory, bytes
+ */
+size_t estimate_mission_memory(const mission &m);
+
+/**
+ * Runs the ingest, fitting, conditioning, telemetry
+ * replay and rocket simulation of every mission across the
+ * given thread pool.
+ *
+ * Missions are only submitted to the pool once their
+ * estimated memory fits into the budget next to the
+ * missions already running, so the calling thread waits
+ * for the budget rather than a worker, and this must not
+ * be called from a task of the pool. A
+ * mission that fails, whether its telemetry cannot be read
+ * or a stage throws, is reported in its result without
+ * affecting the others.
+ *
+ * @param missions the missions to run
+ * @param config the configuration of the batch
+ * @param pool the thread pool to run the missions on
+ * @return the result of each mission, in the same order
+ */
+std::vector<mission_result> run_missions(const std::vector<mission> &missions, const scheduler_config &config,
+                                         liftoff::thread_pool &pool);
+
+/**
+ * Writes the results of a batch to a CSV file with one row
+ * per mission.
+ *
+ * @param path the path of the CSV file
+ * @param results the mission results
+ * @return true if the file was written
+ */
+bool write_mission_results_csv(const std::string &path, const std::vector<mission_result> &results);
+
+#endif // LIFTOFF_CLI_MISSION_SCHEDULER_H
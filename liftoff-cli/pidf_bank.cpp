@@ -0,0 +1,185 @@
+#include "pidf_bank.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// The rows of the bank
+enum {
+    P_GAIN,
+    I_GAIN,
+    D_GAIN,
+    F_GAIN,
+    MIN_ACCUM,
+    MAX_ACCUM,
+    SMOOTHING,
+    SETPOINT,
+    LAST_STATE,
+    ACCUM_ERROR,
+    LAST_ERROR,
+    LAST_DER,
+    OUTPUT,
+    ROWS
+};
+
+pidf_bank::pidf_bank(size_t pb_count, double pb_time_step, double pb_p_gain, double pb_i_gain, double pb_d_gain,
+                     double pb_f_gain) :
+        count(pb_count), time_step(pb_time_step), rows(ROWS * pb_count, 0) {
+    std::fill(row(P_GAIN), row(P_GAIN) + count, pb_p_gain);
+    std::fill(row(I_GAIN), row(I_GAIN) + count, pb_i_gain);
+    std::fill(row(D_GAIN), row(D_GAIN) + count, pb_d_gain);
+    std::fill(row(F_GAIN), row(F_GAIN) + count, pb_f_gain);
+    std::fill(row(MIN_ACCUM), row(MIN_ACCUM) + count, -INFINITY);
+    std::fill(row(MAX_ACCUM), row(MAX_ACCUM) + count, INFINITY);
+}
+
+double *pidf_bank::row(int quantity) {
+    return rows.data() + quantity * count;
+}
+
+const double *pidf_bank::row(int quantity) const {
+    return rows.data() + quantity * count;
+}
+
+size_t pidf_bank::size() const {
+    return count;
+}
+
+double pidf_bank::get_time_step() const {
+    return time_step;
+}
+
+void pidf_bank::set_gains(size_t idx, double p_gain, double i_gain, double d_gain, double f_gain) {
+    row(P_GAIN)[idx] = p_gain;
+    row(I_GAIN)[idx] = i_gain;
+    row(D_GAIN)[idx] = d_gain;
+    row(F_GAIN)[idx] = f_gain;
+}
+
+void pidf_bank::set_windup_limits(size_t idx, double min_accum, double max_accum) {
+    row(MIN_ACCUM)[idx] = min_accum;
+    row(MAX_ACCUM)[idx] = max_accum;
+}
+
+void pidf_bank::set_derivative_filter(size_t idx, double smoothing) {
+    row(SMOOTHING)[idx] = smoothing;
+}
+
+void pidf_bank::set_setpoint(size_t idx, double setpoint) {
+    row(SETPOINT)[idx] = setpoint;
+}
+
+void pidf_bank::set_setpoints(const double *setpoints) {
+    std::copy(setpoints, setpoints + count, row(SETPOINT));
+}
+
+void pidf_bank::set_last_state(size_t idx, double state) {
+    row(LAST_STATE)[idx] = state;
+}
+
+void pidf_bank::set_last_states(const double *states) {
+    std::copy(states, states + count, row(LAST_STATE));
+}
+
+double pidf_bank::compute_error(size_t idx) const {
+    return row(SETPOINT)[idx] - row(LAST_STATE)[idx];
+}
+
+void pidf_bank::compute_pidf() {
+    const double *p_gain = row(P_GAIN);
+    const double *i_gain = row(I_GAIN);
+    const double *d_gain = row(D_GAIN);
+    const double *f_gain = row(F_GAIN);
+    const double *min_accum = row(MIN_ACCUM);
+    const double *max_accum = row(MAX_ACCUM);
+    const double *smoothing = row(SMOOTHING);
+    const double *setpoint = row(SETPOINT);
+    const double *last_state = row(LAST_STATE);
+    double *accum_error = row(ACCUM_ERROR);
+    double *last_error = row(LAST_ERROR);
+    double *last_der = row(LAST_DER);
+    double *output = row(OUTPUT);
+
+    // The kernels round each operation exactly as the
+    // scalar loop does, without fusing the multiplies and
+    // adds, and the clamp and the filter are no-ops with
+    // their defaults, so a loop is bit for bit equal to a
+    // pidf_controller
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128d dt = _mm_set1_pd(time_step);
+    for (; i + 2 <= count; i += 2) {
+        __m128d sp = _mm_loadu_pd(setpoint + i);
+        __m128d err = _mm_sub_pd(sp, _mm_loadu_pd(last_state + i));
+
+        // Operands ordered so that a NaN propagates as with
+        // std::min() and std::max()
+        __m128d accum = _mm_add_pd(_mm_loadu_pd(accum_error + i), _mm_mul_pd(err, dt));
+        accum = _mm_min_pd(_mm_loadu_pd(max_accum + i), _mm_max_pd(_mm_loadu_pd(min_accum + i), accum));
+        _mm_storeu_pd(accum_error + i, accum);
+
+        __m128d der = _mm_div_pd(_mm_sub_pd(err, _mm_loadu_pd(last_error + i)), dt);
+        der = _mm_add_pd(der, _mm_mul_pd(_mm_loadu_pd(smoothing + i), _mm_sub_pd(_mm_loadu_pd(last_der + i), der)));
+        _mm_storeu_pd(last_error + i, err);
+        _mm_storeu_pd(last_der + i, der);
+
+        __m128d p = _mm_mul_pd(_mm_loadu_pd(p_gain + i), err);
+        __m128d ig = _mm_mul_pd(_mm_loadu_pd(i_gain + i), accum);
+        __m128d d = _mm_mul_pd(_mm_loadu_pd(d_gain + i), der);
+        __m128d f = _mm_mul_pd(_mm_loadu_pd(f_gain + i), sp);
+        _mm_storeu_pd(output + i, _mm_add_pd(_mm_add_pd(_mm_add_pd(p, ig), d), f));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float64x2_t dt = vdupq_n_f64(time_step);
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t sp = vld1q_f64(setpoint + i);
+        float64x2_t err = vsubq_f64(sp, vld1q_f64(last_state + i));
+
+        float64x2_t accum = vaddq_f64(vld1q_f64(accum_error + i), vmulq_f64(err, dt));
+        accum = vminq_f64(vld1q_f64(max_accum + i), vmaxq_f64(vld1q_f64(min_accum + i), accum));
+        vst1q_f64(accum_error + i, accum);
+
+        float64x2_t der = vdivq_f64(vsubq_f64(err, vld1q_f64(last_error + i)), dt);
+        der = vaddq_f64(der, vmulq_f64(vld1q_f64(smoothing + i), vsubq_f64(vld1q_f64(last_der + i), der)));
+        vst1q_f64(last_error + i, err);
+        vst1q_f64(last_der + i, der);
+
+        float64x2_t p = vmulq_f64(vld1q_f64(p_gain + i), err);
+        float64x2_t ig = vmulq_f64(vld1q_f64(i_gain + i), accum);
+        float64x2_t d = vmulq_f64(vld1q_f64(d_gain + i), der);
+        float64x2_t f = vmulq_f64(vld1q_f64(f_gain + i), sp);
+        vst1q_f64(output + i, vaddq_f64(vaddq_f64(vaddq_f64(p, ig), d), f));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        double err = setpoint[i] - last_state[i];
+
+        double accum = accum_error[i] + err * time_step;
+        accum_error[i] = std::min(std::max(accum, min_accum[i]), max_accum[i]);
+
+        double der = (err - last_error[i]) / time_step;
+        der += smoothing[i] * (last_der[i] - der);
+        last_error[i] = err;
+        last_der[i] = der;
+
+        double p = p_gain[i] * err;
+        double ig = i_gain[i] * accum_error[i];
+        double d = d_gain[i] * der;
+        double f = f_gain[i] * setpoint[i];
+        output[i] = p + ig + d + f;
+    }
+}
+
+double pidf_bank::get_output(size_t idx) const {
+    return row(OUTPUT)[idx];
+}
+
+const double *pidf_bank::get_outputs() const {
+    return row(OUTPUT);
+}
@@ -0,0 +1,184 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_PIDF_BANK_H
+#define LIFTOFF_CLI_PIDF_BANK_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Represents a bank of PIDF controllers sharing a
+ * time step, for example the loops of every run of a
+ * dispersion or of every guidance axis.
+ *
+ * The gains and the state of the loops are stored as
+ * structure of arrays, one contiguous row per quantity,
+ * so a single pass of the kernel updates every loop. Each
+ * loop behaves like a pidf_controller, with an optional
+ * clamp on the error accumulator against integral windup
+ * and an optional low-pass filter on the derivative.
+ */
+class pidf_bank {
+private:
+    /**
+     * The number of loops in the bank.
+     */
+    size_t count;
+    /**
+     * The difference in time between measurements.
+     */
+    double time_step;
+
+    /**
+     * The rows of the bank, each of count elements, see
+     * the row indices in pidf_bank.cpp.
+     */
+    std::vector<double> rows;
+
+    /**
+     * Obtains the row of the given quantity.
+     *
+     * @param quantity the row index
+     * @return the pointer to the first loop's value
+     */
+    double *row(int quantity);
+
+    /**
+     * Obtains the row of the given quantity.
+     *
+     * @param quantity the row index
+     * @return the pointer to the first loop's value
+     */
+    const double *row(int quantity) const;
+
+public:
+    /**
+     * Creates a bank of controllers which share the given
+     * initial gains, with no windup clamp and no
+     * derivative filter.
+     *
+     * @param pb_count the number of loops
+     * @param pb_time_step the time step
+     * @param pb_p_gain the initial proportional gain
+     * @param pb_i_gain the initial integral gain
+     * @param pb_d_gain the initial derivative gain
+     * @param pb_f_gain the initial feed-forward gain
+     */
+    pidf_bank(size_t pb_count, double pb_time_step, double pb_p_gain = 0, double pb_i_gain = 0,
+              double pb_d_gain = 0, double pb_f_gain = 0);
+
+    /**
+     * Obtains the number of loops in this bank.
+     *
+     * @return the loop count
+     */
+    size_t size() const;
+
+    /**
+     * The time step between measurements.
+     *
+     * @return the time step
+     */
+    double get_time_step() const;
+
+    /**
+     * Changes the gains of the given loop for the next
+     * computation step.
+     *
+     * @param idx the loop index
+     * @param p_gain the proportional gain
+     * @param i_gain the integral gain
+     * @param d_gain the derivative gain
+     * @param f_gain the feed-forward gain
+     */
+    void set_gains(size_t idx, double p_gain, double i_gain, double d_gain, double f_gain);
+
+    /**
+     * Limits the error accumulator of the given loop to
+     * the given bounds, which stops the integral from
+     * winding up while the output saturates. Unbounded by
+     * default.
+     *
+     * @param idx the loop index
+     * @param min_accum the lowest accumulated error
+     * @param max_accum the highest accumulated error
+     */
+    void set_windup_limits(size_t idx, double min_accum, double max_accum);
+
+    /**
+     * Filters the derivative of the given loop, where each
+     * step keeps the given fraction of the previous
+     * filtered derivative. 0, the default, disables the
+     * filter.
+     *
+     * @param idx the loop index
+     * @param smoothing the filter factor, in [0, 1)
+     */
+    void set_derivative_filter(size_t idx, double smoothing);
+
+    /**
+     * Updates the setpoint of the given loop.
+     *
+     * @param idx the loop index
+     * @param setpoint the new setpoint value
+     */
+    void set_setpoint(size_t idx, double setpoint);
+
+    /**
+     * Updates the setpoints of every loop.
+     *
+     * @param setpoints the setpoint values, one per loop
+     */
+    void set_setpoints(const double *setpoints);
+
+    /**
+     * Updates the sensed state of the given loop.
+     *
+     * @param idx the loop index
+     * @param state the new state value
+     */
+    void set_last_state(size_t idx, double state);
+
+    /**
+     * Updates the sensed states of every loop.
+     *
+     * @param states the state values, one per loop
+     */
+    void set_last_states(const double *states);
+
+    /**
+     * Determines the current error of the given loop
+     * between its setpoint and last state.
+     *
+     * @param idx the loop index
+     * @return the current error value
+     */
+    double compute_error(size_t idx) const;
+
+    /**
+     * Computes the PIDF output of every loop from its
+     * current error, see pidf_controller::compute_pidf().
+     */
+    void compute_pidf();
+
+    /**
+     * Obtains the output of the given loop from the last
+     * call to compute_pidf().
+     *
+     * @param idx the loop index
+     * @return the PIDF output
+     */
+    double get_output(size_t idx) const;
+
+    /**
+     * Obtains the outputs of every loop from the last call
+     * to compute_pidf().
+     *
+     * @return the pointer to the first loop's output
+     */
+    const double *get_outputs() const;
+};
+
+#endif // LIFTOFF_CLI_PIDF_BANK_H
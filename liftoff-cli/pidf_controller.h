@@ -5,6 +5,28 @@
 #ifndef LANDING_PIDF_CONTROLLER_H
 #define LANDING_PIDF_CONTROLLER_H
 
+/**
+ * @brief The gains of a PIDF controller.
+ */
+struct pidf_gains {
+    /**
+     * Proportional gain.
+     */
+    double p{0};
+    /**
+     * Integral gain.
+     */
+    double i{0};
+    /**
+     * Derivative gain.
+     */
+    double d{0};
+    /**
+     * Feed-forward gain.
+     */
+    double f{0};
+};
+
 /**
  * @brief Represents the state held by a PIDF controller.
  */
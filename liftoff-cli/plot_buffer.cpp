@@ -0,0 +1,140 @@
+#include "plot_buffer.h"
+
+#include <algorithm>
+
+// Splits a frame into the point it adds to each series
+static void split(const telemetry_frame &frame, plot_buffer::point *points) {
+    points[0] = {frame.downrange, frame.altitude};
+    points[1] = {frame.time, frame.velocity};
+    points[2] = {frame.time, frame.acceleration};
+    points[3] = {frame.time, frame.jerk};
+}
+
+plot_buffer::plot_buffer(size_t max_points) :
+        capacity(std::max<size_t>(2, max_points / 2 / 2 * 2)) {
+    buckets.reserve(capacity);
+}
+
+void plot_buffer::clear() {
+    buckets.clear();
+    span = 1;
+    filled = 0;
+    count = 0;
+}
+
+void plot_buffer::compact() {
+    for (size_t i = 0; i < buckets.size() / 2; ++i) {
+        const bucket &first = buckets[2 * i];
+        const bucket &second = buckets[2 * i + 1];
+
+        bucket merged;
+        for (int s = 0; s < SERIES; ++s) {
+            const extremes &a = first.series[s];
+            const extremes &b = second.series[s];
+            extremes &m = merged.series[s];
+
+            // Ties keep the earlier frame
+            m = a;
+            if (b.min.y < a.min.y) {
+                m.min = b.min;
+                m.min_frame = b.min_frame;
+            }
+            if (b.max.y > a.max.y) {
+                m.max = b.max;
+                m.max_frame = b.max_frame;
+            }
+        }
+
+        buckets[i] = merged;
+    }
+
+    buckets.resize(buckets.size() / 2);
+    span *= 2;
+}
+
+void plot_buffer::record(const telemetry_frame &frame) {
+    point points[SERIES];
+    split(frame, points);
+
+    for (int s = 0; s < SERIES; ++s) {
+        const point &p = points[s];
+        range &r = ranges[s];
+        if (count == 0) {
+            r = {p.x, p.x, p.y, p.y};
+        } else {
+            r.x_min = std::min(r.x_min, p.x);
+            r.x_max = std::max(r.x_max, p.x);
+            r.y_min = std::min(r.y_min, p.y);
+            r.y_max = std::max(r.y_max, p.y);
+        }
+    }
+
+    if (buckets.empty() || filled == span) {
+        // The merged buckets are all full, so the frame
+        // always starts a new one
+        if (buckets.size() == capacity) {
+            compact();
+        }
+
+        bucket b;
+        for (int s = 0; s < SERIES; ++s) {
+            b.series[s] = {points[s], count, points[s], count};
+        }
+        buckets.push_back(b);
+        filled = 1;
+    } else {
+        bucket &b = buckets.back();
+        for (int s = 0; s < SERIES; ++s) {
+            extremes &e = b.series[s];
+            if (points[s].y < e.min.y) {
+                e.min = points[s];
+                e.min_frame = count;
+            }
+            if (points[s].y > e.max.y) {
+                e.max = points[s];
+                e.max_frame = count;
+            }
+        }
+        ++filled;
+    }
+
+    ++count;
+}
+
+size_t plot_buffer::get_count() const {
+    return count;
+}
+
+size_t plot_buffer::get_points() const {
+    if (buckets.empty()) {
+        return 0;
+    }
+
+    // One point for each single frame bucket, two for the
+    // rest
+    if (span == 1) {
+        return buckets.size();
+    }
+
+    return 2 * (buckets.size() - 1) + (filled == 1 ? 1 : 2);
+}
+
+const plot_buffer::range &plot_buffer::get_range(int series) const {
+    return ranges[series];
+}
+
+void plot_buffer::collect(int series, std::vector<point> &out) const {
+    out.clear();
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        const extremes &e = buckets[i].series[series];
+        if (span == 1 || (i == buckets.size() - 1 && filled == 1)) {
+            out.push_back(e.min);
+        } else if (e.min_frame <= e.max_frame) {
+            out.push_back(e.min);
+            out.push_back(e.max);
+        } else {
+            out.push_back(e.max);
+            out.push_back(e.min);
+        }
+    }
+}
@@ -0,0 +1,160 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_PLOT_BUFFER_H
+#define LIFTOFF_CLI_PLOT_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "telemetry_sink.h"
+
+/**
+ * @brief Reduces the frames recorded by a stage to a
+ * bounded level of detail for plotting.
+ *
+ * The frames are gathered into a preallocated number of
+ * buckets, each keeping the lowest and highest point of
+ * every series, so spikes survive the decimation. Once
+ * every bucket is full, neighbouring buckets are merged,
+ * doubling the frames each one covers. Recording a frame
+ * is amortized constant time, and the points produced
+ * never exceed the given maximum however long the stage
+ * runs.
+ */
+class plot_buffer {
+public:
+    /**
+     * The number of series: the altitude over the
+     * downrange distance, and the velocity, acceleration
+     * and jerk over time.
+     */
+    static const int SERIES = 4;
+
+    /**
+     * @brief A point of a series.
+     */
+    struct point {
+        double x;
+        double y;
+    };
+
+    /**
+     * @brief The extents of a series over every recorded
+     * frame.
+     */
+    struct range {
+        double x_min;
+        double x_max;
+        double y_min;
+        double y_max;
+    };
+
+private:
+    /**
+     * @brief The lowest and highest point of a series in a
+     * bucket, along with the frames they came from.
+     */
+    struct extremes {
+        point min;
+        size_t min_frame;
+        point max;
+        size_t max_frame;
+    };
+
+    /**
+     * @brief The extremes of every series over a run of
+     * frames.
+     */
+    struct bucket {
+        extremes series[SERIES];
+    };
+
+    /**
+     * The maximum number of buckets, which is even.
+     */
+    const size_t capacity;
+    /**
+     * The buckets in the order of their frames.
+     */
+    std::vector<bucket> buckets;
+    /**
+     * The number of frames each bucket covers.
+     */
+    size_t span{1};
+    /**
+     * The number of frames in the last bucket.
+     */
+    size_t filled{0};
+    /**
+     * The number of frames recorded.
+     */
+    size_t count{0};
+    /**
+     * The extents of each series.
+     */
+    range ranges[SERIES];
+
+    /**
+     * Merges each pair of neighbouring buckets together.
+     */
+    void compact();
+
+public:
+    /**
+     * Creates an empty buffer.
+     *
+     * @param max_points the maximum number of points
+     * produced for each series
+     */
+    explicit plot_buffer(size_t max_points);
+
+    /**
+     * Removes every recorded frame.
+     */
+    void clear();
+
+    /**
+     * Adds a frame to the buffer.
+     *
+     * @param frame the frame to add
+     */
+    void record(const telemetry_frame &frame);
+
+    /**
+     * Obtains the number of frames recorded.
+     *
+     * @return the frame count
+     */
+    size_t get_count() const;
+
+    /**
+     * Obtains the number of points produced for each
+     * series, which is the same for all of them.
+     *
+     * @return the point count
+     */
+    size_t get_points() const;
+
+    /**
+     * Obtains the extents of a series. Only meaningful
+     * once a frame has been recorded.
+     *
+     * @param series the series index
+     * @return the extents of the series
+     */
+    const range &get_range(int series) const;
+
+    /**
+     * Produces the points of a series in the order they
+     * were recorded. Every frame is kept until the buffer
+     * has to be decimated.
+     *
+     * @param series the series index
+     * @param out the vector to hold get_points() points
+     */
+    void collect(int series, std::vector<point> &out) const;
+};
+
+#endif // LIFTOFF_CLI_PLOT_BUFFER_H
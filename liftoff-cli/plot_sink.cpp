@@ -0,0 +1,145 @@
+#include "plot_sink.h"
+
+#include <FL/Fl.H>
+
+// The maximum number of points plotted on each graph
+static const size_t MAX_PLOT_POINTS = 2048;
+
+/**
+ * Helper function used to update the given MathGL window
+ * from another thread. This must be called using the
+ * Fl::update() function.
+ *
+ * @param data the pointer to the MathGL window
+ */
+static void update_wnd(void *data) {
+    auto *gr = static_cast<mglWnd *>(data);
+    gr->Update();
+}
+
+plot_sink::plot_sink(std::function<void(telemetry_sink &)> ps_stage, double frame_rate) :
+        stage(std::move(ps_stage)),
+        frame_interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(1 / frame_rate))),
+        frames(MAX_PLOT_POINTS) {
+    series_points.reserve(MAX_PLOT_POINTS);
+}
+
+void plot_sink::set_window(mglWnd *wnd) {
+    wnd_inst = wnd;
+}
+
+int plot_sink::Draw(mglGraph *gr) {
+    std::lock_guard<std::mutex> lock{plot_mutex};
+    const mglData &data = plot_data[front];
+    const plot_buffer::range *ranges = plot_ranges[front];
+
+    gr->Clf();
+
+    gr->SubPlot(2, 2, 0);
+    gr->Title("Position");
+    gr->Label('x', "Downrange Distance (m)");
+    gr->Label('y', "Altitude (m)");
+    gr->Grid();
+    gr->Box();
+    gr->SetRanges(ranges[0].x_min, ranges[0].x_max, ranges[0].y_min, ranges[0].y_max);
+    gr->Axis("xy");
+    gr->Plot(data.SubData(-1, 0, 0), data.SubData(-1, 0, 1));
+
+    gr->SubPlot(2, 2, 1);
+    gr->Title("Velocity");
+    gr->Label('x', "Time (s)");
+    gr->Label('y', "Y Velocity (m/s)");
+    gr->Grid();
+    gr->Box();
+    gr->SetRanges(ranges[1].x_min, ranges[1].x_max, ranges[1].y_min, ranges[1].y_max);
+    gr->Axis("xy");
+    gr->Plot(data.SubData(-1, 1, 0), data.SubData(-1, 1, 1));
+
+    gr->SubPlot(2, 2, 2);
+    gr->Title("Acceleration");
+    gr->Label('x', "Time (s)");
+    gr->Label('y', "Y Acceleration (m/s^2)");
+    gr->Grid();
+    gr->Box();
+    gr->SetRanges(ranges[2].x_min, ranges[2].x_max, ranges[2].y_min, ranges[2].y_max);
+    gr->Axis("xy");
+    gr->Plot(data.SubData(-1, 2, 0), data.SubData(-1, 2, 1));
+
+    gr->SubPlot(2, 2, 3);
+    gr->Title("Jerk");
+    gr->Label('x', "Time (s)");
+    gr->Label('y', "Y Jerk (m/s^3)");
+    gr->Grid();
+    gr->Box();
+    gr->SetRanges(ranges[3].x_min, ranges[3].x_max, ranges[3].y_min, ranges[3].y_max);
+    gr->Axis("xy");
+    gr->Plot(data.SubData(-1, 3, 0), data.SubData(-1, 3, 1));
+
+    return 0;
+}
+
+void plot_sink::Calc() {
+    stage(*this);
+}
+
+void plot_sink::begin(size_t) {
+    frames.clear();
+    last_flush = std::chrono::steady_clock::now();
+}
+
+void plot_sink::record(const telemetry_frame &frame) {
+    frames.record(frame);
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - last_flush >= frame_interval) {
+        last_flush = now;
+        flush(false);
+    }
+}
+
+void plot_sink::end() {
+    flush(true);
+}
+
+void plot_sink::flush(bool wait) {
+    if (frames.get_count() == 0) {
+        return;
+    }
+
+    // The FLTK thread only reads the front buffer, so the
+    // back one is filled without holding the lock
+    int back = 1 - front;
+    mglData &data = plot_data[back];
+    data.Create(frames.get_points(), 4, 2);
+    for (int s = 0; s < plot_buffer::SERIES; ++s) {
+        frames.collect(s, series_points);
+        for (size_t i = 0; i < series_points.size(); ++i) {
+            data.Put(series_points[i].x, i, s, 0);
+            data.Put(series_points[i].y, i, s, 1);
+        }
+
+        plot_ranges[back][s] = frames.get_range(s);
+    }
+
+    bool swapped = false;
+    {
+        std::unique_lock<std::mutex> lock{plot_mutex, std::defer_lock};
+        if (wait) {
+            lock.lock();
+        }
+
+        if (lock.owns_lock() || lock.try_lock()) {
+            front = back;
+            swapped = true;
+        }
+    }
+
+    // Check for pausing
+    Check();
+
+    // Update the window
+    if (swapped) {
+        Fl::awake(update_wnd, wnd_inst);
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_PLOT_SINK_H
+#define LIFTOFF_CLI_PLOT_SINK_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <mgl2/mgl.h>
+#include <mgl2/fltk.h>
+
+#include "plot_buffer.h"
+#include "telemetry_sink.h"
+
+/**
+ * @brief Plots the position, velocity, acceleration and
+ * jerk recorded by a simulation stage in a MathGL window.
+ *
+ * The stage runs on the MathGL calculation thread. Frames
+ * are reduced by a plot_buffer and the window is only
+ * updated at a fixed frame rate, so the cost of a redraw
+ * stays bounded however long the stage runs. The plot data
+ * is double buffered: the stage fills the back buffer and
+ * swaps it in only if the FLTK thread is not drawing at
+ * that moment, so the stage never waits on a redraw.
+ */
+class plot_sink : public mglDraw, public telemetry_sink {
+private:
+    /**
+     * The simulation stage to run, which records into the
+     * given sink.
+     */
+    std::function<void(telemetry_sink &)> stage;
+    /**
+     * The minimum time between two window updates.
+     */
+    std::chrono::steady_clock::duration frame_interval;
+    /**
+     * The time of the last window update.
+     */
+    std::chrono::steady_clock::time_point last_flush;
+
+    /**
+     * The level of detail of the recorded frames.
+     */
+    plot_buffer frames;
+    /**
+     * The points of a series, reused by each flush.
+     */
+    std::vector<plot_buffer::point> series_points;
+
+    /**
+     * Guards the index of the front buffer, which is drawn
+     * by the FLTK thread while the stage fills the back
+     * one.
+     */
+    std::mutex plot_mutex;
+    /**
+     * The front and back data used for plotting on the
+     * window.
+     */
+    mglData plot_data[2];
+    /**
+     * The axis ranges of each graph, for each buffer.
+     */
+    plot_buffer::range plot_ranges[2][plot_buffer::SERIES];
+    /**
+     * The index of the front buffer, only written by the
+     * stage.
+     */
+    int front{0};
+    /**
+     * The plot window to update with the data.
+     */
+    mglWnd *wnd_inst{nullptr};
+
+    /**
+     * Copies the recorded frames into the back buffer and
+     * swaps it in, scheduling a window update.
+     *
+     * @param wait true to wait for a redraw in progress,
+     * otherwise the swap is left to the next flush
+     */
+    void flush(bool wait);
+
+public:
+    /**
+     * Creates a plot for the given simulation stage.
+     *
+     * @param ps_stage the stage to run when the window
+     * starts calculating
+     * @param frame_rate the maximum number of window
+     * updates per second
+     */
+    explicit plot_sink(std::function<void(telemetry_sink &)> ps_stage, double frame_rate = 30);
+
+    /**
+     * Sets the window initialized by this MathGL drawing
+     * class.
+     *
+     * @param wnd the pointer to the window
+     */
+    void set_window(mglWnd *wnd);
+
+    int Draw(mglGraph *gr) override;
+
+    void Calc() override;
+
+    void begin(size_t expected_frames) override;
+
+    void record(const telemetry_frame &frame) override;
+
+    void end() override;
+};
+
+#endif // LIFTOFF_CLI_PLOT_SINK_H
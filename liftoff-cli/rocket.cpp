@@ -1,9 +1,9 @@
 #include "rocket.h"
 
-rocket::rocket(double rocket_dry_mass, double rocket_prop_mass, std::vector<engine> rocket_engines, int fdb_derivatives,
-               double fdb_time_step) :
+rocket::rocket(double rocket_dry_mass, double rocket_prop_mass, const engine_cluster &rocket_engines,
+               int fdb_derivatives, double fdb_time_step) :
         liftoff::force_driven_body(rocket_dry_mass, fdb_derivatives, fdb_time_step), prop_mass(rocket_prop_mass),
-        engines(std::move(rocket_engines)) {
+        engines(rocket_engines) {
 }
 
 double rocket::get_mass() const {
@@ -16,12 +16,19 @@ double rocket::get_prop_mass() const {
 
 void rocket::drain_propellant(double drain_mass) {
     prop_mass -= drain_mass;
+    if (prop_mass <= 0) {
+        staging.deplete();
+    }
 }
 
 void rocket::set_prop_mass(double new_prop_mass) {
     prop_mass = new_prop_mass;
 }
 
-std::vector<engine> &rocket::get_engines() {
+engine_cluster &rocket::get_engines() {
     return engines;
 }
+
+staging_scheduler &rocket::get_staging() {
+    return staging;
+}
@@ -5,11 +5,10 @@
 #ifndef LIFTOFF_CLI_ROCKET_H
 #define LIFTOFF_CLI_ROCKET_H
 
-#include <vector>
-
 #include <liftoff-physics/force_driven_body.h>
 
-#include "engine.h"
+#include "engine_cluster.h"
+#include "staging_scheduler.h"
 
 /**
  * @brief Represents a rocket, which is a force-drive body
@@ -22,9 +21,13 @@ private:
      */
     double prop_mass;
     /**
-     * The collection of engines present on the rocket.
+     * The cluster of engines present on the rocket.
+     */
+    engine_cluster engines;
+    /**
+     * The staging events of the rocket.
      */
-    std::vector<engine> engines;
+    staging_scheduler staging;
 
 public:
     /**
@@ -39,7 +42,7 @@ public:
      * @param fdb_time_step the time step used by the
      * force-driven body
      */
-    rocket(double rocket_dry_mass, double rocket_prop_mass, std::vector<engine> rocket_engines,
+    rocket(double rocket_dry_mass, double rocket_prop_mass, const engine_cluster &rocket_engines,
            int fdb_derivatives = 4, double fdb_time_step = 1);
 
     /**
@@ -67,19 +70,26 @@ public:
 
     /**
      * Subtracts the given amount of propellant mass from
-     * the rocket.
+     * the rocket, firing the depletion triggers of the
+     * staging scheduler once none is left.
      *
      * @param drain_mass the amount of mass to drain
      */
     void drain_propellant(double drain_mass);
 
     /**
-     * Obtains the collection of engines used by this
-     * rocket.
+     * Obtains the cluster of engines used by this rocket.
+     *
+     * @return the engine cluster
+     */
+    engine_cluster &get_engines();
+
+    /**
+     * Obtains the staging events of this rocket.
      *
-     * @return the collection of engines
+     * @return the staging scheduler
      */
-    std::vector<engine> &get_engines();
+    staging_scheduler &get_staging();
 };
 
 
@@ -0,0 +1,184 @@
+#include "rocket_sim.h"
+
+#include <cmath>
+
+#include <liftoff-physics/drag.h>
+#include <liftoff-physics/trace.h>
+
+#include "falcon_9.h"
+
+rocket_sim::rocket_sim(velocity_source &rs_profile, const vehicle_params &rs_params,
+                       double rs_time_step, double duration) :
+        profile(rs_profile), params(rs_params), time_step(rs_time_step),
+        total_steps(static_cast<int>(duration / rs_time_step)),
+        body(rs_params.stage_1_burn_dry_mass(), rs_params.stage_1_fuel_mass,
+             engine_cluster{engine{rs_params.max_thrust, rs_params.isp}, rs_params.engine_count},
+             4, rs_time_step) {
+    std::vector<liftoff::vector> &forces = body.get_forces();
+
+    // Initial state
+    liftoff::vector w{0, -ACCEL_G * body.get_mass(), 0};
+    liftoff::vector n{0, ACCEL_G * body.get_mass(), 0};
+    forces.push_back(w);
+    forces.push_back(n);
+    forces.resize(4);
+
+    staging_scheduler &staging = body.get_staging();
+
+    // MECO and second stage separation
+    staging.schedule(params.meco_time, [this]() {
+        meco_propellant = body.get_prop_mass();
+        body.set_mass(body.get_mass() - params.stage_2_dry_mass - params.stage_2_fuel_mass - params.payload_mass);
+    });
+
+    // The engines burn through the tick at MECO and are shut
+    // down from the next one
+    staging.schedule(std::nextafter(params.meco_time, INFINITY), [this]() {
+        engines_lit = false;
+        body.get_engines().set_throttle(0);
+    });
+
+    // Nothing is left to simulate once the propellant runs
+    // out, which is noticed at the start of the next tick
+    staging.on_depletion([this]() {
+        if (tick < total_steps) {
+            burnout_time = tick * time_step;
+            tick = total_steps;
+        }
+    });
+
+    if (body.get_prop_mass() <= 0) {
+        staging.deplete();
+    }
+}
+
+int rocket_sim::get_total_steps() const {
+    return total_steps;
+}
+
+double rocket_sim::get_meco_propellant() const {
+    return meco_propellant;
+}
+
+double rocket_sim::get_burnout_time() const {
+    return burnout_time;
+}
+
+bool rocket_sim::step(telemetry_sink &sink) {
+    if (tick >= total_steps) {
+        return false;
+    }
+
+    std::vector<liftoff::vector> &forces = body.get_forces();
+    const std::vector<liftoff::vector> &d_mot{body.get_d_mot()};
+
+    // Telemetry
+    const liftoff::vector &p{d_mot[0]};
+    const liftoff::vector &v{d_mot[1]};
+    const liftoff::vector &a{d_mot[2]};
+    const liftoff::vector &j{d_mot[3]};
+
+    double cur_time_s = tick * time_step;
+    ++tick;
+
+    // Computation
+    body.pre_compute();
+
+    // Normal force computation
+    liftoff::vector new_n;
+    if (p.get_y() < 0) {
+        for (size_t k = 0; k < forces.size(); ++k) {
+            if (k == 1) {
+                continue;
+            }
+
+            liftoff::vector &force = forces[k];
+            if (force.get_y() < 0) {
+                new_n.add({0, -force.get_y(), 0});
+            }
+        }
+
+        // Hitting the ground
+        if (v.get_y() < 0) {
+            body.set_velocity({});
+        }
+    }
+    forces[1] = new_n;
+
+    // Recompute weight vector
+    double cur_mass = body.get_mass();
+    liftoff::vector cur_weight = {0, -ACCEL_G * cur_mass, 0};
+    forces[0] = cur_weight;
+
+    // Recompute drag for new velocity
+    double v_mag = v.magnitude();
+    liftoff::vector cur_drag;
+    if (v_mag != 0) {
+        double drag = liftoff::calc_drag_earth(params.cd, p.get_y(), v_mag, params.area,
+                                               liftoff::atmosphere_table::standard());
+        cur_drag = {-v.get_x() * drag / v_mag, -v.get_y() * drag / v_mag, 0};
+    }
+    forces[2] = cur_drag;
+
+    // Recompute thrust
+    engine_cluster &cur_engines{body.get_engines()};
+
+    double vx;
+    double vy;
+    profile.get_velocity(cur_time_s, vx, vy);
+
+    // Set engine throttle
+    double dvx;
+    double dvy;
+    double accel;
+    if (!std::isnan(vx) && !std::isnan(vy)) {
+        dvx = vx - v.get_x();
+        dvy = vy - v.get_y();
+
+        accel = std::sqrt(dvx * dvx + dvy * dvy);
+        double f = body.get_mass() * accel;
+        double f_pe = f / cur_engines.get_count();
+
+        if (engines_lit) {
+            cur_engines.set_throttle(f_pe / cur_engines.get_engine().get_max_thrust());
+        }
+    }
+
+    // Staging events which are due
+    body.get_staging().advance(cur_time_s);
+
+    // Compute the thrust vector and recompute the
+    // rocket mass with the new throttle
+    double thrust_net = cur_engines.get_thrust();
+
+    double rate = cur_engines.get_prop_flow_rate();
+    double mass_flow = rate / ACCEL_G;
+    double total_prop_mass = mass_flow * time_step;
+    body.drain_propellant(total_prop_mass);
+
+    liftoff::vector cur_thrust{0, thrust_net, 0};
+    if (!std::isnan(vx) && !std::isnan(vy)) {
+        double uax = dvx / accel;
+        double uay = dvy / accel;
+
+        cur_thrust.set({uax * thrust_net, uay * thrust_net, 0});
+    }
+    forces[3] = cur_thrust;
+
+    body.compute_forces();
+    body.compute_motion();
+    body.post_compute();
+
+    sink.record({cur_time_s, p.get_x(), p.get_y(), v.magnitude(), a.magnitude(), j.magnitude()});
+
+    return true;
+}
+
+void rocket_sim::run(telemetry_sink &sink) {
+    LIFTOFF_TRACE_SCOPE("sim");
+
+    sink.begin(total_steps - tick);
+    while (step(sink)) {
+    }
+    sink.end();
+}
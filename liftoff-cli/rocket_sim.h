@@ -0,0 +1,129 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_ROCKET_SIM_H
+#define LIFTOFF_CLI_ROCKET_SIM_H
+
+#include <cmath>
+
+#include "rocket.h"
+#include "telemetry_sink.h"
+#include "vehicle_params.h"
+#include "velocity_source.h"
+
+/**
+ * @brief Simulates a rocket model which attempts to
+ * follow the velocity profile extracted from the telemetry
+ * replay using parameters that match the original rocket.
+ */
+class rocket_sim {
+private:
+    /**
+     * The source of the velocity profile the rocket
+     * follows.
+     */
+    velocity_source &profile;
+    /**
+     * The parameters of the simulated rocket.
+     */
+    const vehicle_params params;
+
+    /**
+     * The time step of each tick.
+     */
+    const double time_step;
+    /**
+     * The number of ticks to simulate.
+     */
+    const int total_steps;
+    /**
+     * The next tick to simulate.
+     */
+    int tick{0};
+
+    /**
+     * The simulated rocket.
+     */
+    rocket body;
+
+    /**
+     * The propellant remaining in the first stage at MECO,
+     * or NAN if MECO has not happened yet.
+     */
+    double meco_propellant{NAN};
+    /**
+     * The time at which the first stage ran out of
+     * propellant, or NAN if it has not.
+     */
+    double burnout_time{NAN};
+    /**
+     * Whether the engines are still following the
+     * velocity profile, until they are shut down.
+     */
+    bool engines_lit{true};
+
+public:
+    /**
+     * Creates a simulation of a rocket with the given
+     * parameters following the velocity profile from the
+     * given source.
+     *
+     * @param rs_profile the source of the velocity profile
+     * to follow
+     * @param rs_params the parameters of the rocket
+     * @param rs_time_step the time step of each tick
+     * @param duration the duration of the simulation
+     */
+    rocket_sim(velocity_source &rs_profile, const vehicle_params &rs_params,
+               double rs_time_step, double duration);
+
+    // The staging callbacks refer to this instance
+    rocket_sim(const rocket_sim &) = delete;
+
+    rocket_sim &operator=(const rocket_sim &) = delete;
+
+    /**
+     * Obtains the number of ticks in this simulation.
+     *
+     * @return the total tick count
+     */
+    int get_total_steps() const;
+
+    /**
+     * Obtains the propellant remaining in the first stage
+     * when the main engines were cut off.
+     *
+     * @return the remaining propellant, kg, or NAN if MECO
+     * has not been simulated yet
+     */
+    double get_meco_propellant() const;
+
+    /**
+     * Obtains the time at which the first stage ran out of
+     * propellant. No frames are produced after this.
+     *
+     * @return the burnout time, s, or NAN if there is
+     * still propellant
+     */
+    double get_burnout_time() const;
+
+    /**
+     * Simulates the next tick, recording the resulting
+     * frame to the given sink. The simulation finishes
+     * early once the propellant has run out.
+     *
+     * @param sink the sink to record the frame
+     * @return false if the simulation had already finished
+     */
+    bool step(telemetry_sink &sink);
+
+    /**
+     * Simulates every remaining tick.
+     *
+     * @param sink the sink to record the frames
+     */
+    void run(telemetry_sink &sink);
+};
+
+#endif // LIFTOFF_CLI_ROCKET_SIM_H
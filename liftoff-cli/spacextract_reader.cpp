@@ -0,0 +1,184 @@
+#include "spacextract_reader.h"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "json_scan.h"
+
+static bool key_equals(const char *key, size_t key_len, const char *expected, size_t expected_len) {
+    return key_len == expected_len && std::memcmp(key, expected, key_len) == 0;
+}
+
+bool parse_spacextract_line(const char *begin, const char *end, telemetry_sample &sample) {
+    const int HAS_TIME = 1;
+    const int HAS_VELOCITY = 2;
+    const int HAS_ALTITUDE = 4;
+    const int HAS_ALL = HAS_TIME | HAS_VELOCITY | HAS_ALTITUDE;
+
+    const char *p = json_skip_space(begin, end);
+    if (p == end || *p != '{') {
+        return false;
+    }
+
+    int found = 0;
+    ++p;
+    while (true) {
+        p = json_skip_space(p, end);
+        if (p == end) {
+            return false;
+        }
+
+        if (*p == '}') {
+            break;
+        }
+
+        if (*p != '"') {
+            return false;
+        }
+
+        const char *key = p + 1;
+        const char *key_end = static_cast<const char *>(std::memchr(key, '"', end - key));
+        if (key_end == nullptr) {
+            return false;
+        }
+        size_t key_len = key_end - key;
+
+        p = json_skip_space(key_end + 1, end);
+        if (p == end || *p != ':') {
+            return false;
+        }
+        p = json_skip_space(p + 1, end);
+
+        double *target = nullptr;
+        int flag = 0;
+        if (key_equals(key, key_len, "time", 4)) {
+            target = &sample.time;
+            flag = HAS_TIME;
+        } else if (key_equals(key, key_len, "velocity", 8)) {
+            target = &sample.velocity;
+            flag = HAS_VELOCITY;
+        } else if (key_equals(key, key_len, "altitude", 8)) {
+            target = &sample.altitude;
+            flag = HAS_ALTITUDE;
+        }
+
+        if (target != nullptr) {
+            p = json_parse_number(p, end, *target);
+            if (p == nullptr) {
+                return false;
+            }
+
+            found |= flag;
+        } else {
+            p = json_skip_value(p, end);
+            if (p == nullptr) {
+                return false;
+            }
+        }
+
+        p = json_skip_space(p, end);
+        if (p == end) {
+            return false;
+        }
+
+        if (*p == ',') {
+            ++p;
+        } else if (*p != '}') {
+            return false;
+        }
+    }
+
+    return found == HAS_ALL;
+}
+
+spacextract_reader::spacextract_reader(const std::string &path) {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        fd = -1;
+        return;
+    }
+
+    size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        return;
+    }
+
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close(fd);
+        fd = -1;
+        size = 0;
+        return;
+    }
+
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(mapped);
+    cursor = data;
+}
+
+spacextract_reader::~spacextract_reader() {
+    if (data != nullptr) {
+        munmap(const_cast<char *>(data), size);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool spacextract_reader::is_open() const {
+    return fd >= 0;
+}
+
+size_t spacextract_reader::count_lines() const {
+    size_t lines = 0;
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end) {
+        const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        ++lines;
+        if (nl == nullptr) {
+            break;
+        }
+
+        p = nl + 1;
+    }
+
+    return lines;
+}
+
+bool spacextract_reader::next(telemetry_sample &sample) {
+    const char *end = data + size;
+    while (cursor != nullptr && cursor < end) {
+        const char *line = cursor;
+        const char *nl = static_cast<const char *>(std::memchr(line, '\n', end - line));
+        const char *line_end = nl == nullptr ? end : nl;
+        cursor = nl == nullptr ? end : nl + 1;
+
+        if (json_skip_space(line, line_end) == line_end) {
+            continue;
+        }
+
+        if (parse_spacextract_line(line, line_end, sample)) {
+            return true;
+        }
+
+        ++skipped;
+    }
+
+    return false;
+}
+
+size_t spacextract_reader::get_skipped() const {
+    return skipped;
+}
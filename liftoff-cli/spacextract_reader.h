@@ -0,0 +1,122 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_SPACEXTRACT_READER_H
+#define LIFTOFF_CLI_SPACEXTRACT_READER_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief A single telemetry sample recorded by
+ * SpaceXtract.
+ */
+struct telemetry_sample {
+    /**
+     * The time since liftoff, s.
+     */
+    double time;
+    /**
+     * The velocity magnitude, m/s.
+     */
+    double velocity;
+    /**
+     * The altitude, km.
+     */
+    double altitude;
+};
+
+/**
+ * Parses a single line of SpaceXtract output, which is a
+ * flat JSON object containing the time, velocity and
+ * altitude keys. Other keys are skipped.
+ *
+ * @param begin the first character of the line
+ * @param end one past the last character of the line
+ * @param sample the sample to write the values to
+ * @return true if all three values were present
+ */
+bool parse_spacextract_line(const char *begin, const char *end, telemetry_sample &sample);
+
+/**
+ * @brief Reads the samples from a SpaceXtract NDJSON file
+ * by memory mapping it and scanning each line in place,
+ * without building a DOM or allocating per line.
+ */
+class spacextract_reader {
+private:
+    /**
+     * The mapped file descriptor, or -1 if the file could
+     * not be opened.
+     */
+    int fd{-1};
+    /**
+     * The mapped file contents.
+     */
+    const char *data{nullptr};
+    /**
+     * The size of the mapped file contents.
+     */
+    size_t size{0};
+    /**
+     * The start of the next line to read.
+     */
+    const char *cursor{nullptr};
+    /**
+     * The number of non-empty lines that could not be
+     * parsed.
+     */
+    size_t skipped{0};
+
+public:
+    /**
+     * Opens and maps the SpaceXtract file at the given
+     * path.
+     *
+     * @param path the path to the telemetry data file
+     */
+    explicit spacextract_reader(const std::string &path);
+
+    spacextract_reader(const spacextract_reader &) = delete;
+
+    spacextract_reader &operator=(const spacextract_reader &) = delete;
+
+    ~spacextract_reader();
+
+    /**
+     * Determines whether the file was successfully
+     * opened.
+     *
+     * @return true if the file can be read
+     */
+    bool is_open() const;
+
+    /**
+     * Counts the number of lines in the file, which is an
+     * upper bound for the number of samples.
+     *
+     * @return the line count
+     */
+    size_t count_lines() const;
+
+    /**
+     * Reads the next sample in the file, skipping empty
+     * and malformed lines.
+     *
+     * @param sample the sample to write the values to
+     * @return true if a sample was read, false at the end
+     * of the file
+     */
+    bool next(telemetry_sample &sample);
+
+    /**
+     * Obtains the number of non-empty lines that have been
+     * skipped because they could not be parsed.
+     *
+     * @return the number of malformed lines
+     */
+    size_t get_skipped() const;
+};
+
+#endif // LIFTOFF_CLI_SPACEXTRACT_READER_H
@@ -0,0 +1,40 @@
+#include "staging_scheduler.h"
+
+#include <algorithm>
+
+void staging_scheduler::schedule(double time, event_fn fn) {
+    // Placed after the fired events so that an event which
+    // is already due still fires
+    auto it = std::upper_bound(timeline.begin() + next, timeline.end(), time,
+                               [](double t, const event &e) { return t < e.time; });
+    timeline.insert(it, {time, std::move(fn)});
+}
+
+void staging_scheduler::on_depletion(event_fn fn) {
+    depletion.push_back(std::move(fn));
+}
+
+void staging_scheduler::advance(double time) {
+    while (next < timeline.size() && timeline[next].time <= time) {
+        // Moved out first, the callback may schedule events
+        // and so reallocate the timeline
+        event_fn fn = std::move(timeline[next].fn);
+        ++next;
+        fn();
+    }
+}
+
+void staging_scheduler::deplete() {
+    if (depleted) {
+        return;
+    }
+
+    depleted = true;
+    for (const auto &fn : depletion) {
+        fn();
+    }
+}
+
+bool staging_scheduler::is_depleted() const {
+    return depleted;
+}
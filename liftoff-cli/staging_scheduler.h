@@ -0,0 +1,107 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_STAGING_SCHEDULER_H
+#define LIFTOFF_CLI_STAGING_SCHEDULER_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief A timeline of the staging events of a rocket,
+ * such as MECO, stage separation and engine shutdowns,
+ * along with the triggers fired once the propellant runs
+ * out.
+ *
+ * Each event is fired exactly once, so the simulation
+ * only pays for the staging at the event times rather than
+ * checking every event on each tick. Any number of events
+ * may be scheduled, which covers multiple stages and
+ * boosters.
+ */
+class staging_scheduler {
+public:
+    /**
+     * The callback of an event.
+     */
+    typedef std::function<void()> event_fn;
+
+private:
+    /**
+     * @brief An event on the timeline.
+     */
+    struct event {
+        /**
+         * The time of the event, s.
+         */
+        double time;
+        /**
+         * The callback fired at the event time.
+         */
+        event_fn fn;
+    };
+
+    /**
+     * The events ordered by time, where events at the same
+     * time are kept in the order they were scheduled.
+     */
+    std::vector<event> timeline;
+    /**
+     * The index of the first event which has not been
+     * fired yet.
+     */
+    size_t next{0};
+
+    /**
+     * The callbacks fired once the propellant runs out.
+     */
+    std::vector<event_fn> depletion;
+    /**
+     * Whether the propellant already ran out.
+     */
+    bool depleted{false};
+
+public:
+    /**
+     * Schedules an event. An event scheduled before the
+     * time reached by advance() fires on the next call.
+     *
+     * @param time the time of the event, s
+     * @param fn the callback to fire
+     */
+    void schedule(double time, event_fn fn);
+
+    /**
+     * Adds a callback to fire once the propellant runs
+     * out.
+     *
+     * @param fn the callback to fire
+     */
+    void on_depletion(event_fn fn);
+
+    /**
+     * Fires the events which are due by the given time, in
+     * time order. The callbacks may schedule further
+     * events.
+     *
+     * @param time the current time, s
+     */
+    void advance(double time);
+
+    /**
+     * Fires the depletion callbacks unless they have been
+     * fired already.
+     */
+    void deplete();
+
+    /**
+     * Determines whether the propellant ran out.
+     *
+     * @return true if deplete() has been called
+     */
+    bool is_depleted() const;
+};
+
+#endif // LIFTOFF_CLI_STAGING_SCHEDULER_H
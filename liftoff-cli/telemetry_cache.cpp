@@ -0,0 +1,281 @@
+#include "telemetry_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Identifies a liftoff telemetry cache file
+static const char CACHE_MAGIC[8] = {'L', 'F', 'T', 'C', 'A', 'C', 'H', 'E'};
+// Incremented whenever the layout or the processing of the cached data changes
+static const uint32_t CACHE_VERSION = 5;
+// Written in native byte order, reads back differently on a foreign machine
+static const uint32_t CACHE_BYTE_ORDER = 0x01020304;
+
+// The channels stored in the cache, in table order
+enum cache_channel : uint64_t {
+    RAW_VELOCITY,
+    RAW_ALTITUDE,
+    FITTED_VELOCITY,
+    FITTED_ALTITUDE,
+    CHANNEL_COUNT
+};
+
+struct cache_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t source_size;
+    int64_t source_mtime;
+    int64_t source_mtime_nsec;
+    double event_search_time;
+    uint64_t channel_count;
+    uint64_t event_count;
+    uint64_t poly_count;
+    uint64_t file_size;
+};
+
+struct cache_channel_entry {
+    uint64_t id;
+    uint64_t samples;
+    uint64_t times_offset;
+    uint64_t values_offset;
+};
+
+struct cache_poly_entry {
+    uint64_t terms;
+    uint64_t offset;
+};
+
+// Keeps the cache file mapped for as long as any series views it
+struct cache_mapping {
+    void *data;
+    size_t size;
+
+    cache_mapping(void *cm_data, size_t cm_size) : data(cm_data), size(cm_size) {
+    }
+
+    cache_mapping(const cache_mapping &) = delete;
+
+    cache_mapping &operator=(const cache_mapping &) = delete;
+
+    ~cache_mapping() {
+        munmap(data, size);
+    }
+};
+
+// Obtains the size and modification time of the source, the nanoseconds tell apart
+// rewrites within the same second
+static bool stat_source(const std::string &source_path, uint64_t &size, int64_t &mtime, int64_t &mtime_nsec) {
+    struct stat st{};
+    if (stat(source_path.c_str(), &st) != 0) {
+        return false;
+    }
+
+    size = static_cast<uint64_t>(st.st_size);
+    mtime = static_cast<int64_t>(st.st_mtim.tv_sec);
+    mtime_nsec = static_cast<int64_t>(st.st_mtim.tv_nsec);
+    return true;
+}
+
+static uint64_t doubles_size(uint64_t count) {
+    return count * sizeof(double);
+}
+
+static bool write_doubles(FILE *file, const double *data, size_t count) {
+    return std::fwrite(data, sizeof(double), count, file) == count;
+}
+
+bool write_telemetry_cache(const std::string &cache_path, const std::string &source_path,
+                           const telemetry_flight_profile &raw, const telemetry_flight_profile &fitted,
+                           const flight_profile_fit &fit) {
+    const liftoff::time_series *channels[CHANNEL_COUNT] = {
+            &raw.get_velocities(), &raw.get_altitudes(),
+            &fitted.get_velocities(), &fitted.get_altitudes()
+    };
+
+    cache_header header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.byte_order = CACHE_BYTE_ORDER;
+    if (!stat_source(source_path, header.source_size, header.source_mtime, header.source_mtime_nsec)) {
+        return false;
+    }
+    header.event_search_time = fit.event_search_time;
+    header.channel_count = CHANNEL_COUNT;
+    header.event_count = fit.events.size();
+    header.poly_count = fit.legs.size();
+
+    // Lay out the sections one after another, all of them are
+    // multiples of 8 bytes so every offset stays aligned
+    uint64_t offset = sizeof(cache_header) +
+                      CHANNEL_COUNT * sizeof(cache_channel_entry) +
+                      header.poly_count * sizeof(cache_poly_entry) +
+                      doubles_size(header.event_count);
+
+    std::vector<std::vector<double>> poly_coefficients;
+    std::vector<cache_poly_entry> poly_table;
+    for (const liftoff::polynomial &poly : fit.legs) {
+        std::vector<double> coefficients;
+        for (const mpf_class &coefficient : poly.get_coefficients()) {
+            coefficients.push_back(coefficient.get_d());
+        }
+
+        poly_table.push_back({coefficients.size(), offset});
+        offset += doubles_size(coefficients.size());
+        poly_coefficients.push_back(std::move(coefficients));
+    }
+
+    cache_channel_entry channel_table[CHANNEL_COUNT];
+    for (uint64_t i = 0; i < CHANNEL_COUNT; ++i) {
+        uint64_t samples = channels[i]->size();
+        channel_table[i] = {i, samples, offset, offset + doubles_size(samples)};
+        offset += 2 * doubles_size(samples);
+    }
+    header.file_size = offset;
+
+    // Unique to this writer so that missions sharing a data
+    // file never write to the same temporary file
+    std::string tmp_path = cache_path + ".tmp" + std::to_string(getpid()) + "-" +
+                           std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    FILE *file = std::fopen(tmp_path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(channel_table, sizeof(cache_channel_entry), CHANNEL_COUNT, file) == CHANNEL_COUNT &&
+              std::fwrite(poly_table.data(), sizeof(cache_poly_entry), poly_table.size(), file) == poly_table.size() &&
+              write_doubles(file, fit.events.data(), fit.events.size());
+    for (size_t i = 0; ok && i < poly_coefficients.size(); ++i) {
+        ok = write_doubles(file, poly_coefficients[i].data(), poly_coefficients[i].size());
+    }
+    for (size_t i = 0; ok && i < CHANNEL_COUNT; ++i) {
+        ok = write_doubles(file, channels[i]->time_data(), channels[i]->size()) &&
+             write_doubles(file, channels[i]->value_data(), channels[i]->size());
+    }
+
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+// Determines whether the section of count elements of the given size at the given
+// offset is aligned and lies within the file without overflowing
+static bool in_bounds(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t file_size) {
+    return offset % sizeof(double) == 0 && offset <= file_size &&
+           count <= (file_size - offset) / element_size;
+}
+
+bool load_telemetry_cache(const std::string &cache_path, const std::string &source_path,
+                          double event_search_time, telemetry_flight_profile &raw, telemetry_flight_profile &fitted,
+                          flight_profile_fit &fit) {
+    uint64_t source_size;
+    int64_t source_mtime;
+    int64_t source_mtime_nsec;
+    if (!stat_source(source_path, source_size, source_mtime, source_mtime_nsec)) {
+        return false;
+    }
+
+    int fd = open(cache_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(cache_header)) {
+        close(fd);
+        return false;
+    }
+
+    auto size = static_cast<size_t>(st.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    std::shared_ptr<const cache_mapping> mapping = std::make_shared<cache_mapping>(mapped, size);
+    const auto *base = static_cast<const char *>(mapped);
+
+    // The mapping is page aligned, which is enough for every
+    // section
+    const auto *header = reinterpret_cast<const cache_header *>(base);
+    if (std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header->version != CACHE_VERSION ||
+        header->byte_order != CACHE_BYTE_ORDER ||
+        header->source_size != source_size ||
+        header->source_mtime != source_mtime ||
+        header->source_mtime_nsec != source_mtime_nsec ||
+        header->event_search_time != event_search_time ||
+        header->file_size != size ||
+        header->channel_count != CHANNEL_COUNT) {
+        return false;
+    }
+
+    uint64_t table_offset = sizeof(cache_header);
+    if (!in_bounds(table_offset, CHANNEL_COUNT, sizeof(cache_channel_entry), size)) {
+        return false;
+    }
+    const auto *channel_table = reinterpret_cast<const cache_channel_entry *>(base + table_offset);
+
+    uint64_t poly_offset = table_offset + CHANNEL_COUNT * sizeof(cache_channel_entry);
+    if (!in_bounds(poly_offset, header->poly_count, sizeof(cache_poly_entry), size)) {
+        return false;
+    }
+    const auto *poly_table = reinterpret_cast<const cache_poly_entry *>(base + poly_offset);
+
+    uint64_t events_offset = poly_offset + header->poly_count * sizeof(cache_poly_entry);
+    if (!in_bounds(events_offset, header->event_count, sizeof(double), size)) {
+        return false;
+    }
+    const auto *events = reinterpret_cast<const double *>(base + events_offset);
+
+    std::vector<liftoff::polynomial> legs;
+    for (uint64_t i = 0; i < header->poly_count; ++i) {
+        const cache_poly_entry &entry = poly_table[i];
+        if (!in_bounds(entry.offset, entry.terms, sizeof(double), size)) {
+            return false;
+        }
+
+        const auto *coefficients = reinterpret_cast<const double *>(base + entry.offset);
+        legs.emplace_back(std::vector<double>(coefficients, coefficients + entry.terms));
+    }
+
+    liftoff::time_series channels[CHANNEL_COUNT];
+    for (uint64_t i = 0; i < CHANNEL_COUNT; ++i) {
+        const cache_channel_entry &entry = channel_table[i];
+        if (entry.id != i ||
+            !in_bounds(entry.times_offset, entry.samples, sizeof(double), size) ||
+            !in_bounds(entry.values_offset, entry.samples, sizeof(double), size)) {
+            return false;
+        }
+
+        channels[i] = liftoff::time_series::view(reinterpret_cast<const double *>(base + entry.times_offset),
+                                                 reinterpret_cast<const double *>(base + entry.values_offset),
+                                                 entry.samples, mapping);
+    }
+
+    // Only replace the output once the whole cache has been validated
+    raw.get_velocities() = channels[RAW_VELOCITY];
+    raw.get_altitudes() = channels[RAW_ALTITUDE];
+    fitted.get_velocities() = channels[FITTED_VELOCITY];
+    fitted.get_altitudes() = channels[FITTED_ALTITUDE];
+    fit.events.assign(events, events + header->event_count);
+    fit.event_search_time = event_search_time;
+    fit.legs = std::move(legs);
+
+    return true;
+}
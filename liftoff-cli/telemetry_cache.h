@@ -0,0 +1,92 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_TELEMETRY_CACHE_H
+#define LIFTOFF_CLI_TELEMETRY_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include <liftoff-physics/polynomial.h>
+
+#include "telemetry_flight_profile.h"
+
+/**
+ * @brief The results of processing a flight profile which
+ * are stored in the cache alongside the telemetry.
+ */
+struct flight_profile_fit {
+    /**
+     * The time at which each leg after the first begins,
+     * i.e. MECO, SES-1 and SECO-1.
+     */
+    std::vector<double> events;
+    /**
+     * The time from which the events were searched for.
+     */
+    double event_search_time{0};
+    /**
+     * The polynomial fitted to the altitude of each leg.
+     */
+    std::vector<liftoff::polynomial> legs;
+};
+
+/**
+ * Writes the raw and processed telemetry to a binary cache
+ * file so that later runs can skip parsing and fitting.
+ *
+ * The file consists of a header identifying the format
+ * version, byte order, the size and modification time,
+ * to the nanosecond, of the source data file and the
+ * event search time,
+ * followed by a table of
+ * channels, the event times, the polynomial coefficients
+ * and finally each channel as a column of float64 times
+ * and a column of float64 values. Every section is 8-byte
+ * aligned so that it can be used in place once mapped.
+ *
+ * The cache is written to a temporary file which then
+ * replaces the cache path so that a partially written
+ * cache is never read.
+ *
+ * @param cache_path the path of the cache file to write
+ * @param source_path the path of the telemetry data file
+ * the cache was generated from
+ * @param raw the raw telemetry data
+ * @param fitted the processed telemetry data
+ * @param fit the events and leg fits
+ * @return true if the cache was written
+ */
+bool write_telemetry_cache(const std::string &cache_path, const std::string &source_path,
+                           const telemetry_flight_profile &raw, const telemetry_flight_profile &fitted,
+                           const flight_profile_fit &fit);
+
+/**
+ * Loads telemetry previously written by
+ * write_telemetry_cache() by memory mapping the cache
+ * file. The channels of the profiles become read-only
+ * views over the mapping which are only copied if they
+ * are modified.
+ *
+ * The cache is rejected if it was written by a different
+ * version or byte order, if the source data file has
+ * changed since, if its events were searched for from a
+ * different time or if it is truncated or malformed.
+ *
+ * @param cache_path the path of the cache file to read
+ * @param source_path the path of the telemetry data file
+ * the cache should have been generated from
+ * @param event_search_time the time from which the events
+ * should have been searched for
+ * @param raw the raw telemetry data to load
+ * @param fitted the processed telemetry data to load
+ * @param fit the events and leg fits to load
+ * @return true if the cache was valid and loaded, false
+ * to indicate that the profile must be reprocessed
+ */
+bool load_telemetry_cache(const std::string &cache_path, const std::string &source_path,
+                          double event_search_time, telemetry_flight_profile &raw, telemetry_flight_profile &fitted,
+                          flight_profile_fit &fit);
+
+#endif // LIFTOFF_CLI_TELEMETRY_CACHE_H
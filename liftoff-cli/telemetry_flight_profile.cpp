@@ -1,6 +1,9 @@
-#include <cmath>
 #include "telemetry_flight_profile.h"
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 telemetry_flight_profile::telemetry_flight_profile(double tfp_time_step) : time_step(tfp_time_step) {
 }
 
@@ -12,65 +15,137 @@ double telemetry_flight_profile::get_current_time() const {
     return current_time;
 }
 
-void telemetry_flight_profile::set_range(double range) {
-    range = range;
+void telemetry_flight_profile::set_range(double new_range) {
+    range = new_range;
 }
 
 double telemetry_flight_profile::get_downrange_distance() const {
     return range * time_step;
 }
 
+void telemetry_flight_profile::reserve(size_t samples) {
+    velocity.reserve(samples);
+    altitude.reserve(samples);
+}
+
 void telemetry_flight_profile::put_velocity(double time, double next_velocity) {
-    velocity[time] = next_velocity;
+    velocity.put(time, next_velocity);
 }
 
 void telemetry_flight_profile::put_altitude(double time, double next_altitude) {
-    altitude[time] = next_altitude;
+    altitude.put(time, next_altitude);
+    altitude_ticks.clear();
+}
+
+void telemetry_flight_profile::set_altitude_fit(const liftoff::piecewise_polynomial &fit) {
+    altitude_fit = fit;
+    altitude_ticks.clear();
+
+    // Only the samples outside of every segment are still
+    // looked up
+    std::vector<double> times;
+    std::vector<double> values;
+    for (size_t i = 0; i < altitude.size(); ++i) {
+        double t = altitude.time_at(i);
+        if (fit.find(t) == liftoff::piecewise_polynomial::npos) {
+            times.push_back(t);
+            values.push_back(altitude.value_at(i));
+        }
+    }
+
+    altitude.assign(times.data(), values.data(), times.size());
 }
 
-void telemetry_flight_profile::step() {
-    current_time += time_step;
+void telemetry_flight_profile::set_altitude_conditioning(std::vector<double> integral, double offset) {
+    altitude_integral = std::move(integral);
+    altitude_offset = offset;
+    altitude_ticks.clear();
 }
 
-double telemetry_flight_profile::get_telemetry_value(double time, const std::map<double, double> &map) const {
-    auto it = map.lower_bound(time);
-    if (it == map.end()) {
-        return NAN;
+void telemetry_flight_profile::cache_altitude_ticks(size_t ticks) {
+    std::vector<double> cache(ticks);
+    for (size_t i = 0; i < ticks; ++i) {
+        cache[i] = compute_altitude(i * time_step);
     }
 
-    double dt = std::abs(it->first - time);
-    double val = it->second;
-    if (it != map.begin()) {
-        auto check_it = --it;
-        if (std::abs(check_it->first - time) < dt) {
-            return check_it->second;
-        }
-    }
+    altitude_ticks = std::move(cache);
+}
 
-    return val;
+void telemetry_flight_profile::step() {
+    current_time += time_step;
 }
 
 double telemetry_flight_profile::get_velocity() const {
-    return get_telemetry_value(current_time, velocity);
+    return velocity.nearest_value(current_time);
 }
 
 double telemetry_flight_profile::get_altitude() const {
-    return get_telemetry_value(current_time, altitude);
+    return get_altitude(current_time);
 }
 
 double telemetry_flight_profile::get_velocity(double time) const {
-    return get_telemetry_value(time, velocity);
+    return velocity.nearest_value(time);
 }
 
 double telemetry_flight_profile::get_altitude(double time) const {
-    return get_telemetry_value(time, altitude);
+    double tick = std::round(time / time_step);
+    if (tick >= 0 && tick < altitude_ticks.size() && tick * time_step == time) {
+        return altitude_ticks[static_cast<size_t>(tick)];
+    }
+
+    return compute_altitude(time);
 }
 
-std::map<double, double> &telemetry_flight_profile::get_velocities() {
+double telemetry_flight_profile::get_sample_altitude(double time) const {
+    if (altitude_fit.empty()) {
+        return altitude.nearest_value(time);
+    }
+
+    size_t idx = velocity.nearest(time);
+    if (idx == liftoff::time_series::npos) {
+        return NAN;
+    }
+
+    // Evaluated at the time of the sample rather than the
+    // given one, as if the fit had been written into it
+    double sample_time = velocity.time_at(idx);
+    size_t segment = altitude_fit.find(sample_time);
+    if (segment == liftoff::piecewise_polynomial::npos) {
+        return altitude.nearest_value(sample_time);
+    }
+
+    return altitude_fit.val(segment, sample_time);
+}
+
+double telemetry_flight_profile::compute_altitude(double time) const {
+    if (altitude_integral.empty()) {
+        return get_sample_altitude(time);
+    }
+
+    // The integral is only known at the ticks, so the one
+    // nearest to the time before the break-even is used
+    if (time < altitude_integral.size() * time_step) {
+        double tick = std::round(time / time_step);
+        size_t idx = tick < 0 ? 0 : std::min(static_cast<size_t>(tick), altitude_integral.size() - 1);
+        return altitude_integral[idx];
+    }
+
+    return get_sample_altitude(time) - altitude_offset;
+}
+
+liftoff::time_series &telemetry_flight_profile::get_velocities() {
     return velocity;
 }
 
-std::map<double, double> &telemetry_flight_profile::get_altitudes() {
+const liftoff::time_series &telemetry_flight_profile::get_velocities() const {
+    return velocity;
+}
+
+liftoff::time_series &telemetry_flight_profile::get_altitudes() {
+    return altitude;
+}
+
+const liftoff::time_series &telemetry_flight_profile::get_altitudes() const {
     return altitude;
 }
 
@@ -5,7 +5,10 @@
 #ifndef LIFTOFF_CLI_TELEMETRY_FLIGHT_PROFILE_H
 #define LIFTOFF_CLI_TELEMETRY_FLIGHT_PROFILE_H
 
-#include <map>
+#include <vector>
+
+#include <liftoff-physics/piecewise_polynomial.h>
+#include <liftoff-physics/time_series.h>
 
 /**
  * @brief A flight profile consisting of the mapping of
@@ -28,24 +31,55 @@ private:
     double range{0};
 
     /**
-     * The mapping of time to velocity magnitude.
+     * The series of velocity magnitudes over time.
+     */
+    liftoff::time_series velocity;
+    /**
+     * The series of altitudes over time, without the
+     * samples covered by the altitude fit.
      */
-    std::map<double, double> velocity;
+    liftoff::time_series altitude;
     /**
-     * The mapping of time to altitude.
+     * The fit replacing the altitude samples within its
+     * segments.
      */
-    std::map<double, double> altitude;
+    liftoff::piecewise_polynomial altitude_fit;
+    /**
+     * The velocity integral at each tick before the
+     * conditioning break-even, which replaces the altitude
+     * up to there, or empty if it is not conditioned.
+     */
+    std::vector<double> altitude_integral;
+    /**
+     * The offset subtracted from the altitude from the
+     * break-even onwards.
+     */
+    double altitude_offset{0};
+    /**
+     * The memoised altitude at each tick from the first
+     * one.
+     */
+    std::vector<double> altitude_ticks;
 
     /**
-     * Obtains the telemetry value from the given mapping
-     * at the given time.
+     * Obtains the altitude of the sample nearest to the
+     * given time, from the fit if it covers that sample.
      *
-     * @param time the time to obtain the telemetry value
-     * @param map the map from which to obtain the value
-     * @return the telemetry value, or NAN if no value is
-     * present
+     * @param time the time at which to retrieve the
+     * altitude
+     * @return the altitude of the sample
      */
-    double get_telemetry_value(double time, const std::map<double, double> &map) const;
+    double get_sample_altitude(double time) const;
+
+    /**
+     * Obtains the conditioned altitude at the given time
+     * without looking up the memoised ticks.
+     *
+     * @param time the time at which to retrieve the
+     * altitude
+     * @return the altitude at the given time
+     */
+    double compute_altitude(double time) const;
 
 public:
     /**
@@ -76,9 +110,9 @@ public:
     /**
      * Sets the downrange distance stored in this profile.
      *
-     * @param range the downrange distance
+     * @param new_range the downrange distance
      */
-    void set_range(double range);
+    void set_range(double new_range);
 
     /**
      * Obtains the range or the downrange distance stored
@@ -88,6 +122,14 @@ public:
      */
     double get_downrange_distance() const;
 
+    /**
+     * Reserves storage for the given number of samples in
+     * each telemetry channel.
+     *
+     * @param samples the number of samples to reserve
+     */
+    void reserve(size_t samples);
+
     /**
      * Sets the telemetry value for velocity at the given
      * time to the given value.
@@ -108,6 +150,40 @@ public:
      */
     void put_altitude(double time, double next_altitude);
 
+    /**
+     * Replaces the altitude samples recorded within the
+     * segments of the given fit by the fit, which is
+     * evaluated at the time of a sample only once it is
+     * looked up. The samples it covers are dropped.
+     *
+     * The altitude samples must share their timestamps with
+     * the velocity samples, which are then used to find the
+     * sample nearest to a time.
+     *
+     * @param fit the altitude fit
+     */
+    void set_altitude_fit(const liftoff::piecewise_polynomial &fit);
+
+    /**
+     * Replaces the altitude before the tick at the given
+     * break-even by the velocity integral, and translates
+     * the rest of it down by the given offset.
+     *
+     * @param integral the velocity integral at each tick
+     * before the break-even
+     * @param offset the offset from the break-even onwards
+     */
+    void set_altitude_conditioning(std::vector<double> integral, double offset);
+
+    /**
+     * Memoises the altitude at the given number of ticks
+     * from the first one, which is what the replay looks
+     * up.
+     *
+     * @param ticks the number of ticks
+     */
+    void cache_altitude_ticks(size_t ticks);
+
     /**
      * Increments the current time value stored in this
      * flight profile by the time delta to obtain the next
@@ -143,7 +219,8 @@ public:
     double get_velocity(double time) const;
 
     /**
-     * Obtains the altitude at the given time offset.
+     * Obtains the altitude at the given time offset from
+     * the nearest sample, with the conditioning applied.
      *
      * @param time the time at which to retrieve the
      * altitude
@@ -152,19 +229,33 @@ public:
     double get_altitude(double time) const;
 
     /**
-     * Obtains the mapping of time values to velocity
-     * magnitudes.
+     * Obtains the series of velocity magnitudes.
+     *
+     * @return the velocity magnitude series
+     */
+    liftoff::time_series &get_velocities();
+
+    /**
+     * Obtains the series of velocity magnitudes.
+     *
+     * @return the velocity magnitude series
+     */
+    const liftoff::time_series &get_velocities() const;
+
+    /**
+     * Obtains the series of altitudes, without the samples
+     * covered by the fit.
      *
-     * @return the time to velocity magnitude map
+     * @return the altitude series
      */
-    std::map<double, double> &get_velocities();
+    liftoff::time_series &get_altitudes();
 
     /**
-     * Obtains the mapping of time values to altitudes.
+     * Obtains the series of altitudes.
      *
-     * @return the time to altitude map
+     * @return the altitude series
      */
-    std::map<double, double> &get_altitudes();
+    const liftoff::time_series &get_altitudes() const;
 
     /**
      * Sets the current time stored in this profile back to
@@ -0,0 +1,145 @@
+#include "telemetry_replay.h"
+
+#include <cmath>
+
+#include <liftoff-physics/trace.h>
+
+#include "vehicle_params.h"
+
+/**
+ * Determines the sign of the given number.
+ *
+ * @param x the number which to determine the sign
+ * @return -1 if negative, 1 if positive, 0 if 0
+ */
+static int signum(double x) {
+    return (x > 0) - (x < 0);
+}
+
+/**
+ * Uses the Pythagorean theorem to determine the vertical
+ * velocity based on the total velocity and altitude delta.
+ *
+ * This procedure supports only X and Y components.
+ *
+ * @param pidf the PIDF controller containing to compute
+ * the altitude delta and the time step, whose output trims
+ * the vertical velocity
+ * @param cur_v the current velocity vector
+ * @param mag_v the magnitude of the velocity for which
+ * to compute the next velocity
+ * @return the new desired velocity
+ */
+static liftoff::vector adjust_velocity(pidf_controller &pidf, const liftoff::vector &cur_v, double mag_v) {
+    double target_x_velocity;
+    double target_y_velocity;
+
+    if (pidf.get_setpoint() == 0) {
+        // 0 setpoint, must be around liftoff so the velocity
+        // must be exactly vertical
+        target_x_velocity = 0;
+        target_y_velocity = mag_v;
+    } else {
+        double error = pidf.compute_error();
+        target_y_velocity = error / pidf.get_time_step() + pidf.compute_pidf();
+
+        // The velocity needed to reach the setpoint is
+        // greater than the next velocity magnitude, so
+        // set the Y velocity to the entire magnitude of
+        // velocity
+        if (std::abs(target_y_velocity) > mag_v) {
+            target_y_velocity = signum(target_y_velocity) * mag_v;
+        }
+
+        // Otherwise, to reach the velocity magnitude,
+        // there needs to be an additional horizontal
+        // component
+        target_x_velocity = std::sqrt((double) (mag_v * mag_v - target_y_velocity * target_y_velocity));
+    }
+
+    return {target_x_velocity, target_y_velocity, 0};
+}
+
+telemetry_replay::telemetry_replay(const telemetry_flight_profile &tr_fitted,
+                                   velocity_flight_profile &tr_profile,
+                                   double max_time,
+                                   const pidf_gains &tr_gains) :
+        fitted(tr_fitted), profile(tr_profile),
+        time_step(tr_fitted.get_time_step()),
+        total_steps(static_cast<int>(max_time / tr_fitted.get_time_step())),
+        body(FALCON_9.launch_mass(), tr_fitted.get_time_step()),
+        pidf(tr_fitted.get_time_step(), tr_gains.p, tr_gains.i, tr_gains.d, tr_gains.f) {
+}
+
+void telemetry_replay::set_feed(c11_spsc_ring<velocity_sample> *ring) {
+    feed = ring;
+}
+
+int telemetry_replay::get_total_steps() const {
+    return total_steps;
+}
+
+double telemetry_replay::get_time() const {
+    return tick * time_step;
+}
+
+bool telemetry_replay::step(telemetry_sink &sink) {
+    if (tick >= total_steps) {
+        return false;
+    }
+
+    const liftoff::static_velocity_driven_body::state_type &d_mot{body.get_d_mot()};
+
+    // Telemetry
+    const liftoff::vector &p{d_mot[0]};
+    const liftoff::vector &v{d_mot[1]};
+    const liftoff::vector &a{d_mot[2]};
+    const liftoff::vector &j{d_mot[3]};
+
+    double cur_time_s = tick * time_step;
+    ++tick;
+
+    body.pre_compute();
+    pidf.set_last_state(p.get_y());
+
+    // Position/velocity computation
+    double telem_velocity = fitted.get_velocity(cur_time_s);
+    double telem_alt = fitted.get_altitude(cur_time_s);
+    if (!std::isnan(telem_velocity) && !std::isnan(telem_alt)) {
+        pidf.set_setpoint(telem_alt);
+
+        const liftoff::vector &new_velocity = adjust_velocity(pidf, v, telem_velocity);
+        body.set_velocity(new_velocity);
+    }
+
+    // Computation
+    body.compute_motion();
+    body.post_compute();
+
+    sink.record({cur_time_s, p.get_x(), p.get_y(), v.magnitude(), a.magnitude(), j.magnitude()});
+
+    // Record data to the result profile
+    profile.put_vx(cur_time_s, v.get_x());
+    profile.put_vy(cur_time_s, v.get_y());
+
+    // The consumer may have stopped early, in which case the
+    // ring is closed and the push fails
+    if (feed != nullptr) {
+        feed->push({cur_time_s, v.get_x(), v.get_y()});
+    }
+
+    return true;
+}
+
+void telemetry_replay::run(telemetry_sink &sink) {
+    LIFTOFF_TRACE_SCOPE("replay");
+
+    sink.begin(total_steps - tick);
+    while (step(sink)) {
+    }
+    sink.end();
+
+    if (feed != nullptr) {
+        feed->close();
+    }
+}
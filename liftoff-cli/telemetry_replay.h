@@ -0,0 +1,120 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_TELEMETRY_REPLAY_H
+#define LIFTOFF_CLI_TELEMETRY_REPLAY_H
+
+#include <liftoff-physics/static_driven_body.h>
+
+#include "pidf_controller.h"
+#include "telemetry_flight_profile.h"
+#include "telemetry_sink.h"
+#include "velocity_flight_profile.h"
+#include "velocity_source.h"
+
+/**
+ * @brief Replays the conditioned telemetry profile on a
+ * velocity driven body to extract the X/Y components of
+ * the velocity profile.
+ */
+class telemetry_replay {
+private:
+    /**
+     * The conditioned flight profile to replay.
+     */
+    const telemetry_flight_profile &fitted;
+    /**
+     * The velocity profile extracted by the replay.
+     */
+    velocity_flight_profile &profile;
+    /**
+     * The ring which each extracted velocity sample is
+     * pushed into as it is produced, or nullptr.
+     */
+    c11_spsc_ring<velocity_sample> *feed{nullptr};
+
+    /**
+     * The time step of each tick.
+     */
+    const double time_step;
+    /**
+     * The number of ticks to replay.
+     */
+    const int total_steps;
+    /**
+     * The next tick to replay.
+     */
+    int tick{0};
+
+    /**
+     * The body following the flight profile.
+     */
+    liftoff::static_velocity_driven_body body;
+    /**
+     * The controller trimming the vertical velocity which
+     * tracks the profile altitude.
+     */
+    pidf_controller pidf;
+
+public:
+    /**
+     * Creates a replay of the given conditioned profile,
+     * recording the extracted velocity components to the
+     * given profile.
+     *
+     * @param tr_fitted the conditioned flight profile
+     * @param tr_profile the result profile
+     * @param max_time the duration of the replay
+     * @param tr_gains the gains of the controller trimming
+     * the vertical velocity, none by default
+     */
+    telemetry_replay(const telemetry_flight_profile &tr_fitted,
+                     velocity_flight_profile &tr_profile,
+                     double max_time,
+                     const pidf_gains &tr_gains = pidf_gains{});
+
+    /**
+     * Sets the ring which each extracted velocity sample
+     * is pushed into so that a consumer can follow the
+     * replay while it runs. The ring is closed once the
+     * replay finishes.
+     *
+     * @param ring the ring to push samples into, this
+     * replay must be its only producer
+     */
+    void set_feed(c11_spsc_ring<velocity_sample> *ring);
+
+    /**
+     * Obtains the number of ticks in this replay.
+     *
+     * @return the total tick count
+     */
+    int get_total_steps() const;
+
+    /**
+     * Obtains the time of the next tick to replay.
+     *
+     * @return the next tick time, s
+     */
+    double get_time() const;
+
+    /**
+     * Replays the next tick, recording the resulting
+     * frame to the given sink.
+     *
+     * @param sink the sink to record the frame
+     * @return false if the replay had already finished
+     */
+    bool step(telemetry_sink &sink);
+
+    /**
+     * Replays every remaining tick, closing the feed
+     * afterwards if there is one.
+     *
+     * @param sink the sink to record the frames
+     */
+    void run(telemetry_sink &sink);
+};
+
+#endif // LIFTOFF_CLI_TELEMETRY_REPLAY_H
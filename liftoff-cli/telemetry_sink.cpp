@@ -0,0 +1,148 @@
+#include "telemetry_sink.h"
+
+#include <cstdint>
+
+// Buffer size for the file sinks so that frames are written in large blocks
+static const size_t SINK_BUFFER_SIZE = 1 << 16;
+
+static const char FRAME_MAGIC[8] = {'L', 'F', 'T', 'F', 'R', 'A', 'M', 'E'};
+static const uint64_t FRAME_FIELDS = sizeof(telemetry_frame) / sizeof(double);
+
+static FILE *open_sink_file(const std::string &path, const char *mode) {
+    FILE *file = std::fopen(path.c_str(), mode);
+    if (file != nullptr) {
+        std::setvbuf(file, nullptr, _IOFBF, SINK_BUFFER_SIZE);
+    }
+
+    return file;
+}
+
+// Closes the file if it is open, returns false if buffered output could not be
+// written
+static bool close_sink_file(FILE *&file) {
+    if (file == nullptr) {
+        return true;
+    }
+
+    bool ok = std::fflush(file) == 0 && !std::ferror(file);
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+void telemetry_sink::begin(size_t) {
+}
+
+void telemetry_sink::end() {
+}
+
+bool telemetry_sink::has_failed() const {
+    return false;
+}
+
+void null_sink::record(const telemetry_frame &) {
+    ++frames;
+}
+
+size_t null_sink::get_frames() const {
+    return frames;
+}
+
+csv_sink::csv_sink(const std::string &path) : file(open_sink_file(path, "w")) {
+}
+
+csv_sink::~csv_sink() {
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+bool csv_sink::is_open() const {
+    return file != nullptr;
+}
+
+void csv_sink::begin(size_t) {
+    if (file != nullptr) {
+        if (std::fputs("time,downrange,altitude,velocity,acceleration,jerk\n", file) == EOF) {
+            failed = true;
+        }
+    }
+}
+
+void csv_sink::record(const telemetry_frame &frame) {
+    if (file != nullptr) {
+        if (std::fprintf(file, "%.17g,%.17g,%.17g,%.17g,%.17g,%.17g\n",
+                         frame.time, frame.downrange, frame.altitude,
+                         frame.velocity, frame.acceleration, frame.jerk) < 0) {
+            failed = true;
+        }
+    }
+}
+
+void csv_sink::end() {
+    if (!close_sink_file(file)) {
+        failed = true;
+    }
+}
+
+bool csv_sink::has_failed() const {
+    return failed;
+}
+
+binary_sink::binary_sink(const std::string &path) : file(open_sink_file(path, "wb")) {
+}
+
+binary_sink::~binary_sink() {
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+bool binary_sink::is_open() const {
+    return file != nullptr;
+}
+
+void binary_sink::begin(size_t) {
+    if (file != nullptr) {
+        if (std::fwrite(FRAME_MAGIC, sizeof(FRAME_MAGIC), 1, file) != 1 ||
+            std::fwrite(&FRAME_FIELDS, sizeof(FRAME_FIELDS), 1, file) != 1) {
+            failed = true;
+        }
+    }
+}
+
+void binary_sink::record(const telemetry_frame &frame) {
+    if (file != nullptr) {
+        if (std::fwrite(&frame, sizeof(frame), 1, file) != 1) {
+            failed = true;
+        }
+    }
+}
+
+void binary_sink::end() {
+    if (!close_sink_file(file)) {
+        failed = true;
+    }
+}
+
+bool binary_sink::has_failed() const {
+    return failed;
+}
+
+std::unique_ptr<telemetry_sink> make_telemetry_sink(const std::string &type, const std::string &path) {
+    if (type == "csv") {
+        std::unique_ptr<csv_sink> sink{new csv_sink{path + ".csv"}};
+        if (sink->is_open()) {
+            return std::move(sink);
+        }
+    } else if (type == "binary") {
+        std::unique_ptr<binary_sink> sink{new binary_sink{path + ".bin"}};
+        if (sink->is_open()) {
+            return std::move(sink);
+        }
+    } else if (type == "null") {
+        return std::unique_ptr<telemetry_sink>{new null_sink};
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_TELEMETRY_SINK_H
+#define LIFTOFF_CLI_TELEMETRY_SINK_H
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+/**
+ * @brief The state of the simulated vehicle recorded at a
+ * single tick.
+ */
+struct telemetry_frame {
+    /**
+     * The simulation time, s.
+     */
+    double time;
+    /**
+     * The downrange distance, m.
+     */
+    double downrange;
+    /**
+     * The altitude, m.
+     */
+    double altitude;
+    /**
+     * The velocity magnitude, m/s.
+     */
+    double velocity;
+    /**
+     * The acceleration magnitude, m/s^2.
+     */
+    double acceleration;
+    /**
+     * The jerk magnitude, m/s^3.
+     */
+    double jerk;
+};
+
+/**
+ * @brief Receives the frames produced by a simulation
+ * stage.
+ *
+ * The stage calls begin() once, record() for each tick and
+ * end() once all ticks have been simulated.
+ */
+class telemetry_sink {
+public:
+    virtual ~telemetry_sink() = default;
+
+    /**
+     * Called before the first frame is recorded.
+     *
+     * @param expected_frames the number of frames the
+     * stage will produce at most
+     */
+    virtual void begin(size_t expected_frames);
+
+    /**
+     * Records the next frame produced by the stage.
+     *
+     * @param frame the frame to record
+     */
+    virtual void record(const telemetry_frame &frame) = 0;
+
+    /**
+     * Called after the last frame has been recorded.
+     */
+    virtual void end();
+
+    /**
+     * Determines whether any frame could not be recorded,
+     * which is known for certain once end() has been
+     * called.
+     *
+     * @return true if the recorded output is incomplete
+     */
+    virtual bool has_failed() const;
+};
+
+/**
+ * @brief Discards every frame, only counting them.
+ */
+class null_sink : public telemetry_sink {
+private:
+    /**
+     * The number of frames recorded.
+     */
+    size_t frames{0};
+
+public:
+    void record(const telemetry_frame &frame) override;
+
+    /**
+     * Obtains the number of frames recorded by this sink.
+     *
+     * @return the frame count
+     */
+    size_t get_frames() const;
+};
+
+/**
+ * @brief Writes each frame as a row of a CSV file with a
+ * header row naming the columns.
+ */
+class csv_sink : public telemetry_sink {
+private:
+    /**
+     * The file to write to, or nullptr if it could not be
+     * opened.
+     */
+    FILE *file;
+    /**
+     * Whether a write to the file or closing it failed.
+     */
+    bool failed{false};
+
+public:
+    /**
+     * Opens the CSV file at the given path for writing,
+     * replacing any existing file.
+     *
+     * @param path the path of the file to write
+     */
+    explicit csv_sink(const std::string &path);
+
+    csv_sink(const csv_sink &) = delete;
+
+    csv_sink &operator=(const csv_sink &) = delete;
+
+    ~csv_sink() override;
+
+    /**
+     * Determines whether the file was successfully
+     * opened and has not yet been closed by end().
+     *
+     * @return true if frames can be written
+     */
+    bool is_open() const;
+
+    void begin(size_t expected_frames) override;
+
+    void record(const telemetry_frame &frame) override;
+
+    /**
+     * Flushes and closes the file.
+     */
+    void end() override;
+
+    bool has_failed() const override;
+};
+
+/**
+ * @brief Writes each frame as its six native float64
+ * fields, in declaration order, following a header of the
+ * 8 byte magic "LFTFRAME" and the uint64 field count.
+ */
+class binary_sink : public telemetry_sink {
+private:
+    /**
+     * The file to write to, or nullptr if it could not be
+     * opened.
+     */
+    FILE *file;
+    /**
+     * Whether a write to the file or closing it failed.
+     */
+    bool failed{false};
+
+public:
+    /**
+     * Opens the binary file at the given path for writing,
+     * replacing any existing file.
+     *
+     * @param path the path of the file to write
+     */
+    explicit binary_sink(const std::string &path);
+
+    binary_sink(const binary_sink &) = delete;
+
+    binary_sink &operator=(const binary_sink &) = delete;
+
+    ~binary_sink() override;
+
+    /**
+     * Determines whether the file was successfully
+     * opened and has not yet been closed by end().
+     *
+     * @return true if frames can be written
+     */
+    bool is_open() const;
+
+    void begin(size_t expected_frames) override;
+
+    void record(const telemetry_frame &frame) override;
+
+    /**
+     * Flushes and closes the file.
+     */
+    void end() override;
+
+    bool has_failed() const override;
+};
+
+/**
+ * Creates a sink of the given type.
+ *
+ * @param type csv, binary or null
+ * @param path the path of the file written by the file
+ * sinks, without the .csv or .bin extension
+ * @return the sink, or nullptr if the type is unknown or
+ * its file cannot be opened
+ */
+std::unique_ptr<telemetry_sink> make_telemetry_sink(const std::string &type, const std::string &path);
+
+#endif // LIFTOFF_CLI_TELEMETRY_SINK_H
@@ -0,0 +1,188 @@
+#include "tuning.h"
+
+#include <cmath>
+#include <functional>
+#include <iterator>
+
+#include <liftoff-physics/trace.h>
+
+#include "pidf_controller.h"
+#include "rocket_sim.h"
+#include "telemetry_replay.h"
+#include "telemetry_sink.h"
+#include "velocity_flight_profile.h"
+#include "velocity_source.h"
+
+// The range of each PIDF gain swept by the grid. The feed-forward gain scales the
+// setpoint altitude, m, rather than the error, so it is much smaller
+static const double PIDF_LOWER[] = {-0.5, -0.1, -0.5, -0.01};
+static const double PIDF_UPPER[] = {0.5, 0.1, 0.5, 0.01};
+// The range of the coefficient of drag swept by the grid
+static const double CD_LOWER = 0.1;
+static const double CD_UPPER = 0.5;
+
+namespace {
+    /**
+     * @brief Sums the squared difference between the
+     * recorded altitude and the raw altitude at the same
+     * time.
+     */
+    class altitude_error_sink : public telemetry_sink {
+    private:
+        /**
+         * The profile to compare against.
+         */
+        const telemetry_flight_profile &raw;
+
+    public:
+        /**
+         * The sum of the squared errors, m^2.
+         */
+        double sum{0};
+        /**
+         * The number of frames compared.
+         */
+        size_t frames{0};
+
+        explicit altitude_error_sink(const telemetry_flight_profile &aes_raw) : raw(aes_raw) {
+        }
+
+        void record(const telemetry_frame &frame) override {
+            double error = frame.altitude - raw.get_altitude(frame.time);
+            if (std::isnan(error)) {
+                return;
+            }
+
+            sum += error * error;
+            ++frames;
+        }
+    };
+}
+
+/**
+ * Replays the flight with the given controller gains.
+ *
+ * @param config the search configuration
+ * @param fitted the conditioned flight profile
+ * @param x the P, I, D and F gains
+ * @param bound the error after which to stop early
+ * @param sink the sink to record the error
+ */
+static void replay_gains(const tuning_config &config, const telemetry_flight_profile &fitted,
+                         const std::vector<double> &x, double bound, altitude_error_sink &sink) {
+    pidf_gains gains;
+    gains.p = x[0];
+    gains.i = x[1];
+    gains.d = x[2];
+    gains.f = x[3];
+
+    velocity_flight_profile result{fitted.get_time_step()};
+    telemetry_replay replay{fitted, result, config.replay_duration, gains};
+    while (sink.sum <= bound && replay.step(sink)) {
+    }
+}
+
+/**
+ * Simulates the rocket with the given coefficient of drag
+ * following the velocity profile.
+ *
+ * @param config the search configuration
+ * @param profile the velocity profile of the nominal
+ * replay
+ * @param x the coefficient of drag
+ * @param bound the error after which to stop early
+ * @param sink the sink to record the error
+ */
+static void simulate_cd(const tuning_config &config, const velocity_flight_profile &profile,
+                        const std::vector<double> &x, double bound, altitude_error_sink &sink) {
+    vehicle_params params = config.nominal;
+    params.cd = x[0];
+
+    profile_velocity_source source{profile};
+    rocket_sim sim{source, params, config.sim_time_step, config.sim_duration};
+    while (sink.sum <= bound && sim.step(sink)) {
+    }
+}
+
+bool parse_tuning_target(const std::string &name, tuning_target &target) {
+    if (name == "pidf") {
+        target = tuning_target::pidf;
+    } else if (name == "cd") {
+        target = tuning_target::cd;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+tuning_result run_tuning(const tuning_config &config, const telemetry_flight_profile &raw,
+                         const telemetry_flight_profile &fitted, liftoff::thread_pool &pool) {
+    LIFTOFF_TRACE_SCOPE("tuning");
+
+    tuning_result result;
+    std::vector<double> lower;
+    std::vector<double> upper;
+
+    // Only written before the search, so every candidate
+    // reads it at once
+    velocity_flight_profile profile{config.sim_time_step};
+    std::function<void(const std::vector<double> &, double, altitude_error_sink &)> evaluate;
+    if (config.target == tuning_target::pidf) {
+        result.names = {"p", "i", "d", "f"};
+        lower.assign(std::begin(PIDF_LOWER), std::end(PIDF_LOWER));
+        upper.assign(std::begin(PIDF_UPPER), std::end(PIDF_UPPER));
+        evaluate = [&](const std::vector<double> &x, double bound, altitude_error_sink &sink) {
+            replay_gains(config, fitted, x, bound, sink);
+        };
+    } else {
+        null_sink replay_sink;
+        telemetry_replay replay{fitted, profile, config.replay_duration};
+        replay.run(replay_sink);
+
+        result.names = {"cd"};
+        lower = {CD_LOWER};
+        upper = {CD_UPPER};
+        evaluate = [&](const std::vector<double> &x, double bound, altitude_error_sink &sink) {
+            simulate_cd(config, profile, x, bound, sink);
+        };
+    }
+
+    // Confined to the swept ranges: the simulation drifts
+    // away from the telemetry by itself, which an
+    // unphysical drag coefficient would otherwise absorb
+    liftoff::objective_fn objective = [&](const std::vector<double> &x, double bound) {
+        for (size_t i = 0; i < x.size(); ++i) {
+            if (!(x[i] >= lower[i] && x[i] <= upper[i])) {
+                return static_cast<double>(INFINITY);
+            }
+        }
+
+        altitude_error_sink sink{raw};
+        evaluate(x, bound, sink);
+        return sink.sum;
+    };
+
+    liftoff::search_result coarse = liftoff::grid_search(objective, lower, upper, config.grid_points, &pool);
+
+    // Starts with a simplex spanning a single grid cell
+    // towards the inside of the ranges
+    std::vector<double> step(lower.size());
+    for (size_t i = 0; i < step.size(); ++i) {
+        step[i] = config.grid_points > 1 ? (upper[i] - lower[i]) / (config.grid_points - 1) : upper[i] - lower[i];
+        if (coarse.x[i] + step[i] > upper[i]) {
+            step[i] = -step[i];
+        }
+    }
+    liftoff::search_result fine = liftoff::nelder_mead(objective, coarse.x, step, config.refine, &pool);
+
+    // The refinement starts from the best grid point, so it
+    // is the same or better
+    altitude_error_sink sink{raw};
+    evaluate(fine.x, INFINITY, sink);
+
+    result.values = fine.x;
+    result.rms_error = sink.frames == 0 ? NAN : std::sqrt(sink.sum / sink.frames);
+    result.evaluations = coarse.evaluations + fine.evaluations + 1;
+    return result;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_TUNING_H
+#define LIFTOFF_CLI_TUNING_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <liftoff-physics/param_search.h>
+#include <liftoff-physics/thread_pool.h>
+
+#include "telemetry_flight_profile.h"
+#include "vehicle_params.h"
+
+/**
+ * @brief The parameters which can be fitted to the
+ * telemetry.
+ */
+enum class tuning_target {
+    /**
+     * The gains of the controller trimming the vertical
+     * velocity of the telemetry replay.
+     */
+    pidf,
+    /**
+     * The coefficient of drag of the rocket simulation.
+     */
+    cd
+};
+
+/**
+ * @brief The parameters of a parameter search.
+ */
+struct tuning_config {
+    /**
+     * The parameters to fit.
+     */
+    tuning_target target{tuning_target::pidf};
+    /**
+     * The number of grid points along each parameter of
+     * the coarse sweep.
+     */
+    size_t grid_points{5};
+    /**
+     * The refinement starting from the best grid point.
+     */
+    liftoff::nelder_mead_params refine;
+    /**
+     * The duration of the telemetry replay.
+     */
+    double replay_duration{0};
+    /**
+     * The time step of the rocket simulation.
+     */
+    double sim_time_step{1};
+    /**
+     * The duration of the rocket simulation.
+     */
+    double sim_duration{0};
+    /**
+     * The vehicle whose coefficient of drag is fitted.
+     */
+    vehicle_params nominal;
+};
+
+/**
+ * @brief The outcome of a parameter search.
+ */
+struct tuning_result {
+    /**
+     * The names of the fitted parameters.
+     */
+    std::vector<std::string> names;
+    /**
+     * The best value of each parameter.
+     */
+    std::vector<double> values;
+    /**
+     * The root mean square altitude error of the best
+     * values against the raw telemetry, m.
+     */
+    double rms_error;
+    /**
+     * The number of replays or simulations run.
+     */
+    size_t evaluations;
+};
+
+/**
+ * Parses the name of a tuning target.
+ *
+ * @param name pidf or cd
+ * @param target the target to write
+ * @return false if the name is unknown
+ */
+bool parse_tuning_target(const std::string &name, tuning_target &target);
+
+/**
+ * Fits the selected parameters to the raw altitude,
+ * sweeping a coarse grid and then refining the best point
+ * with the Nelder-Mead method.
+ *
+ * Each candidate replays or simulates the flight on its
+ * own, reading the profiles shared by every candidate, and
+ * stops as soon as its squared altitude error exceeds the
+ * best one found so far.
+ *
+ * @param config the search configuration
+ * @param raw the unconditioned flight profile
+ * @param fitted the conditioned flight profile
+ * @param pool the pool to evaluate the candidates on
+ * @return the fitted parameters
+ */
+tuning_result run_tuning(const tuning_config &config, const telemetry_flight_profile &raw,
+                         const telemetry_flight_profile &fitted, liftoff::thread_pool &pool);
+
+#endif // LIFTOFF_CLI_TUNING_H
@@ -0,0 +1,96 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_VEHICLE_PARAMS_H
+#define LIFTOFF_CLI_VEHICLE_PARAMS_H
+
+#include "falcon_9.h"
+
+/**
+ * @brief The parameters of the rocket model, which default
+ * to the Falcon 9 values.
+ *
+ * This is a literal type, so a vehicle known at compile
+ * time is described by a constexpr instance such as
+ * FALCON_9, while the dispersed vehicles of the
+ * Monte-Carlo runs are filled in at runtime.
+ */
+struct vehicle_params {
+    /**
+     * The coefficient of drag.
+     */
+    double cd{F9_CD};
+    /**
+     * The frontal surface area, m^2.
+     */
+    double area{F9_A};
+
+    /**
+     * The number of first stage engines.
+     */
+    int engine_count{9};
+    /**
+     * The maximum thrust of each engine, N.
+     */
+    double max_thrust{MERLIN_MAX_THRUST};
+    /**
+     * The specific impulse of each engine, s.
+     */
+    double isp{MERLIN_ISP};
+
+    /**
+     * The first stage dry mass, kg.
+     */
+    double stage_1_dry_mass{F9_STAGE_1_DRY_MASS};
+    /**
+     * The first stage propellant mass, kg.
+     */
+    double stage_1_fuel_mass{F9_STAGE_1_FUEL_MASS};
+    /**
+     * The second stage dry mass, kg.
+     */
+    double stage_2_dry_mass{F9_STAGE_2_DRY_MASS};
+    /**
+     * The second stage propellant mass, kg.
+     */
+    double stage_2_fuel_mass{F9_STAGE_2_FUEL_MASS};
+    /**
+     * The payload mass, kg.
+     */
+    double payload_mass{F9_PAYLOAD_MASS};
+
+    /**
+     * The time of main engine cut-off and stage
+     * separation, s.
+     */
+    double meco_time{155};
+
+    /**
+     * Obtains the mass of the whole vehicle on the pad.
+     *
+     * @return the launch mass, kg
+     */
+    constexpr double launch_mass() const {
+        return stage_1_dry_mass + stage_1_fuel_mass +
+               stage_2_dry_mass + stage_2_fuel_mass +
+               payload_mass;
+    }
+
+    /**
+     * Obtains the mass which the first stage carries
+     * besides its propellant, i.e. everything but the
+     * first stage propellant.
+     *
+     * @return the first stage burn dry mass, kg
+     */
+    constexpr double stage_1_burn_dry_mass() const {
+        return stage_1_dry_mass + stage_2_dry_mass +
+               payload_mass + stage_2_fuel_mass;
+    }
+};
+
+// The nominal Falcon 9
+static constexpr vehicle_params FALCON_9{};
+
+#endif // LIFTOFF_CLI_VEHICLE_PARAMS_H
@@ -5,7 +5,7 @@
 #ifndef LIFTOFF_CLI_VELOCITY_FLIGHT_PROFILE_H
 #define LIFTOFF_CLI_VELOCITY_FLIGHT_PROFILE_H
 
-#include <map>
+#include <liftoff-physics/time_series.h>
 
 /**
  * @brief Represents a flight profile consisting of the
@@ -22,26 +22,15 @@ class velocity_flight_profile {
     double current_time{0};
 
     /**
-     * Mapping of time values to horizontal velocity
-     * component values.
+     * Series of horizontal velocity component values over
+     * time.
      */
-    std::map<double, double> vx;
+    liftoff::time_series vx;
     /**
-     * Mapping of time values to vertiacal velocity
-     * component values.
+     * Series of vertical velocity component values over
+     * time.
      */
-    std::map<double, double> vy;
-
-    /**
-     * Obtains the telemetry value from the given mapping
-     * at the given time.
-     *
-     * @param time the time to obtain the telemetry value
-     * @param map the map from which to obtain the value
-     * @return the telemetry value, or NAN if no value is
-     * present
-     */
-    double get_telemetry_value(double time, const std::map<double, double> &map) const;
+    liftoff::time_series vy;
 
 public:
     /**
@@ -131,20 +120,18 @@ public:
     double get_vy(double time) const;
 
     /**
-     * Obtains the mapping of all time offsets to
-     * horizontal velocities at those times.
+     * Obtains the series of all horizontal velocities.
      *
-     * @return the map of times to horizontal velocity
+     * @return the horizontal velocity series
      */
-    std::map<double, double> &get_all_vx();
+    liftoff::time_series &get_all_vx();
 
     /**
-     * Obtains the mapping of all time offsets to
-     * vertical velocities at those times.
+     * Obtains the series of all vertical velocities.
      *
-     * @return the map of times to vertical velocity
+     * @return the vertical velocity series
      */
-    std::map<double, double> &get_all_vy();
+    liftoff::time_series &get_all_vy();
 
     /**
      * Sets the current time stored in this profile back to
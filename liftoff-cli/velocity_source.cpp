@@ -0,0 +1,43 @@
+#include "velocity_source.h"
+
+#include <cmath>
+
+profile_velocity_source::profile_velocity_source(const velocity_flight_profile &pvs_profile) :
+        profile(pvs_profile) {
+}
+
+void profile_velocity_source::get_velocity(double time, double &vx, double &vy) {
+    vx = profile.get_vx(time);
+    vy = profile.get_vy(time);
+}
+
+ring_velocity_source::ring_velocity_source(c11_spsc_ring<velocity_sample> &rvs_ring) :
+        ring(rvs_ring) {
+}
+
+void ring_velocity_source::get_velocity(double time, double &vx, double &vy) {
+    // Pop samples until the latest one is not earlier than
+    // the requested time
+    while (!drained && (!has_next || next.time < time)) {
+        if (has_next) {
+            prev = next;
+            has_prev = true;
+        }
+
+        has_next = ring.pop(next);
+        drained = !has_next;
+    }
+
+    if (!has_next) {
+        vx = NAN;
+        vy = NAN;
+        return;
+    }
+
+    // Prefer the later sample unless the earlier one is
+    // strictly closer, as with time_series::nearest()
+    const velocity_sample &sample = has_prev && std::abs(prev.time - time) < std::abs(next.time - time) ?
+                                    prev : next;
+    vx = sample.vx;
+    vy = sample.vy;
+}
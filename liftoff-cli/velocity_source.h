@@ -0,0 +1,122 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_CLI_VELOCITY_SOURCE_H
+#define LIFTOFF_CLI_VELOCITY_SOURCE_H
+
+#include "c11_spsc_ring.h"
+#include "velocity_flight_profile.h"
+
+/**
+ * @brief The velocity components extracted by the
+ * telemetry replay at a single tick.
+ */
+struct velocity_sample {
+    /**
+     * The time of the tick, s.
+     */
+    double time;
+    /**
+     * The horizontal velocity component, m/s.
+     */
+    double vx;
+    /**
+     * The vertical velocity component, m/s.
+     */
+    double vy;
+};
+
+/**
+ * @brief Provides the velocity components that the rocket
+ * simulation attempts to follow.
+ */
+class velocity_source {
+public:
+    virtual ~velocity_source() = default;
+
+    /**
+     * Obtains the velocity components closest to the given
+     * time. The times must be requested in increasing
+     * order.
+     *
+     * @param time the time at which to obtain the velocity
+     * @param vx the horizontal velocity, or NAN if the
+     * time is past the end of the profile
+     * @param vy the vertical velocity, or NAN if the time
+     * is past the end of the profile
+     */
+    virtual void get_velocity(double time, double &vx, double &vy) = 0;
+};
+
+/**
+ * @brief Reads the velocity components from a completed
+ * velocity flight profile.
+ */
+class profile_velocity_source : public velocity_source {
+private:
+    /**
+     * The profile to read from.
+     */
+    const velocity_flight_profile &profile;
+
+public:
+    /**
+     * Creates a source reading from the given profile.
+     *
+     * @param pvs_profile the completed profile
+     */
+    explicit profile_velocity_source(const velocity_flight_profile &pvs_profile);
+
+    void get_velocity(double time, double &vx, double &vy) override;
+};
+
+/**
+ * @brief Reads the velocity components from a ring buffer
+ * as the telemetry replay produces them, blocking until
+ * the sample for the requested time is available.
+ *
+ * This picks the same sample as the nearest lookup of a
+ * completed profile would.
+ */
+class ring_velocity_source : public velocity_source {
+private:
+    /**
+     * The ring which the replay pushes samples into.
+     */
+    c11_spsc_ring<velocity_sample> &ring;
+
+    /**
+     * The last sample popped before next.
+     */
+    velocity_sample prev{};
+    /**
+     * Whether prev holds a sample.
+     */
+    bool has_prev{false};
+    /**
+     * The latest sample popped from the ring.
+     */
+    velocity_sample next{};
+    /**
+     * Whether next holds a sample.
+     */
+    bool has_next{false};
+    /**
+     * Whether the ring has been closed and emptied.
+     */
+    bool drained{false};
+
+public:
+    /**
+     * Creates a source consuming the given ring.
+     *
+     * @param rvs_ring the ring to pop samples from, this
+     * source must be its only consumer
+     */
+    explicit ring_velocity_source(c11_spsc_ring<velocity_sample> &rvs_ring);
+
+    void get_velocity(double time, double &vx, double &vy) override;
+};
+
+#endif // LIFTOFF_CLI_VELOCITY_SOURCE_H
@@ -0,0 +1,123 @@
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <liftoff-physics/body_batch.h>
+#include <liftoff-physics/force_driven_body.h>
+#include <liftoff-physics/integrator.h>
+#include <liftoff-physics/vector.h>
+
+// Standard gravity, m/s^2
+static const double ACCEL_G = 9.80665;
+// Falcon 9 liftoff mass, kg
+static const double BENCH_MASS = 549054;
+// The time step of liftoff-cli, s
+static const double BENCH_TIME_STEP = 1;
+// The number of steps taken in each iteration
+static const int BENCH_STEPS = 1000;
+// The number of steps taken by each body of a batch in each iteration
+static const int BENCH_BATCH_STEPS = 100;
+
+// The integrators selected by range(0)
+enum bench_integrator {
+    BENCH_DRIVEN_BODY,
+    BENCH_EULER,
+    BENCH_RK4,
+    BENCH_VERLET
+};
+
+static std::unique_ptr<liftoff::integrator> make_integrator(int kind) {
+    switch (kind) {
+        case BENCH_EULER:
+            return std::unique_ptr<liftoff::integrator>{new liftoff::euler_integrator};
+        case BENCH_RK4:
+            return std::unique_ptr<liftoff::integrator>{new liftoff::rk4_integrator};
+        case BENCH_VERLET:
+            return std::unique_ptr<liftoff::integrator>{new liftoff::verlet_integrator};
+        default:
+            return nullptr;
+    }
+}
+
+// Steps a body under weight and a slightly larger thrust,
+// the forces rocket_sim applies at liftoff
+static void BM_force_driven_body_step(benchmark::State &state) {
+    std::unique_ptr<liftoff::integrator> integrator = make_integrator(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        liftoff::force_driven_body body{BENCH_MASS, 4, BENCH_TIME_STEP};
+        body.set_integrator(integrator.get());
+
+        std::vector<liftoff::vector> &forces = body.get_forces();
+        forces.push_back({0, -ACCEL_G * BENCH_MASS, 0});
+        forces.push_back({0, 1.2 * ACCEL_G * BENCH_MASS, 0});
+
+        for (int i = 0; i < BENCH_STEPS; ++i) {
+            body.pre_compute();
+            body.compute_motion();
+            body.post_compute();
+        }
+        benchmark::DoNotOptimize(body.get_d_mot().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_STEPS);
+}
+
+BENCHMARK(BM_force_driven_body_step)->ArgName("integrator")->DenseRange(BENCH_DRIVEN_BODY, BENCH_VERLET);
+
+// Steps each of range(0) bodies as its own force_driven_body,
+// the way the dispersion runner steps its rockets
+static void BM_force_driven_bodies_step(benchmark::State &state) {
+    auto count = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<liftoff::force_driven_body>> bodies;
+        for (size_t i = 0; i < count; ++i) {
+            bodies.emplace_back(new liftoff::force_driven_body{BENCH_MASS, 4, BENCH_TIME_STEP});
+
+            std::vector<liftoff::vector> &forces = bodies.back()->get_forces();
+            forces.push_back({0, -ACCEL_G * BENCH_MASS, 0});
+            forces.push_back({0, 1.2 * ACCEL_G * BENCH_MASS, 0});
+        }
+
+        for (int step = 0; step < BENCH_BATCH_STEPS; ++step) {
+            for (auto &body : bodies) {
+                body->pre_compute();
+                body->compute_forces();
+                body->compute_motion();
+                body->post_compute();
+            }
+        }
+        benchmark::DoNotOptimize(bodies.back()->get_d_mot().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_BATCH_STEPS * state.range(0));
+}
+
+BENCHMARK(BM_force_driven_bodies_step)->ArgName("bodies")->RangeMultiplier(8)->Range(8, 4096);
+
+// Steps the same bodies under the same forces as a single
+// body_batch, for comparison with BM_force_driven_bodies_step
+static void BM_body_batch_step(benchmark::State &state) {
+    auto count = static_cast<size_t>(state.range(0));
+    std::vector<double> zero(count);
+    std::vector<double> net_y(count, 0.2 * ACCEL_G * BENCH_MASS);
+
+    for (auto _ : state) {
+        liftoff::body_batch batch{count, BENCH_MASS, 2, 4, BENCH_TIME_STEP};
+        batch.set_forces(zero.data(), net_y.data(), zero.data());
+
+        for (int step = 0; step < BENCH_BATCH_STEPS; ++step) {
+            batch.pre_compute();
+            batch.set_forces(zero.data(), net_y.data(), zero.data());
+            batch.compute_motion();
+            batch.post_compute();
+        }
+        benchmark::DoNotOptimize(batch.data(0, 1));
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_BATCH_STEPS * state.range(0));
+}
+
+BENCHMARK(BM_body_batch_step)->ArgName("bodies")->RangeMultiplier(8)->Range(8, 4096);
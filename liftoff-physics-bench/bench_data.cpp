@@ -0,0 +1,106 @@
+#include "bench_data.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <liftoff-physics/event_detector.h>
+#include <liftoff-physics/telem_proc.h>
+
+#include "spacextract_reader.h"
+
+// Whether each of the MECO, SES-1 and SECO-1 events is a decrease in velocity
+static const std::vector<bool> STAGING_EVENTS{true, false, true};
+
+static std::string data_path{LIFTOFF_BENCH_DATA};
+
+void set_bench_data_path(const std::string &path) {
+    data_path = path;
+}
+
+// Linearly interpolates the series at the given time, clamped to its ends
+static double lerp_at(const liftoff::time_series &in, double time) {
+    size_t idx = in.lower_bound(time);
+    if (idx == 0) {
+        return in.value_at(0);
+    }
+    if (idx >= in.size()) {
+        return in.value_at(in.size() - 1);
+    }
+
+    double t0 = in.time_at(idx - 1);
+    double t1 = in.time_at(idx);
+    double v0 = in.value_at(idx - 1);
+    return v0 + (in.value_at(idx) - v0) * (time - t0) / (t1 - t0);
+}
+
+static bench_flight load_flight() {
+    bench_flight flight;
+
+    spacextract_reader reader{data_path};
+    if (!reader.is_open()) {
+        std::cerr << "Cannot read the telemetry data file '" << data_path << "'" << std::endl;
+        std::exit(1);
+    }
+
+    size_t lines = reader.count_lines();
+    flight.velocities.reserve(lines);
+    flight.altitudes.reserve(lines);
+
+    telemetry_sample sample;
+    while (reader.next(sample)) {
+        flight.velocities.put(sample.time, sample.velocity);
+        flight.altitudes.put(sample.time, sample.altitude * 1000);
+    }
+
+    liftoff::time_series fitted_velocities;
+    liftoff::interp_lin(fitted_velocities, flight.velocities);
+    liftoff::interp_lin(flight.fitted_altitudes, flight.altitudes);
+
+    std::vector<size_t> event_idx;
+    size_t found = liftoff::detect_events(fitted_velocities.time_data() + 1, fitted_velocities.value_data() + 1,
+                                          fitted_velocities.size() - 1, STAGING_EVENTS,
+                                          liftoff::event_detector_params{}, event_idx);
+    if (found != STAGING_EVENTS.size()) {
+        std::cerr << "Cannot find the MECO, SES-1 and SECO-1 events in '" << data_path << "'" << std::endl;
+        std::exit(1);
+    }
+
+    for (size_t idx : event_idx) {
+        flight.events.push_back(fitted_velocities.time_at(idx + 1));
+    }
+
+    return flight;
+}
+
+const bench_flight &get_bench_flight() {
+    static const bench_flight flight = load_flight();
+    return flight;
+}
+
+liftoff::time_series make_synthetic_series(const liftoff::time_series &in, size_t samples, double resolution) {
+    double begin = in.time_at(0);
+    double step = (in.time_at(in.size() - 1) - begin) / static_cast<double>(samples);
+
+    liftoff::time_series out;
+    out.reserve(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        double t = begin + static_cast<double>(i) * step;
+        out.put(t, std::round(lerp_at(in, t) / resolution) * resolution);
+    }
+
+    return out;
+}
+
+void sample_altitude_leg(double begin, double end, size_t samples,
+                         std::vector<double> &times, std::vector<double> &values) {
+    const liftoff::time_series &alt = get_bench_flight().fitted_altitudes;
+
+    times.resize(samples);
+    values.resize(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        double t = begin + (end - begin) * static_cast<double>(i) / static_cast<double>(samples - 1);
+        times[i] = t;
+        values[i] = lerp_at(alt, t);
+    }
+}
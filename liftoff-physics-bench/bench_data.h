@@ -0,0 +1,81 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_BENCH_BENCH_DATA_H
+#define LIFTOFF_PHYSICS_BENCH_BENCH_DATA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <liftoff-physics/time_series.h>
+
+/**
+ * @brief The telemetry of a recorded flight which the
+ * benchmark inputs are generated from.
+ */
+struct bench_flight {
+    /**
+     * The raw velocities, m/s.
+     */
+    liftoff::time_series velocities;
+    /**
+     * The raw altitudes, m.
+     */
+    liftoff::time_series altitudes;
+    /**
+     * The linearly interpolated altitudes, m.
+     */
+    liftoff::time_series fitted_altitudes;
+    /**
+     * The times of the MECO, SES-1 and SECO-1 events, s.
+     */
+    std::vector<double> events;
+};
+
+/**
+ * Sets the path of the SpaceXtract file which
+ * get_bench_flight() loads.
+ *
+ * @param path the path to the telemetry data file
+ */
+void set_bench_data_path(const std::string &path);
+
+/**
+ * Obtains the flight loaded from the telemetry data file
+ * on first use. Exits the benchmarks if the file cannot
+ * be read, since every result would be meaningless.
+ *
+ * @return the recorded flight
+ */
+const bench_flight &get_bench_flight();
+
+/**
+ * Generates a raw series with the given number of samples
+ * by resampling a channel of the recorded flight onto a
+ * uniform timeline and rounding the values to the given
+ * resolution, which repeats values the way SpaceXtract
+ * does.
+ *
+ * @param in the channel to resample
+ * @param samples the number of samples to generate
+ * @param resolution the spacing of the recorded values
+ * @return the synthetic series
+ */
+liftoff::time_series make_synthetic_series(const liftoff::time_series &in, size_t samples, double resolution);
+
+/**
+ * Samples a leg of the interpolated altitudes at the given
+ * number of uniformly spaced times.
+ *
+ * @param begin the start of the leg, s
+ * @param end the end of the leg, s
+ * @param samples the number of samples
+ * @param times the output of the sample times
+ * @param values the output of the sample altitudes
+ */
+void sample_altitude_leg(double begin, double end, size_t samples,
+                         std::vector<double> &times, std::vector<double> &values);
+
+#endif // LIFTOFF_PHYSICS_BENCH_BENCH_DATA_H
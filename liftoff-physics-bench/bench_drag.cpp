@@ -0,0 +1,41 @@
+#include <cmath>
+
+#include <benchmark/benchmark.h>
+
+#include <liftoff-physics/atmosphere_table.h>
+#include <liftoff-physics/drag.h>
+#include <liftoff-physics/time_series.h>
+
+#include "bench_data.h"
+
+// Falcon 9 drag coefficient, as in liftoff-cli
+static const double BENCH_CD = 0.25;
+// Falcon 9 frontal area, m^2
+static const double BENCH_AREA = M_PI * 2.6 * 2.6;
+
+// Computes the drag at every recorded sample of the
+// flight, with range(0) selecting the atmosphere table
+// over the analytic model
+static void BM_calc_drag_earth(benchmark::State &state) {
+    const bench_flight &flight = get_bench_flight();
+    const liftoff::time_series &alts = flight.altitudes;
+    const liftoff::time_series &vs = flight.velocities;
+    bool use_table = state.range(0) != 0;
+    const liftoff::atmosphere_table &table = liftoff::atmosphere_table::standard();
+
+    size_t n = std::min(alts.size(), vs.size());
+    const double *alt_data = alts.value_data();
+    const double *v_data = vs.value_data();
+    for (auto _ : state) {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += use_table ? liftoff::calc_drag_earth(BENCH_CD, alt_data[i], v_data[i], BENCH_AREA, table)
+                             : liftoff::calc_drag_earth(BENCH_CD, alt_data[i], v_data[i], BENCH_AREA);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+
+BENCHMARK(BM_calc_drag_earth)->ArgName("table")->Arg(0)->Arg(1);
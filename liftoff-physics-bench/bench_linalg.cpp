@@ -0,0 +1,191 @@
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gmpxx.h>
+
+#include <benchmark/benchmark.h>
+
+#include <liftoff-physics/linalg.h>
+#include <liftoff-physics/matrix.h>
+#include <liftoff-physics/polynomial.h>
+#include <liftoff-physics/thread_pool.h>
+
+#include "bench_data.h"
+
+// Seed of the generated matrices, fixed so that every run solves the same systems
+static const unsigned int MATRIX_SEED = 18;
+
+// Fits the first leg of the flight, forced through its
+// ends as flight_setup does, with range(0) as the order
+// and range(1) as the sample count
+static void BM_fit(benchmark::State &state) {
+    const bench_flight &flight = get_bench_flight();
+    auto order = static_cast<unsigned int>(state.range(0));
+    auto samples = static_cast<size_t>(state.range(1));
+
+    std::vector<double> times;
+    std::vector<double> values;
+    sample_altitude_leg(0, flight.events[0], samples, times, values);
+    std::vector<std::pair<double, double>> forced{{times.front(), values.front()},
+                                                  {times.back(), values.back()}};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(liftoff::fit(order, times, values, forced));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(samples));
+}
+
+BENCHMARK(BM_fit)->ArgsProduct({{2, 4, 6}, {64, 1024, 16384}});
+
+// Fits a multi-hour 60 Hz capture of the first leg at
+// order 6, with the power sums spread over a pool of
+// range(0) threads
+static void BM_fit_pooled(benchmark::State &state) {
+    const bench_flight &flight = get_bench_flight();
+    const size_t samples = 60 * 60 * 60 * 4;
+
+    std::vector<double> times;
+    std::vector<double> values;
+    sample_altitude_leg(0, flight.events[0], samples, times, values);
+    std::vector<std::pair<double, double>> forced{{times.front(), values.front()},
+                                                  {times.back(), values.back()}};
+
+    liftoff::thread_pool pool{static_cast<size_t>(state.range(0))};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(liftoff::fit(6, times, values, forced, &pool));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(samples));
+}
+
+BENCHMARK(BM_fit_pooled)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+// Refits the same leg as BM_fit with a fit_plan, which
+// only recomputes the right-hand side
+static void BM_fit_plan(benchmark::State &state) {
+    const bench_flight &flight = get_bench_flight();
+    auto order = static_cast<unsigned int>(state.range(0));
+    auto samples = static_cast<size_t>(state.range(1));
+
+    std::vector<double> times;
+    std::vector<double> values;
+    sample_altitude_leg(0, flight.events[0], samples, times, values);
+    std::vector<std::pair<double, double>> forced{{times.front(), values.front()},
+                                                  {times.back(), values.back()}};
+
+    liftoff::fit_plan plan{order, times, forced};
+    liftoff::polynomial poly;
+    for (auto _ : state) {
+        plan.fit(values, poly);
+        benchmark::DoNotOptimize(poly);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(samples));
+}
+
+BENCHMARK(BM_fit_plan)->ArgsProduct({{2, 4, 6}, {64, 1024, 16384}});
+
+// Interpolates range(0) points of the second leg of the
+// flight
+static void BM_lip(benchmark::State &state) {
+    const bench_flight &flight = get_bench_flight();
+    auto points = static_cast<size_t>(state.range(0));
+
+    std::vector<double> times;
+    std::vector<double> values;
+    sample_altitude_leg(flight.events[0], flight.events[1], points, times, values);
+    std::vector<std::pair<double, double>> forced;
+    for (size_t i = 0; i < points; ++i) {
+        forced.emplace_back(times[i], values[i]);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(liftoff::lip(forced));
+    }
+}
+
+BENCHMARK(BM_lip)->Arg(2)->Arg(4)->Arg(8);
+
+// Evaluates a fit of the first leg of order range(0) over
+// the leg's own times
+static void BM_polynomial_val(benchmark::State &state) {
+    const bench_flight &flight = get_bench_flight();
+    auto order = static_cast<unsigned int>(state.range(0));
+
+    std::vector<double> times;
+    std::vector<double> values;
+    sample_altitude_leg(0, flight.events[0], 4096, times, values);
+    liftoff::polynomial poly = liftoff::fit(order, times, values, {});
+
+    for (auto _ : state) {
+        double sum = 0;
+        for (double t : times) {
+            sum += poly.val(t);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(times.size()));
+}
+
+BENCHMARK(BM_polynomial_val)->Arg(2)->Arg(4)->Arg(8);
+
+// Generates a diagonally dominant matrix, which every
+// pivoting order can factor
+template<typename T>
+static liftoff::basic_matrix<T> make_matrix(size_t size) {
+    std::mt19937 rng{MATRIX_SEED};
+    std::uniform_real_distribution<double> dist{-1, 1};
+
+    liftoff::basic_matrix<T> mat{size};
+    for (size_t r = 0; r < size; ++r) {
+        for (size_t c = 0; c < size; ++c) {
+            mat[r][c] = dist(rng) + (r == c ? static_cast<double>(size) : 0);
+        }
+    }
+
+    return mat;
+}
+
+// Factors a range(0) square matrix, including the copy
+// of the input which lup() overwrites
+template<typename T>
+static void BM_lup(benchmark::State &state) {
+    auto size = static_cast<size_t>(state.range(0));
+    liftoff::basic_matrix<T> input = make_matrix<T>(size);
+    liftoff::basic_matrix<T> mat{size};
+    std::vector<int> perm;
+
+    for (auto _ : state) {
+        mat = input;
+        benchmark::DoNotOptimize(liftoff::lup(mat, perm));
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_lup, double)->RangeMultiplier(2)->Range(4, 64);
+BENCHMARK_TEMPLATE(BM_lup, mpf_class)->RangeMultiplier(2)->Range(4, 16);
+
+// Solves a factored range(0) square system
+template<typename T>
+static void BM_lup_linsolve(benchmark::State &state) {
+    auto size = static_cast<size_t>(state.range(0));
+    liftoff::basic_matrix<T> lu = make_matrix<T>(size);
+    std::vector<int> perm;
+    liftoff::lup(lu, perm);
+
+    std::vector<T> b(size);
+    for (size_t i = 0; i < size; ++i) {
+        b[i] = static_cast<double>(i + 1);
+    }
+
+    std::vector<T> sol;
+    for (auto _ : state) {
+        liftoff::lup_linsolve(lu, perm, b.data(), sol);
+        benchmark::DoNotOptimize(sol.data());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_lup_linsolve, double)->RangeMultiplier(2)->Range(4, 64);
+BENCHMARK_TEMPLATE(BM_lup_linsolve, mpf_class)->RangeMultiplier(2)->Range(4, 16);
@@ -0,0 +1,102 @@
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <liftoff-physics/telem_proc.h>
+#include <liftoff-physics/time_series.h>
+
+#include "bench_data.h"
+
+// The number of samples the recorded flight is resampled to
+static const size_t SYNTHETIC_SAMPLES = 1000000;
+// The resolution of the recorded altitudes, m
+static const double ALTITUDE_RESOLUTION = 100;
+// The spacing of the uniform grid channel_interp resamples onto, the SpaceXtract
+// frame interval, s
+static const double GRID_STEP = 1.0 / 30;
+// The number of lookups made in each iteration
+static const int LOOKUPS = 100000;
+
+static const liftoff::time_series &get_synthetic_altitudes() {
+    static const liftoff::time_series series =
+            make_synthetic_series(get_bench_flight().altitudes, SYNTHETIC_SAMPLES, ALTITUDE_RESOLUTION);
+    return series;
+}
+
+static void BM_interp_lin(benchmark::State &state) {
+    const liftoff::time_series &in = get_synthetic_altitudes();
+    liftoff::time_series out;
+
+    for (auto _ : state) {
+        out.clear();
+        liftoff::interp_lin(out, in);
+        benchmark::DoNotOptimize(out.value_data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(in.size()));
+}
+
+BENCHMARK(BM_interp_lin)->Unit(benchmark::kMillisecond);
+
+// Interpolates the recorded velocities and altitudes together, resampled
+// onto the uniform grid if range(0) is 1
+static void BM_channel_interp(benchmark::State &state) {
+    const bench_flight &flight = get_bench_flight();
+    double grid_step = state.range(0) != 0 ? GRID_STEP : 0;
+    liftoff::channel_interp interp;
+    liftoff::time_series velocities;
+    liftoff::time_series altitudes;
+
+    for (auto _ : state) {
+        interp.run({&velocities, &altitudes}, {&flight.velocities, &flight.altitudes}, grid_step);
+        benchmark::DoNotOptimize(altitudes.value_data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(flight.altitudes.size()));
+}
+
+BENCHMARK(BM_channel_interp)->ArgName("grid")->Arg(0)->Arg(1);
+
+// Looks up the altitude nearest to times spread over the flight, on the
+// recorded timeline or on the uniform grid if range(0) is 1
+static void BM_channel_nearest(benchmark::State &state) {
+    const bench_flight &flight = get_bench_flight();
+    double grid_step = state.range(0) != 0 ? GRID_STEP : 0;
+    liftoff::channel_interp interp;
+    liftoff::time_series velocities;
+    liftoff::time_series altitudes;
+    interp.run({&velocities, &altitudes}, {&flight.velocities, &flight.altitudes}, grid_step);
+
+    double begin = altitudes.time_at(0);
+    double step = (altitudes.time_at(altitudes.size() - 1) - begin) / LOOKUPS;
+    for (auto _ : state) {
+        double sum = 0;
+        for (int i = 0; i < LOOKUPS; ++i) {
+            sum += altitudes.value_at(altitudes.nearest(begin + i * step));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+
+BENCHMARK(BM_channel_nearest)->ArgName("grid")->Arg(0)->Arg(1);
+
+static void BM_collect(benchmark::State &state) {
+    liftoff::time_series in;
+    liftoff::interp_lin(in, get_synthetic_altitudes());
+    const std::vector<double> &events = get_bench_flight().events;
+
+    std::vector<std::vector<double>> times;
+    std::vector<std::vector<double>> legs;
+    for (auto _ : state) {
+        times.clear();
+        legs.clear();
+        liftoff::collect(times, legs, in, events);
+        benchmark::DoNotOptimize(legs.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(in.size()));
+}
+
+BENCHMARK(BM_collect)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Compares liftoff-physics-bench results against a baseline.
+
+Both files are Google Benchmark JSON output. Repeated runs are
+compared by their median, single runs by their only result. Exits
+with 1 if any benchmark is slower than the baseline by more than the
+tolerance.
+"""
+
+import argparse
+import json
+import sys
+
+# Google Benchmark time units in nanoseconds
+TIME_UNITS = {'ns': 1, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def load_times(path, metric):
+    with open(path) as f:
+        report = json.load(f)
+
+    medians = {}
+    singles = {}
+    for bench in report['benchmarks']:
+        if bench.get('error_occurred'):
+            continue
+
+        time = bench[metric] * TIME_UNITS[bench.get('time_unit', 'ns')]
+        name = bench.get('run_name', bench['name'])
+        if bench.get('run_type') == 'aggregate':
+            if bench.get('aggregate_name') == 'median':
+                medians[name] = time
+        else:
+            singles.setdefault(name, time)
+
+    singles.update(medians)
+    return singles
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('baseline', help='the stored baseline results')
+    parser.add_argument('current', help='the results to check')
+    parser.add_argument('--tolerance', type=float, default=0.10,
+                        help='the tolerated relative slowdown (default: %(default)s)')
+    parser.add_argument('--metric', choices=['cpu_time', 'real_time'], default='cpu_time',
+                        help='the time compared (default: %(default)s)')
+    args = parser.parse_args()
+
+    baseline = load_times(args.baseline, args.metric)
+    current = load_times(args.current, args.metric)
+
+    regressions = 0
+    width = max([len(name) for name in current] + [9])
+    print('%-*s %14s %14s %8s' % (width, 'Benchmark', 'Baseline ns', 'Current ns', 'Change'))
+    for name in sorted(current):
+        if name not in baseline:
+            print('%-*s %14s %14.1f %8s' % (width, name, '-', current[name], 'new'))
+            continue
+
+        change = current[name] / baseline[name] - 1
+        slower = change > args.tolerance
+        regressions += slower
+        print('%-*s %14.1f %14.1f %+7.1f%%%s' % (width, name, baseline[name], current[name],
+                                                 change * 100, ' SLOWER' if slower else ''))
+
+    for name in sorted(set(baseline) - set(current)):
+        print('%-*s %14.1f %14s %8s' % (width, name, baseline[name], '-', 'missing'))
+
+    if regressions:
+        print('%d benchmark(s) slowed down by more than %.0f%%' % (regressions, args.tolerance * 100))
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
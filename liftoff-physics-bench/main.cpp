@@ -0,0 +1,30 @@
+#include <cstring>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_data.h"
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+
+    // Google Benchmark leaves the arguments it does not
+    // recognize, which is where the data file is given
+    static const char DATA_FLAG[] = "--data=";
+    std::vector<char *> unrecognized{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], DATA_FLAG, sizeof(DATA_FLAG) - 1) == 0) {
+            set_bench_data_path(argv[i] + sizeof(DATA_FLAG) - 1);
+        } else {
+            unrecognized.push_back(argv[i]);
+        }
+    }
+
+    if (benchmark::ReportUnrecognizedArguments(static_cast<int>(unrecognized.size()), unrecognized.data())) {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
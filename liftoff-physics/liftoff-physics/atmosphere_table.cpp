@@ -0,0 +1,111 @@
+#include "atmosphere_table.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "drag.h"
+
+// The number of doubles in a sample
+static const int SAMPLE_SIZE = sizeof(liftoff::atmosphere_sample) / sizeof(double);
+static_assert(sizeof(liftoff::atmosphere_sample) == SAMPLE_SIZE * sizeof(double),
+              "The samples must be packed for the gathers to index them");
+
+static liftoff::atmosphere_sample calc_atmosphere_earth(double alt) {
+    return {liftoff::calc_rho_earth(alt), liftoff::calc_pressure_earth(alt), liftoff::calc_temperature_earth(alt)};
+}
+
+liftoff::atmosphere_table::atmosphere_table(double at_max_alt, double at_bin_size) :
+        bin_size(at_bin_size), max_alt(at_max_alt) {
+    auto count = static_cast<size_t>(std::ceil(at_max_alt / at_bin_size));
+    bins.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        double bottom = static_cast<double>(i) * at_bin_size;
+        double top = static_cast<double>(i + 1) * at_bin_size;
+
+        atmosphere_sample base = calc_atmosphere_earth(bottom);
+        atmosphere_sample end = calc_atmosphere_earth(std::nextafter(top, bottom));
+        bins.push_back({base, {end.rho - base.rho, end.pressure - base.pressure,
+                               end.temperature - base.temperature}});
+    }
+
+    // The last bin may reach beyond the highest altitude
+    max_alt = static_cast<double>(count) * at_bin_size;
+    max_pos = std::nextafter(static_cast<double>(count), 0.0);
+}
+
+const liftoff::atmosphere_table &liftoff::atmosphere_table::standard() {
+    static const atmosphere_table table;
+    return table;
+}
+
+liftoff::atmosphere_sample liftoff::atmosphere_table::lookup(double alt) const {
+    if (!(alt >= 0 && alt < max_alt)) {
+        return calc_atmosphere_earth(alt);
+    }
+
+    // The division can round up to the top of the last bin
+    double pos = std::min(alt / bin_size, max_pos);
+    auto idx = static_cast<size_t>(pos);
+    double frac = pos - static_cast<double>(idx);
+
+    const atmosphere_bin &bin = bins[idx];
+    return {bin.base.rho + bin.delta.rho * frac,
+            bin.base.pressure + bin.delta.pressure * frac,
+            bin.base.temperature + bin.delta.temperature * frac};
+}
+
+double liftoff::atmosphere_table::rho(double alt) const {
+    if (!(alt >= 0 && alt < max_alt)) {
+        return calc_rho_earth(alt);
+    }
+
+    // The division can round up to the top of the last bin
+    double pos = std::min(alt / bin_size, max_pos);
+    auto idx = static_cast<size_t>(pos);
+    double frac = pos - static_cast<double>(idx);
+
+    const atmosphere_bin &bin = bins[idx];
+    return bin.base.rho + bin.delta.rho * frac;
+}
+
+void liftoff::atmosphere_table::rho_batch(const double *alts, double *out, size_t count) const {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const double *base_rhos = &bins.data()->base.rho;
+    const double *delta_rhos = &bins.data()->delta.rho;
+    __m256d zero = _mm256_setzero_pd();
+    __m256d max = _mm256_set1_pd(max_alt);
+    __m256d bin = _mm256_set1_pd(bin_size);
+    __m256d top = _mm256_set1_pd(max_pos);
+    __m128i stride = _mm_set1_epi32(2 * SAMPLE_SIZE);
+    for (; i + 4 <= count; i += 4) {
+        __m256d alt = _mm256_loadu_pd(alts + i);
+        __m256d in_table = _mm256_and_pd(_mm256_cmp_pd(alt, zero, _CMP_GE_OQ), _mm256_cmp_pd(alt, max, _CMP_LT_OQ));
+        if (_mm256_movemask_pd(in_table) != 0xF) {
+            for (size_t k = i; k < i + 4; ++k) {
+                out[k] = rho(alts[k]);
+            }
+
+            continue;
+        }
+
+        __m256d pos = _mm256_min_pd(_mm256_div_pd(alt, bin), top);
+        __m256d whole = _mm256_floor_pd(pos);
+        __m256d frac = _mm256_sub_pd(pos, whole);
+
+        __m128i idx = _mm_mullo_epi32(_mm256_cvttpd_epi32(whole), stride);
+        __m256d base = _mm256_i32gather_pd(base_rhos, idx, sizeof(double));
+        __m256d delta = _mm256_i32gather_pd(delta_rhos, idx, sizeof(double));
+
+        _mm256_storeu_pd(out + i, _mm256_add_pd(base, _mm256_mul_pd(delta, frac)));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = rho(alts[i]);
+    }
+}
@@ -0,0 +1,136 @@
+#include "body_batch.h"
+
+#include <algorithm>
+
+// The number of axes of each motion vector
+static const int AXES = 3;
+
+namespace liftoff {
+    body_batch::body_batch(size_t bb_count, double bb_mass, d_idx_t bb_driver_idx, int bb_derivatives,
+                           double bb_time_step) :
+            count(bb_count), driver_idx(bb_driver_idx), derivatives(static_cast<d_idx_t>(bb_derivatives)),
+            time_step(bb_time_step), masses(bb_count, bb_mass),
+            d_mot(static_cast<size_t>(bb_derivatives) * AXES * bb_count),
+            prev_state(d_mot.size()) {
+    }
+
+    size_t body_batch::row(d_idx_t derivative, int axis) const {
+        return (derivative * AXES + axis) * count;
+    }
+
+    size_t body_batch::size() const {
+        return count;
+    }
+
+    double body_batch::get_mass(size_t idx) const {
+        return masses[idx];
+    }
+
+    void body_batch::set_mass(size_t idx, double mass) {
+        masses[idx] = mass;
+    }
+
+    vector body_batch::get_component(size_t idx, d_idx_t derivative) const {
+        if (derivatives <= derivative) {
+            return {};
+        }
+
+        return {d_mot[row(derivative, 0) + idx], d_mot[row(derivative, 1) + idx], d_mot[row(derivative, 2) + idx]};
+    }
+
+    void body_batch::set_component(size_t idx, d_idx_t derivative, const vector &component) {
+        if (derivatives <= derivative) {
+            return;
+        }
+
+        d_mot[row(derivative, 0) + idx] = component.get_x();
+        d_mot[row(derivative, 1) + idx] = component.get_y();
+        d_mot[row(derivative, 2) + idx] = component.get_z();
+
+        if (!initial) {
+            drive_derivatives(derivative, idx, idx + 1);
+        }
+    }
+
+    void body_batch::set_components(d_idx_t derivative, const double *x, const double *y, const double *z) {
+        if (derivatives <= derivative) {
+            return;
+        }
+
+        std::copy(x, x + count, d_mot.begin() + row(derivative, 0));
+        std::copy(y, y + count, d_mot.begin() + row(derivative, 1));
+        std::copy(z, z + count, d_mot.begin() + row(derivative, 2));
+
+        if (!initial) {
+            drive_derivatives(derivative, 0, count);
+        }
+    }
+
+    void body_batch::set_force(size_t idx, const vector &force) {
+        set_component(idx, 2, force / masses[idx]);
+    }
+
+    void body_batch::set_forces(const double *x, const double *y, const double *z) {
+        if (derivatives <= 2) {
+            return;
+        }
+
+        const double *mass = masses.data();
+        const double *in[AXES] = {x, y, z};
+        for (int axis = 0; axis < AXES; ++axis) {
+            const double *force = in[axis];
+            double *accel = d_mot.data() + row(2, axis);
+            for (size_t i = 0; i < count; ++i) {
+                accel[i] = force[i] / mass[i];
+            }
+        }
+
+        if (!initial) {
+            drive_derivatives(2, 0, count);
+        }
+    }
+
+    const double *body_batch::data(d_idx_t derivative, int axis) const {
+        return d_mot.data() + row(derivative, axis);
+    }
+
+    void body_batch::drive_derivatives(d_idx_t root_driver, size_t first, size_t last) {
+        for (d_idx_t d = root_driver + 1; d < derivatives; ++d) {
+            for (int axis = 0; axis < AXES; ++axis) {
+                const double *cur_driving = d_mot.data() + row(d - 1, axis);
+                const double *prev_driving = prev_state.data() + row(d - 1, axis);
+                double *out = d_mot.data() + row(d, axis);
+                for (size_t i = first; i < last; ++i) {
+                    out[i] = (cur_driving[i] - prev_driving[i]) / time_step;
+                }
+            }
+        }
+    }
+
+    void body_batch::drive_integrals(d_idx_t root_driver) {
+        // Walking up from the position means that every
+        // integral is advanced by its derivative from before
+        // this step, as in driven_body
+        for (d_idx_t d = 0; d < root_driver && d + 1 < derivatives; ++d) {
+            for (int axis = 0; axis < AXES; ++axis) {
+                const double *driving = d_mot.data() + row(d + 1, axis);
+                double *out = d_mot.data() + row(d, axis);
+                for (size_t i = 0; i < count; ++i) {
+                    out[i] += driving[i] * time_step;
+                }
+            }
+        }
+    }
+
+    void body_batch::pre_compute() {
+        initial = false;
+    }
+
+    void body_batch::compute_motion() {
+        drive_integrals(driver_idx);
+    }
+
+    void body_batch::post_compute() {
+        std::copy(d_mot.begin(), d_mot.end(), prev_state.begin());
+    }
+}
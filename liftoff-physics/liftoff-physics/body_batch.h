@@ -0,0 +1,220 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_BODY_BATCH_H
+#define LIFTOFF_PHYSICS_BODY_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "body.h"
+#include "vector.h"
+
+namespace liftoff {
+    /**
+     * @brief Represents a batch of driven bodies which share
+     * a driver derivative and time step, for example the
+     * bodies of a dispersion or of a multi-stage flight.
+     *
+     * The motion is stored as structure of arrays: each
+     * axis of each derivative is a contiguous row holding
+     * that component for every body, so a single pass of
+     * the integration kernel advances the whole batch.
+     *
+     * A batch driven by the velocity (derivative 1) behaves
+     * like a velocity_driven_body per body and a batch driven
+     * by the acceleration (derivative 2) like a
+     * force_driven_body, with the net forces passed in
+     * instead of collected from a list.
+     */
+    class body_batch {
+    private:
+        /**
+         * Whether or not the computation has started (i.e.
+         * whether pre_compute() has been called).
+         */
+        bool initial{true};
+        /**
+         * The number of bodies in the batch.
+         */
+        size_t count;
+        /**
+         * The index of the driving derivative.
+         */
+        d_idx_t driver_idx;
+        /**
+         * The number of derivatives stored per body.
+         */
+        d_idx_t derivatives;
+        /**
+         * The time step between update calls to the
+         * motion.
+         */
+        double time_step;
+        /**
+         * The mass of each body.
+         */
+        std::vector<double> masses;
+        /**
+         * The motion rows, derivative-major then axis, each
+         * of count elements.
+         */
+        std::vector<double> d_mot;
+        /**
+         * A snapshot of the motion rows from the previous
+         * step, in the same layout.
+         */
+        std::vector<double> prev_state;
+
+        /**
+         * Obtains the offset of the first element of the
+         * row for the given derivative and axis.
+         *
+         * @param derivative the index of the derivative
+         * @param axis 0, 1 or 2 for x, y or z
+         * @return the offset into the motion rows
+         */
+        size_t row(d_idx_t derivative, int axis) const;
+
+        /**
+         * Updates the derivatives above the given driver
+         * from the change of the one below them, for the
+         * bodies in the given range.
+         *
+         * @param root_driver the driver derivative index
+         * @param first the first body to update
+         * @param last one past the last body to update
+         */
+        void drive_derivatives(d_idx_t root_driver, size_t first, size_t last);
+
+        /**
+         * Updates the integrals below the driver derivative
+         * for every body.
+         *
+         * @param root_driver the driver derivative index
+         */
+        void drive_integrals(d_idx_t root_driver);
+
+    public:
+        /**
+         * Creates a batch of bodies at rest at the origin.
+         *
+         * @param bb_count the number of bodies
+         * @param bb_mass the initial mass of every body
+         * @param bb_driver_idx the index of the derivative
+         * that drives the motion of the bodies
+         * @param bb_derivatives the number of derivatives
+         * to compute in total
+         * @param bb_time_step the time step between calls
+         * to the computation methods
+         */
+        body_batch(size_t bb_count, double bb_mass, d_idx_t bb_driver_idx, int bb_derivatives = 4,
+                   double bb_time_step = 1);
+
+        /**
+         * Obtains the number of bodies in this batch.
+         *
+         * @return the body count
+         */
+        size_t size() const;
+
+        /**
+         * Obtains the mass of the given body.
+         *
+         * @param idx the body index
+         * @return the body mass
+         */
+        double get_mass(size_t idx) const;
+
+        /**
+         * Updates the mass of the given body.
+         *
+         * @param idx the body index
+         * @param mass the new body mass
+         */
+        void set_mass(size_t idx, double mass);
+
+        /**
+         * Obtains the motion vector of the given derivative
+         * for the given body.
+         *
+         * @param idx the body index
+         * @param derivative the index of the derivative
+         * @return the motion vector
+         */
+        liftoff::vector get_component(size_t idx, d_idx_t derivative) const;
+
+        /**
+         * Sets the motion vector of the given derivative for
+         * the given body, updating its higher derivatives if
+         * the computation has started.
+         *
+         * @param idx the body index
+         * @param derivative the index of the derivative
+         * @param component the new motion vector
+         */
+        void set_component(size_t idx, d_idx_t derivative, const liftoff::vector &component);
+
+        /**
+         * Sets the motion vectors of the given derivative for
+         * every body, updating the higher derivatives if the
+         * computation has started.
+         *
+         * @param derivative the index of the derivative
+         * @param x the x components, one per body
+         * @param y the y components, one per body
+         * @param z the z components, one per body
+         */
+        void set_components(d_idx_t derivative, const double *x, const double *y, const double *z);
+
+        /**
+         * Sets the acceleration of the given body from the
+         * net force acting on it.
+         *
+         * @param idx the body index
+         * @param force the net force
+         */
+        void set_force(size_t idx, const liftoff::vector &force);
+
+        /**
+         * Sets the acceleration of every body from the net
+         * force acting on it.
+         *
+         * @param x the x components, one per body
+         * @param y the y components, one per body
+         * @param z the z components, one per body
+         */
+        void set_forces(const double *x, const double *y, const double *z);
+
+        /**
+         * Obtains the row of the given derivative and axis,
+         * holding that component for every body.
+         *
+         * @param derivative the index of the derivative
+         * @param axis 0, 1 or 2 for x, y or z
+         * @return the pointer to the first body's component
+         */
+        const double *data(d_idx_t derivative, int axis) const;
+
+        /**
+         * The pre-computation method for updating the
+         * motion derivatives.
+         */
+        void pre_compute();
+
+        /**
+         * The computation method for updating the motion
+         * derivatives of every body.
+         */
+        void compute_motion();
+
+        /**
+         * The post-computation method for updating the
+         * motion derivatives.
+         */
+        void post_compute();
+    };
+}
+
+#endif // LIFTOFF_PHYSICS_BODY_BATCH_H
@@ -1,3 +1,5 @@
+#include "drag.h"
+
 #include <cmath>
 
 namespace liftoff {
@@ -45,7 +47,32 @@ namespace liftoff {
         return -1;
     }
 
+    // https://www.grc.nasa.gov/WWW/K-12/airplane/atmosmet.html#
+    double calc_temperature_earth(double alt) {
+        if (alt >= 25000) {
+            return -131.21 + .00299 * alt;
+        } else if (alt >= 11000 && alt < 25000) {
+            return -56.46;
+        } else if (alt < 11000) {
+            return 15.04 - .00649 * alt;
+        }
+
+        return NAN;
+    }
+
     double calc_drag_earth(double cd, double alt, double v, double a) {
         return calc_drag(cd, calc_rho_earth(alt), v, a);
     }
+
+    double calc_drag_earth(double cd, double alt, double v, double a, const atmosphere_table &table) {
+        return calc_drag(cd, table.rho(alt), v, a);
+    }
+
+    void calc_drag_earth_batch(double cd, const double *alts, const double *vs, double a, double *out, size_t count,
+                               const atmosphere_table &table) {
+        table.rho_batch(alts, out, count);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = cd * out[i] * vs[i] * vs[i] / 2 * a;
+        }
+    }
 }
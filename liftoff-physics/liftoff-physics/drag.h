@@ -7,6 +7,10 @@
 #ifndef LIFTOFF_PHYSICS_DRAG_H
 #define LIFTOFF_PHYSICS_DRAG_H
 
+#include <cstddef>
+
+#include "atmosphere_table.h"
+
 namespace liftoff {
     /**
      * Computes the drag force based upon the components
@@ -40,6 +44,16 @@ namespace liftoff {
      */
     double calc_rho_earth(double alt);
 
+    /**
+     * Computes the atmospheric temperature of the Earth
+     * based upon NASA's standard atmospheric model.
+     *
+     * @param alt the altitude from the surface of the Earth,
+     * in meters
+     * @return the temperature, in degrees Celsius
+     */
+    double calc_temperature_earth(double alt);
+
     /**
      * Computes the aerodynamic drag using the NASA's
      * standard atmospheric model to fill in for the
@@ -52,6 +66,38 @@ namespace liftoff {
      * @return the drag force, N
      */
     double calc_drag_earth(double cd, double alt, double v, double a);
+
+    /**
+     * Computes the aerodynamic drag using the density
+     * interpolated from the given table of the standard
+     * atmosphere.
+     *
+     * @param cd the coefficient of drag
+     * @param alt the altitude above Earth's surface, m
+     * @param v the velocity, m/s
+     * @param a the cross-sectional area, m^2
+     * @param table the atmosphere table
+     * @return the drag force, N
+     */
+    double calc_drag_earth(double cd, double alt, double v, double a, const liftoff::atmosphere_table &table);
+
+    /**
+     * Computes the aerodynamic drag of many bodies sharing
+     * a drag coefficient and area, using the density
+     * interpolated from the given table of the standard
+     * atmosphere.
+     *
+     * @param cd the coefficient of drag
+     * @param alts the altitudes above Earth's surface, m
+     * @param vs the velocities, m/s
+     * @param a the cross-sectional area, m^2
+     * @param out the output for the drag forces, N, must
+     * hold count values
+     * @param count the number of bodies
+     * @param table the atmosphere table
+     */
+    void calc_drag_earth_batch(double cd, const double *alts, const double *vs, double a, double *out, size_t count,
+                               const liftoff::atmosphere_table &table = liftoff::atmosphere_table::standard());
 }
 
 #endif // LIFTOFF_PHYSICS_DRAG_H
@@ -21,12 +21,8 @@ namespace liftoff {
     }
 
     void driven_body::drive_derivatives(d_idx_t root_driver) {
-        vector time_v{time_step};
-
         for (d_idx_t i = root_driver + 1; i < d_mot.size(); ++i) {
-            const vector &prev_driving_vec{prev_state[i - 1]};
-            const vector &cur_driving_vec{d_mot[i - 1]};
-            d_mot[i].set(cur_driving_vec).sub(prev_driving_vec).div(time_v);
+            d_mot[i] = (d_mot[i - 1] - prev_state[i - 1]) / time_step;
         }
     }
 
@@ -35,20 +31,12 @@ namespace liftoff {
             return;
         }
 
-        vector time_v{time_step};
-
-        std::vector<vector> adjusted_mot;
-        for (const auto &vec : d_mot) {
-            adjusted_mot.push_back(vector{vec}.mul(time_v));
+        // Walking up from the position means that each
+        // integral is advanced by its derivative from before
+        // this step without snapshotting the motion
+        for (d_idx_t i = 0; i < root_driver; ++i) {
+            d_mot[i] += d_mot[i + 1] * time_step;
         }
-
-        d_idx_t i = root_driver;
-        do {
-            i--;
-
-            const vector cur_driving_vec{adjusted_mot[i + 1]};
-            d_mot[i].add(cur_driving_vec);
-        } while (i != 0);
     }
 
     void driven_body::compute_motion() {
@@ -0,0 +1,94 @@
+#include "event_detector.h"
+#include "trace.h"
+
+liftoff::event_detector::event_detector(const std::vector<bool> &ed_negative_dv,
+                                        const event_detector_params &ed_params) :
+        negative_dv(ed_negative_dv), params(ed_params) {
+    event_indices.reserve(ed_negative_dv.size());
+    event_times.reserve(ed_negative_dv.size());
+}
+
+bool liftoff::event_detector::push(double time, double v) {
+    size_t idx = samples++;
+    if (done() || time < params.start_time) {
+        return false;
+    }
+
+    if (!has_prev) {
+        has_prev = true;
+        prev_time = time;
+        prev_v = v;
+        return false;
+    }
+
+    double dv = v - prev_v;
+    double dt = time - prev_time;
+    prev_v = v;
+    prev_time = time;
+
+    // Without smoothing or a threshold only the sign of the
+    // change matters, which also covers repeated times
+    double signal;
+    if (params.smoothing <= 0 && params.threshold <= 0) {
+        signal = dv;
+    } else if (!(dt > 0)) {
+        return false;
+    } else if (params.smoothing <= 0) {
+        signal = rate = dv / dt;
+    } else {
+        // Starts from rest so that a single outlier at the
+        // start cannot trigger an event on its own
+        double alpha = dt / (params.smoothing + dt);
+        signal = rate += alpha * (dv / dt - rate);
+    }
+
+    bool triggered = negative_dv[event_indices.size()] ? signal < -params.threshold : signal > params.threshold;
+    if (!triggered) {
+        return false;
+    }
+
+    event_indices.push_back(idx);
+    event_times.push_back(time);
+    return true;
+}
+
+bool liftoff::event_detector::done() const {
+    return event_indices.size() == negative_dv.size();
+}
+
+size_t liftoff::event_detector::get_event_count() const {
+    return event_indices.size();
+}
+
+const std::vector<size_t> &liftoff::event_detector::get_event_indices() const {
+    return event_indices;
+}
+
+const std::vector<double> &liftoff::event_detector::get_event_times() const {
+    return event_times;
+}
+
+void liftoff::event_detector::reset() {
+    samples = 0;
+    has_prev = false;
+    rate = 0;
+    event_indices.clear();
+    event_times.clear();
+}
+
+size_t liftoff::detect_events(const double *times, const double *values, size_t n,
+                              const std::vector<bool> &negative_dv,
+                              const event_detector_params &params,
+                              std::vector<size_t> &events) {
+    LIFTOFF_TRACE_SCOPE("detect_events");
+
+    event_detector detector{negative_dv, params};
+    for (size_t i = 0; i < n && !detector.done(); ++i) {
+        detector.push(times[i], values[i]);
+    }
+
+    events = detector.get_event_indices();
+    size_t found = events.size();
+    events.resize(negative_dv.size(), n);
+    return found;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_EVENT_DETECTOR_H
+#define LIFTOFF_PHYSICS_EVENT_DETECTOR_H
+
+#include <cstddef>
+#include <vector>
+
+namespace liftoff {
+    /**
+     * @brief The tuning of an event detector.
+     *
+     * The defaults detect an event at the first sample
+     * whose velocity moves in the expected direction, the
+     * same as find_event_time().
+     */
+    struct event_detector_params {
+        /**
+         * The time before which samples are ignored, s.
+         */
+        double start_time{0};
+        /**
+         * The time constant of the exponential moving
+         * average applied to dv/dt, s, or 0 to use the raw
+         * change between samples.
+         */
+        double smoothing{0};
+        /**
+         * How far dv/dt must move past 0 in the expected
+         * direction to trigger an event, m/s^2. Since the
+         * events alternate in direction, this is the
+         * hysteresis band that keeps noise around 0 from
+         * triggering the next event.
+         */
+        double threshold{0};
+    };
+
+    /**
+     * @brief Detects a sequence of events, such as the
+     * staging events, at which the velocity starts to
+     * decrease or increase, in a single pass over the
+     * samples as they arrive.
+     *
+     * Each event is detected only after the one before it,
+     * starting from the sample at which the previous one was
+     * detected.
+     */
+    class event_detector {
+    private:
+        /**
+         * Whether each event in the sequence is a decrease
+         * in velocity rather than an increase.
+         */
+        std::vector<bool> negative_dv;
+        /**
+         * The tuning of this detector.
+         */
+        event_detector_params params;
+
+        /**
+         * The number of samples pushed, including the
+         * ignored ones.
+         */
+        size_t samples{0};
+        /**
+         * Whether a sample has been accepted since the start
+         * time.
+         */
+        bool has_prev{false};
+        /**
+         * The time of the last accepted sample.
+         */
+        double prev_time{0};
+        /**
+         * The velocity of the last accepted sample.
+         */
+        double prev_v{0};
+        /**
+         * The smoothed dv/dt, m/s^2.
+         */
+        double rate{0};
+
+        /**
+         * The sample index of each detected event.
+         */
+        std::vector<size_t> event_indices;
+        /**
+         * The time of each detected event.
+         */
+        std::vector<double> event_times;
+
+    public:
+        /**
+         * Creates a detector for the given sequence of
+         * events.
+         *
+         * @param ed_negative_dv for each event in order,
+         * whether it is a decrease in velocity
+         * @param ed_params the tuning of the detector
+         */
+        explicit event_detector(const std::vector<bool> &ed_negative_dv,
+                                const event_detector_params &ed_params = event_detector_params{});
+
+        /**
+         * Feeds the next velocity sample to the detector.
+         * The times must not decrease.
+         *
+         * @param time the time of the sample, s
+         * @param v the velocity, m/s
+         * @return true if the sample is the next event
+         */
+        bool push(double time, double v);
+
+        /**
+         * Determines whether every event in the sequence
+         * has been detected.
+         *
+         * @return true if there is nothing left to detect
+         */
+        bool done() const;
+
+        /**
+         * Obtains the number of events detected so far.
+         *
+         * @return the detected event count
+         */
+        size_t get_event_count() const;
+
+        /**
+         * Obtains the index of the sample at which each
+         * event was detected, counting every sample pushed.
+         *
+         * @return the event sample indices
+         */
+        const std::vector<size_t> &get_event_indices() const;
+
+        /**
+         * Obtains the time at which each event was
+         * detected.
+         *
+         * @return the event times, s
+         */
+        const std::vector<double> &get_event_times() const;
+
+        /**
+         * Forgets every sample and event so that the
+         * detector can be used on another series.
+         */
+        void reset();
+    };
+
+    /**
+     * Detects the given sequence of events over arrays of
+     * samples in a single pass, which takes O(n) time
+     * regardless of the number of events.
+     *
+     * @param times the sample times, s
+     * @param values the sample velocities, m/s
+     * @param n the number of samples
+     * @param negative_dv for each event in order, whether
+     * it is a decrease in velocity
+     * @param params the tuning of the detector
+     * @param events the output of the sample index of each
+     * event, n for the events which were not found
+     * @return the number of events found
+     */
+    size_t detect_events(const double *times, const double *values, size_t n,
+                         const std::vector<bool> &negative_dv,
+                         const event_detector_params &params,
+                         std::vector<size_t> &events);
+}
+
+#endif // LIFTOFF_PHYSICS_EVENT_DETECTOR_H
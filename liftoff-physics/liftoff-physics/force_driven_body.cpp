@@ -23,6 +23,10 @@ namespace liftoff {
         set_component(2, acceleration);
     }
 
+    void force_driven_body::set_integrator(integrator *integrator) {
+        motion_integrator = integrator;
+    }
+
     void force_driven_body::pre_compute() {
         // Ensure driver forces are present for the
         // initial conditions
@@ -40,10 +44,38 @@ namespace liftoff {
 
         vector net_force;
         for (const auto &force : forces) {
-            net_force.add(force);
+            net_force += force;
         }
 
-        vector mass_v{get_mass()};
-        set_acceleration(net_force.div(mass_v));
+        set_acceleration(net_force / get_mass());
+    }
+
+    void force_driven_body::compute_motion() {
+        if (motion_integrator == nullptr || d_mot.size() < 3) {
+            driven_body::compute_motion();
+            force_time += time_step;
+            return;
+        }
+
+        // Report the acceleration that drove this step, as
+        // with Euler, instead of that of the integrator's
+        // last trial state
+        vector driver{d_mot[2]};
+
+        double start_time = force_time;
+        motion_state state{d_mot[0], d_mot[1]};
+        motion_integrator->advance(start_time, time_step, state, [this](double time, const motion_state &trial) {
+            d_mot[0].set(trial.position);
+            d_mot[1].set(trial.velocity);
+            force_time = time;
+
+            compute_forces();
+            return d_mot[2];
+        });
+
+        d_mot[0].set(state.position);
+        d_mot[1].set(state.velocity);
+        set_acceleration(driver);
+        force_time = start_time + time_step;
     }
 }
@@ -9,6 +9,7 @@
 
 #include "vector.h"
 #include "driven_body.h"
+#include "integrator.h"
 
 namespace liftoff {
     /**
@@ -21,6 +22,19 @@ namespace liftoff {
          * The forces acting upon this body.
          */
         std::vector<liftoff::vector> forces;
+        /**
+         * The integrator advancing the position and
+         * velocity, or nullptr to step with explicit Euler
+         * as a driven_body.
+         */
+        liftoff::integrator *motion_integrator{nullptr};
+        /**
+         * The time of the state which compute_forces() is
+         * computing the forces for, relative to the first
+         * step. While an integrator is evaluating a trial
+         * state, this is the time of that state.
+         */
+        double force_time{0};
 
     public:
         /**
@@ -65,6 +79,22 @@ namespace liftoff {
          */
         std::vector<liftoff::vector> &get_forces();
 
+        /**
+         * Sets the integrator which advances the position
+         * and velocity in compute_motion(), which is not
+         * owned by this body.
+         *
+         * The integrator calls compute_forces() for every
+         * trial state it evaluates, with the position,
+         * velocity and force_time of this body set to that
+         * state, so the forces should be computed there if
+         * they depend on the state.
+         *
+         * @param integrator the integrator, or nullptr for
+         * explicit Euler
+         */
+        void set_integrator(liftoff::integrator *integrator);
+
         void pre_compute() override;
 
         /**
@@ -72,6 +102,8 @@ namespace liftoff {
          * based upon the forces.
          */
         virtual void compute_forces();
+
+        void compute_motion() override;
     };
 }
 
@@ -0,0 +1,283 @@
+#include "gmp_arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <gmp.h>
+
+// Alignment of the blocks served from an arena, enough for the limbs
+static const size_t ARENA_ALIGN = alignof(std::max_align_t);
+// Size of the first chunk of an arena, bytes
+static const size_t ARENA_MIN_CHUNK = 64 * 1024;
+// The most memory an arena keeps between scopes, bytes; anything more is freed
+// once the outermost scope ends
+static const size_t ARENA_MAX_RETAINED = 64 << 20;
+// The most chunks an arena grows to within a scope, after which the allocations
+// go to the heap
+static const int ARENA_MAX_CHUNKS = 32;
+
+namespace {
+    /**
+     * @brief A block of memory which an arena bumps
+     * through.
+     */
+    struct arena_chunk {
+        char *base;
+        size_t size;
+    };
+
+    /**
+     * @brief The arena of a thread. Trivially destructible
+     * so that it is still usable by the GMP functions while
+     * the thread exits.
+     */
+    struct arena_state {
+        arena_chunk chunks[ARENA_MAX_CHUNKS];
+        int n_chunks;
+        /**
+         * The chunk being bumped through and the offset of
+         * its free space.
+         */
+        int current;
+        size_t offset;
+        /**
+         * The most recent block, which can be freed or
+         * resized in place.
+         */
+        char *last;
+        /**
+         * The number of arena and heap scopes entered.
+         */
+        int depth;
+        int heap_depth;
+    };
+
+    /**
+     * @brief Frees the chunks of the arena of a thread once
+     * the thread exits.
+     */
+    struct arena_releaser {
+        ~arena_releaser();
+    };
+}
+
+static thread_local arena_state arena{};
+static thread_local arena_releaser releaser;
+
+#ifdef LIFTOFF_ENABLE_TRACE
+static thread_local std::uint64_t heap_allocs = 0;
+#endif
+
+static void free_chunks() {
+    for (int i = 0; i < arena.n_chunks; ++i) {
+        std::free(arena.chunks[i].base);
+    }
+
+    arena.n_chunks = 0;
+    arena.current = 0;
+    arena.offset = 0;
+    arena.last = nullptr;
+}
+
+arena_releaser::~arena_releaser() {
+    free_chunks();
+}
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+static bool add_chunk(size_t size) {
+    if (arena.n_chunks == ARENA_MAX_CHUNKS) {
+        return false;
+    }
+
+    auto *base = static_cast<char *>(std::malloc(size));
+    if (base == nullptr) {
+        return false;
+    }
+
+    // Registers the releaser of this thread
+    static_cast<void>(&releaser);
+
+    arena.chunks[arena.n_chunks++] = {base, size};
+    return true;
+}
+
+static bool in_arena(const void *ptr) {
+    auto *p = static_cast<const char *>(ptr);
+    for (int i = 0; i < arena.n_chunks; ++i) {
+        const arena_chunk &chunk = arena.chunks[i];
+        if (p >= chunk.base && p < chunk.base + chunk.size) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Bumps a block out of the arena, returns nullptr if it cannot grow any more
+static void *bump(size_t size) {
+    size = align_up(size);
+
+    while (arena.current < arena.n_chunks) {
+        arena_chunk &chunk = arena.chunks[arena.current];
+        if (chunk.size - arena.offset >= size) {
+            arena.last = chunk.base + arena.offset;
+            arena.offset += size;
+            return arena.last;
+        }
+
+        ++arena.current;
+        arena.offset = 0;
+    }
+
+    // Each chunk at least doubles the arena
+    size_t total = 0;
+    for (int i = 0; i < arena.n_chunks; ++i) {
+        total += arena.chunks[i].size;
+    }
+    if (!add_chunk(std::max({size, total, ARENA_MIN_CHUNK}))) {
+        return nullptr;
+    }
+
+    arena.current = arena.n_chunks - 1;
+    arena.last = arena.chunks[arena.current].base;
+    arena.offset = size;
+    return arena.last;
+}
+
+static void *heap_alloc(size_t size) {
+#ifdef LIFTOFF_ENABLE_TRACE
+    ++heap_allocs;
+#endif
+
+    void *ptr = std::malloc(size);
+    if (ptr == nullptr) {
+        std::abort();
+    }
+
+    return ptr;
+}
+
+static void *gmp_alloc(size_t size) {
+    if (arena.depth > 0 && arena.heap_depth == 0) {
+        void *ptr = bump(size);
+        if (ptr != nullptr) {
+            return ptr;
+        }
+    }
+
+    return heap_alloc(size);
+}
+
+static void *gmp_realloc(void *ptr, size_t old_size, size_t new_size) {
+    if (!in_arena(ptr)) {
+#ifdef LIFTOFF_ENABLE_TRACE
+        ++heap_allocs;
+#endif
+
+        void *moved = std::realloc(ptr, new_size);
+        if (moved == nullptr) {
+            std::abort();
+        }
+
+        return moved;
+    }
+
+    // The most recent block can grow into the rest of its
+    // chunk
+    auto *p = static_cast<char *>(ptr);
+    if (p == arena.last) {
+        arena_chunk &chunk = arena.chunks[arena.current];
+        size_t begin = p - chunk.base;
+        if (chunk.size - begin >= align_up(new_size)) {
+            arena.offset = begin + align_up(new_size);
+            return ptr;
+        }
+    }
+
+    void *moved = gmp_alloc(new_size);
+    std::memcpy(moved, ptr, std::min(old_size, new_size));
+    return moved;
+}
+
+static void gmp_free(void *ptr, size_t) {
+    if (!in_arena(ptr)) {
+        std::free(ptr);
+        return;
+    }
+
+    // Temporaries are mostly freed in the reverse order, so
+    // the most recent block is given back
+    if (ptr == arena.last) {
+        arena.offset = arena.last - arena.chunks[arena.current].base;
+        arena.last = nullptr;
+    }
+}
+
+// Installs the GMP memory functions before main(). Memory GMP allocated before
+// that came from malloc() as well, so it is freed and resized the same way
+static const bool gmp_functions_installed = [] {
+    mp_set_memory_functions(gmp_alloc, gmp_realloc, gmp_free);
+    return true;
+}();
+
+liftoff::gmp_arena_scope::gmp_arena_scope(size_t reserve_bytes) {
+    if (arena.depth++ != 0) {
+        return;
+    }
+
+    // Nothing is held in the arena outside of a scope, so
+    // it may be replaced by a larger chunk
+    if (arena.n_chunks == 0 || arena.chunks[0].size < reserve_bytes) {
+        free_chunks();
+        add_chunk(std::max(align_up(reserve_bytes), ARENA_MIN_CHUNK));
+    }
+}
+
+liftoff::gmp_arena_scope::~gmp_arena_scope() {
+    if (--arena.depth != 0) {
+        return;
+    }
+
+    // Merges the chunks which the scope needed into one, so
+    // that the next scope fits in a single chunk
+    size_t total = 0;
+    for (int i = 0; i < arena.n_chunks; ++i) {
+        total += arena.chunks[i].size;
+    }
+
+    if (arena.n_chunks > 1 || total > ARENA_MAX_RETAINED) {
+        free_chunks();
+        if (total <= ARENA_MAX_RETAINED) {
+            add_chunk(total);
+        }
+    }
+
+    arena.current = 0;
+    arena.offset = 0;
+    arena.last = nullptr;
+}
+
+liftoff::gmp_heap_scope::gmp_heap_scope() {
+    ++arena.heap_depth;
+}
+
+liftoff::gmp_heap_scope::~gmp_heap_scope() {
+    --arena.heap_depth;
+}
+
+size_t liftoff::mpf_alloc_bytes(unsigned long bits) {
+    // See mpf_init2(): one limb more than the precision,
+    // which is rounded up to whole limbs plus one
+    size_t prec = (bits + 2 * GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+    return align_up((prec + 1) * sizeof(mp_limb_t));
+}
+
+#ifdef LIFTOFF_ENABLE_TRACE
+std::uint64_t liftoff::gmp_heap_allocations() {
+    return heap_allocs;
+}
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_GMP_ARENA_H
+#define LIFTOFF_PHYSICS_GMP_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace liftoff {
+    /**
+     * @brief Serves the GMP allocations made on the calling
+     * thread from a bump arena for as long as it is alive.
+     *
+     * Freeing a number from the arena costs nothing, and
+     * once the outermost scope on the thread ends the whole
+     * arena is reset at once. The arena keeps its memory for
+     * the next scope, merged into a single chunk, so a
+     * thread repeating the same computation allocates from
+     * the heap only the first time.
+     *
+     * No number allocated in the scope may outlive it, so
+     * the results should be created before it or inside a
+     * gmp_heap_scope. Assigning to a number keeps its
+     * storage, so numbers created before the scope can be
+     * written inside it.
+     */
+    class gmp_arena_scope {
+    public:
+        /**
+         * Starts serving the GMP allocations of this thread
+         * from its arena.
+         *
+         * @param reserve_bytes the size of the first chunk
+         * of the arena if it has to be enlarged, which
+         * avoids growing it piecemeal
+         */
+        explicit gmp_arena_scope(size_t reserve_bytes = 0);
+
+        gmp_arena_scope(const gmp_arena_scope &) = delete;
+
+        gmp_arena_scope &operator=(const gmp_arena_scope &) = delete;
+
+        /**
+         * Stops serving allocations from the arena, and
+         * resets it if this is the outermost scope.
+         */
+        ~gmp_arena_scope();
+    };
+
+    /**
+     * @brief Allocates the GMP numbers on the heap for as
+     * long as it is alive, even inside a gmp_arena_scope,
+     * for the results which outlive the arena.
+     */
+    class gmp_heap_scope {
+    public:
+        gmp_heap_scope();
+
+        gmp_heap_scope(const gmp_heap_scope &) = delete;
+
+        gmp_heap_scope &operator=(const gmp_heap_scope &) = delete;
+
+        ~gmp_heap_scope();
+    };
+
+    /**
+     * Computes the number of bytes GMP allocates for the
+     * limbs of a single mpf_t with the given precision, for
+     * sizing an arena.
+     *
+     * @param bits the precision, bits
+     * @return the allocation size, bytes
+     */
+    size_t mpf_alloc_bytes(unsigned long bits);
+
+#ifdef LIFTOFF_ENABLE_TRACE
+    /**
+     * Obtains the number of GMP allocations made from the
+     * heap on the calling thread, which excludes the ones
+     * served from an arena.
+     *
+     * @return the heap allocation count
+     */
+    std::uint64_t gmp_heap_allocations();
+#endif
+}
+
+#endif // LIFTOFF_PHYSICS_GMP_ARENA_H
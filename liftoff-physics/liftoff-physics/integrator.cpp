@@ -0,0 +1,246 @@
+#include "integrator.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The number of scalar components in a motion state
+static const int STATE_SIZE = 6;
+
+// Dormand-Prince 5(4) nodes
+static const double DP_C2 = 1.0 / 5;
+static const double DP_C3 = 3.0 / 10;
+static const double DP_C4 = 4.0 / 5;
+static const double DP_C5 = 8.0 / 9;
+
+// Dormand-Prince 5(4) stage coefficients, the last row being the 5th order solution
+static const double DP_A21 = 1.0 / 5;
+static const double DP_A31 = 3.0 / 40, DP_A32 = 9.0 / 40;
+static const double DP_A41 = 44.0 / 45, DP_A42 = -56.0 / 15, DP_A43 = 32.0 / 9;
+static const double DP_A51 = 19372.0 / 6561, DP_A52 = -25360.0 / 2187, DP_A53 = 64448.0 / 6561,
+        DP_A54 = -212.0 / 729;
+static const double DP_A61 = 9017.0 / 3168, DP_A62 = -355.0 / 33, DP_A63 = 46732.0 / 5247, DP_A64 = 49.0 / 176,
+        DP_A65 = -5103.0 / 18656;
+static const double DP_A71 = 35.0 / 384, DP_A73 = 500.0 / 1113, DP_A74 = 125.0 / 192, DP_A75 = -2187.0 / 6784,
+        DP_A76 = 11.0 / 84;
+
+// Difference between the 5th and the embedded 4th order weights
+static const double DP_E1 = 71.0 / 57600, DP_E3 = -71.0 / 16695, DP_E4 = 71.0 / 1920, DP_E5 = -17253.0 / 339200,
+        DP_E6 = 22.0 / 525, DP_E7 = -1.0 / 40;
+
+// Safety factor and bounds applied to the optimal step size change
+static const double STEP_SAFETY = 0.9;
+static const double MIN_STEP_FACTOR = 0.2;
+static const double MAX_STEP_FACTOR = 5;
+
+static void to_array(const liftoff::motion_state &state, double *y) {
+    y[0] = state.position.get_x();
+    y[1] = state.position.get_y();
+    y[2] = state.position.get_z();
+    y[3] = state.velocity.get_x();
+    y[4] = state.velocity.get_y();
+    y[5] = state.velocity.get_z();
+}
+
+static liftoff::motion_state from_array(const double *y) {
+    return {{y[0], y[1], y[2]}, {y[3], y[4], y[5]}};
+}
+
+liftoff::integrator::~integrator() = default;
+
+liftoff::vector liftoff::integrator::evaluate(const acceleration_fn &accel, double time, const motion_state &state) {
+    ++evaluations;
+    return accel(time, state);
+}
+
+size_t liftoff::integrator::get_evaluations() const {
+    return evaluations;
+}
+
+// Evaluates the derivative of the state, which is its velocity followed by the
+// acceleration
+static void derivative(const liftoff::vector &accel, const double *y, double *dy) {
+    dy[0] = y[3];
+    dy[1] = y[4];
+    dy[2] = y[5];
+    dy[3] = accel.get_x();
+    dy[4] = accel.get_y();
+    dy[5] = accel.get_z();
+}
+
+liftoff::euler_integrator::euler_integrator(int ei_substeps) : substeps(ei_substeps) {
+}
+
+void liftoff::euler_integrator::advance(double time, double duration, motion_state &state,
+                                        const acceleration_fn &accel) {
+    double h = duration / substeps;
+    for (int i = 0; i < substeps; ++i) {
+        vector a = evaluate(accel, time + i * h, state);
+
+        state.position += state.velocity * h;
+        state.velocity += a * h;
+    }
+}
+
+liftoff::rk4_integrator::rk4_integrator(int ri_substeps) : substeps(ri_substeps) {
+}
+
+void liftoff::rk4_integrator::advance(double time, double duration, motion_state &state,
+                                      const acceleration_fn &accel) {
+    double h = duration / substeps;
+    double y[STATE_SIZE];
+    double k1[STATE_SIZE];
+    double k2[STATE_SIZE];
+    double k3[STATE_SIZE];
+    double k4[STATE_SIZE];
+    double tmp[STATE_SIZE];
+
+    to_array(state, y);
+    for (int i = 0; i < substeps; ++i) {
+        double t = time + i * h;
+
+        derivative(evaluate(accel, t, from_array(y)), y, k1);
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            tmp[j] = y[j] + h / 2 * k1[j];
+        }
+
+        derivative(evaluate(accel, t + h / 2, from_array(tmp)), tmp, k2);
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            tmp[j] = y[j] + h / 2 * k2[j];
+        }
+
+        derivative(evaluate(accel, t + h / 2, from_array(tmp)), tmp, k3);
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            tmp[j] = y[j] + h * k3[j];
+        }
+
+        derivative(evaluate(accel, t + h, from_array(tmp)), tmp, k4);
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            y[j] += h / 6 * (k1[j] + 2 * k2[j] + 2 * k3[j] + k4[j]);
+        }
+    }
+
+    state = from_array(y);
+}
+
+liftoff::verlet_integrator::verlet_integrator(int vi_substeps) : substeps(vi_substeps) {
+}
+
+void liftoff::verlet_integrator::advance(double time, double duration, motion_state &state,
+                                         const acceleration_fn &accel) {
+    double h = duration / substeps;
+    double half_h = h / 2;
+    double half_h2 = h * h / 2;
+
+    // The acceleration at the end of each step starts the next one
+    vector a = evaluate(accel, time, state);
+    for (int i = 0; i < substeps; ++i) {
+        motion_state next{state.position + state.velocity * h + a * half_h2, state.velocity + a * h};
+
+        vector next_a = evaluate(accel, time + (i + 1) * h, next);
+        next.velocity = state.velocity + (a + next_a) * half_h;
+
+        state = next;
+        a = next_a;
+    }
+}
+
+liftoff::dormand_prince_integrator::dormand_prince_integrator(double dpi_abs_tol, double dpi_rel_tol,
+                                                              double dpi_min_step, double dpi_max_step) :
+        abs_tol(dpi_abs_tol), rel_tol(dpi_rel_tol), min_step(dpi_min_step), max_step(dpi_max_step) {
+}
+
+void liftoff::dormand_prince_integrator::advance(double time, double duration, motion_state &state,
+                                                 const acceleration_fn &accel) {
+    double y[STATE_SIZE];
+    double y_new[STATE_SIZE];
+    double tmp[STATE_SIZE];
+    double k1[STATE_SIZE];
+    double k2[STATE_SIZE];
+    double k3[STATE_SIZE];
+    double k4[STATE_SIZE];
+    double k5[STATE_SIZE];
+    double k6[STATE_SIZE];
+    double k7[STATE_SIZE];
+
+    if (next_step <= 0) {
+        next_step = std::min(duration, max_step);
+    }
+
+    to_array(state, y);
+    derivative(evaluate(accel, time, state), y, k1);
+
+    double t = time;
+    double remaining = duration;
+    while (remaining > 0) {
+        bool last = next_step >= remaining;
+        double h = last ? remaining : next_step;
+
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            tmp[j] = y[j] + h * DP_A21 * k1[j];
+        }
+        derivative(evaluate(accel, t + DP_C2 * h, from_array(tmp)), tmp, k2);
+
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            tmp[j] = y[j] + h * (DP_A31 * k1[j] + DP_A32 * k2[j]);
+        }
+        derivative(evaluate(accel, t + DP_C3 * h, from_array(tmp)), tmp, k3);
+
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            tmp[j] = y[j] + h * (DP_A41 * k1[j] + DP_A42 * k2[j] + DP_A43 * k3[j]);
+        }
+        derivative(evaluate(accel, t + DP_C4 * h, from_array(tmp)), tmp, k4);
+
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            tmp[j] = y[j] + h * (DP_A51 * k1[j] + DP_A52 * k2[j] + DP_A53 * k3[j] + DP_A54 * k4[j]);
+        }
+        derivative(evaluate(accel, t + DP_C5 * h, from_array(tmp)), tmp, k5);
+
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            tmp[j] = y[j] + h * (DP_A61 * k1[j] + DP_A62 * k2[j] + DP_A63 * k3[j] + DP_A64 * k4[j] +
+                                 DP_A65 * k5[j]);
+        }
+        derivative(evaluate(accel, t + h, from_array(tmp)), tmp, k6);
+
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            y_new[j] = y[j] + h * (DP_A71 * k1[j] + DP_A73 * k3[j] + DP_A74 * k4[j] + DP_A75 * k5[j] +
+                                   DP_A76 * k6[j]);
+        }
+        derivative(evaluate(accel, t + h, from_array(y_new)), y_new, k7);
+
+        // Root mean square of the error scaled by the tolerance of each component
+        double err = 0;
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            double e = h * (DP_E1 * k1[j] + DP_E3 * k3[j] + DP_E4 * k4[j] + DP_E5 * k5[j] + DP_E6 * k6[j] +
+                            DP_E7 * k7[j]);
+            double scale = abs_tol + rel_tol * std::max(std::abs(y[j]), std::abs(y_new[j]));
+            err += (e / scale) * (e / scale);
+        }
+        err = std::sqrt(err / STATE_SIZE);
+
+        double factor = err == 0 ? MAX_STEP_FACTOR :
+                        std::min(MAX_STEP_FACTOR, std::max(MIN_STEP_FACTOR, STEP_SAFETY * std::pow(err, -0.2)));
+        if (err > 1 && h > min_step) {
+            ++rejected;
+            next_step = std::max(min_step, h * std::min(1.0, factor));
+            continue;
+        }
+
+        // The last stage is evaluated at the new state, so it
+        // starts the next step
+        std::copy(y_new, y_new + STATE_SIZE, y);
+        std::copy(k7, k7 + STATE_SIZE, k1);
+        t += h;
+        remaining = last ? 0 : remaining - h;
+
+        // A step shortened to land on the end of the interval
+        // says little about the step the motion allows
+        double proposed = std::max(min_step, std::min(max_step, h * factor));
+        next_step = last ? std::max(next_step, proposed) : proposed;
+    }
+
+    state = from_array(y);
+}
+
+size_t liftoff::dormand_prince_integrator::get_rejected() const {
+    return rejected;
+}
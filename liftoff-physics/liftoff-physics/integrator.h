@@ -0,0 +1,225 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_INTEGRATOR_H
+#define LIFTOFF_PHYSICS_INTEGRATOR_H
+
+#include <cstddef>
+#include <functional>
+
+#include "vector.h"
+
+namespace liftoff {
+    /**
+     * @brief The position and velocity of a body, which is
+     * the state advanced by an integrator.
+     */
+    struct motion_state {
+        /**
+         * The position vector.
+         */
+        liftoff::vector position;
+        /**
+         * The velocity vector.
+         */
+        liftoff::vector velocity;
+    };
+
+    /**
+     * @brief Advances the motion of a body under an
+     * acceleration which depends on the time and the state.
+     */
+    class integrator {
+    public:
+        /**
+         * Computes the acceleration of the body at the given
+         * time and state.
+         */
+        typedef std::function<liftoff::vector(double time, const liftoff::motion_state &state)> acceleration_fn;
+
+    private:
+        /**
+         * The number of times the acceleration has been
+         * evaluated.
+         */
+        size_t evaluations{0};
+
+    protected:
+        /**
+         * Evaluates the acceleration, counting the
+         * evaluation.
+         *
+         * @param accel the acceleration function
+         * @param time the time of the state
+         * @param state the state to evaluate at
+         * @return the acceleration
+         */
+        liftoff::vector evaluate(const acceleration_fn &accel, double time, const liftoff::motion_state &state);
+
+    public:
+        virtual ~integrator();
+
+        /**
+         * Advances the given state over the given duration,
+         * taking as many internal steps as the method needs
+         * but never stepping past the end.
+         *
+         * @param time the time at the start of the interval
+         * @param duration the length of the interval
+         * @param state the state to advance
+         * @param accel the acceleration function
+         */
+        virtual void advance(double time, double duration, liftoff::motion_state &state,
+                             const acceleration_fn &accel) = 0;
+
+        /**
+         * Obtains the number of times the acceleration has
+         * been evaluated, which is the cost of integrating.
+         *
+         * @return the number of evaluations
+         */
+        size_t get_evaluations() const;
+    };
+
+    /**
+     * @brief Integrates with fixed explicit Euler steps,
+     * which is what driven_body does on its own.
+     */
+    class euler_integrator : public liftoff::integrator {
+    private:
+        /**
+         * The number of steps taken over each interval.
+         */
+        int substeps;
+
+    public:
+        /**
+         * Creates a new explicit Euler integrator.
+         *
+         * @param ei_substeps the number of steps taken over
+         * each interval
+         */
+        explicit euler_integrator(int ei_substeps = 1);
+
+        void advance(double time, double duration, liftoff::motion_state &state,
+                     const acceleration_fn &accel) override;
+    };
+
+    /**
+     * @brief Integrates with fixed classic 4th order
+     * Runge-Kutta steps, using 4 evaluations per step.
+     */
+    class rk4_integrator : public liftoff::integrator {
+    private:
+        /**
+         * The number of steps taken over each interval.
+         */
+        int substeps;
+
+    public:
+        /**
+         * Creates a new Runge-Kutta integrator.
+         *
+         * @param ri_substeps the number of steps taken over
+         * each interval
+         */
+        explicit rk4_integrator(int ri_substeps = 1);
+
+        void advance(double time, double duration, liftoff::motion_state &state,
+                     const acceleration_fn &accel) override;
+    };
+
+    /**
+     * @brief Integrates with fixed velocity Verlet steps,
+     * which are symplectic and so keep the energy of
+     * conservative motion bounded over long coasts.
+     *
+     * Velocity dependent accelerations such as drag are
+     * evaluated at the Euler prediction of the velocity.
+     */
+    class verlet_integrator : public liftoff::integrator {
+    private:
+        /**
+         * The number of steps taken over each interval.
+         */
+        int substeps;
+
+    public:
+        /**
+         * Creates a new velocity Verlet integrator.
+         *
+         * @param vi_substeps the number of steps taken over
+         * each interval
+         */
+        explicit verlet_integrator(int vi_substeps = 1);
+
+        void advance(double time, double duration, liftoff::motion_state &state,
+                     const acceleration_fn &accel) override;
+    };
+
+    /**
+     * @brief Integrates with the adaptive Dormand-Prince
+     * 5(4) Runge-Kutta method, growing the step while the
+     * local error stays within the tolerance and shrinking
+     * it through transients.
+     *
+     * The step size is remembered across calls so that long
+     * smooth phases keep their large steps.
+     */
+    class dormand_prince_integrator : public liftoff::integrator {
+    private:
+        /**
+         * The absolute error tolerance per component.
+         */
+        double abs_tol;
+        /**
+         * The error tolerance relative to each component.
+         */
+        double rel_tol;
+        /**
+         * The smallest step allowed, taken even if it fails
+         * the tolerance.
+         */
+        double min_step;
+        /**
+         * The largest step allowed.
+         */
+        double max_step;
+        /**
+         * The step size to try next, or 0 if none has been
+         * taken yet.
+         */
+        double next_step{0};
+        /**
+         * The number of steps rejected for exceeding the
+         * tolerance.
+         */
+        size_t rejected{0};
+
+    public:
+        /**
+         * Creates a new adaptive integrator.
+         *
+         * @param dpi_abs_tol the absolute error tolerance
+         * @param dpi_rel_tol the relative error tolerance
+         * @param dpi_min_step the smallest step allowed
+         * @param dpi_max_step the largest step allowed
+         */
+        dormand_prince_integrator(double dpi_abs_tol = 1e-6, double dpi_rel_tol = 1e-9,
+                                  double dpi_min_step = 1e-6, double dpi_max_step = 60);
+
+        void advance(double time, double duration, liftoff::motion_state &state,
+                     const acceleration_fn &accel) override;
+
+        /**
+         * Obtains the number of steps rejected for
+         * exceeding the tolerance.
+         *
+         * @return the number of rejected steps
+         */
+        size_t get_rejected() const;
+    };
+}
+
+#endif // LIFTOFF_PHYSICS_INTEGRATOR_H
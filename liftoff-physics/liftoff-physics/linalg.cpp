@@ -1,128 +1,409 @@
 #include "linalg.h"
+#include "gmp_arena.h"
 #include "matrix.h"
+#include "thread_pool.h"
+#include "trace.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <stdexcept>
 
 // Required precision for floating point values in order to perform the necessary polynomial
 // regressions
 // (pretty sure this is actually around 80, but 256 just to be safe :>)
 static const int REQ_PRECISION = 256;
 
-// Doolittle LU decomposition with partial pivot (L is the identity diagonal)
-// Adapted from: https://en.wikipedia.org/wiki/LU_decomposition#C_code_examples
-// Adapted from: https://www.codewithc.com/lu-decomposition-algorithm-flowchart/
-static int lup(liftoff::matrix &mat, std::vector<int> &perm) {
-    int pivot_count = 0;
+// Largest 1-norm condition number estimate of the scaled system for which the
+// double precision solution is trusted; anything worse is re-solved using GMP
+// (~1e-8 relative error in the scaled coefficients)
+static const double MAX_DOUBLE_COND = 1e8;
 
-    // Each element of the permutation vector represents a row of the permutation matrix
-    // The integer is the index on that row at which the 1 is located
-    for (int i = 0; i < mat.rows(); ++i) {
-        perm.push_back(i);
+// Number of samples in each chunk of the power sums. The chunks do not depend on
+// the number of threads so neither do the sums, and up to one chunk they are the
+// same as a single pass
+static const size_t POWER_SUM_CHUNK = 1 << 14;
+
+// Fraction of its length the streaming window may move before its sums are rebuilt;
+// the window covers 1 / (1 + slack) of the scaled range, which costs conditioning
+static const double STREAMING_SLACK = 0.25;
+
+static liftoff::polynomial linsolve(liftoff::matrix &m, const liftoff::matrix &b) {
+    std::vector<int> perm;
+    liftoff::lup(m, perm);
+
+    std::vector<mpf_class> sol;
+    liftoff::lup_linsolve(m, perm, b.data(), sol);
+
+    return liftoff::polynomial{sol};
+}
+
+/**
+ * @brief Affine map of the X values onto [-1, 1] which
+ * keeps the powers in the double precision systems close
+ * to unity.
+ */
+struct poly_scale {
+    double centre;
+    double half_width;
+
+    double apply(double x) const {
+        return (x - centre) / half_width;
     }
+};
 
-    // Pivoting portion
-    for (int row = 0; row < mat.rows(); ++row) {
-        int max_row = row;
-        mpf_class max_cell{0, REQ_PRECISION};
+static poly_scale make_scale(double min, double max) {
+    double half_width = (max - min) / 2;
+    if (!(half_width > 0)) {
+        half_width = 1;
+    }
 
-        // Find the max cell on the diagonal cell for the current row
-        for (int r = row; r < mat.rows(); ++r) {
-            mpf_class &cell_mag = mat[r][row];
-            if (cell_mag < 0) {
-                cell_mag = -cell_mag;
-            }
+    return {(max + min) / 2, half_width};
+}
 
-            if (max_cell < cell_mag) {
-                max_cell = cell_mag;
-                max_row = r;
-            }
+// Adds the value to the compensated sum, using Neumaier's improved Kahan
+// summation; the sum is sum + comp
+// https://en.wikipedia.org/wiki/Kahan_summation_algorithm#Further_enhancements
+static void compensated_add(double &sum, double &comp, double value) {
+    double t = sum + value;
+    if (std::abs(sum) >= std::abs(value)) {
+        comp += (sum - t) + value;
+    } else {
+        comp += (value - t) + sum;
+    }
+
+    sum = t;
+}
+
+// Computes the sums.size() / 2 compensated sums, as (sum, comp) pairs, over the
+// indices [0, n) in chunks of POWER_SUM_CHUNK indices, spread over the pool if
+// there is one. sum_chunk(begin, end, pairs) adds the indices of a chunk to its
+// zeroed pairs, which are then merged in chunk order. chunks is scratch space
+template<typename F>
+static void chunked_sums(size_t n, liftoff::thread_pool *pool, const F &sum_chunk,
+                         std::vector<double> &sums, std::vector<double> &chunks) {
+    size_t width = sums.size();
+    size_t n_chunks = (n + POWER_SUM_CHUNK - 1) / POWER_SUM_CHUNK;
+    std::fill(sums.begin(), sums.end(), 0);
+    if (n_chunks <= 1) {
+        sum_chunk(0, n, sums.data());
+        return;
+    }
+
+    chunks.assign(n_chunks * width, 0);
+    auto run_chunk = [&](size_t c) {
+        size_t begin = c * POWER_SUM_CHUNK;
+        sum_chunk(begin, std::min(n, begin + POWER_SUM_CHUNK), chunks.data() + c * width);
+    };
+
+    // The fits may themselves be tasks of the pool: waiting
+    // for the group only runs its own chunks, never other
+    // work of the pool which could be blocked on this fit
+    if (pool != nullptr) {
+        liftoff::task_group group{*pool};
+        for (size_t c = 0; c < n_chunks; ++c) {
+            group.run([&run_chunk, c] { run_chunk(c); });
         }
+        group.wait();
+    } else {
+        for (size_t c = 0; c < n_chunks; ++c) {
+            run_chunk(c);
+        }
+    }
 
-        // max_row has the greatest magnitude, swap into this row
-        if (max_row != row) {
-            std::swap(mat[row], mat[max_row]);
-            std::swap(perm[row], perm[max_row]);
+    std::copy(chunks.begin(), chunks.begin() + width, sums.begin());
+    for (size_t c = 1; c < n_chunks; ++c) {
+        const double *chunk = chunks.data() + c * width;
+        for (size_t k = 0; k < width; k += 2) {
+            compensated_add(sums[k], sums[k + 1], chunk[k]);
+            sums[k + 1] += chunk[k + 1];
+        }
+    }
+}
 
-            ++pivot_count;
+// Factors the n x n system in double precision, returns false if the
+// condition number estimate is too large to trust its solutions. e and inv_col
+// are scratch space
+static bool factor_d(const liftoff::matrix_d &m, liftoff::lu_factorization<double> &lu,
+                     std::vector<double> &e, std::vector<double> &inv_col) {
+    int n = m.rows();
+
+    double norm = 0;
+    for (int c = 0; c < n; ++c) {
+        double col_sum = 0;
+        for (int r = 0; r < n; ++r) {
+            col_sum += std::abs(m[r][c]);
         }
+
+        norm = std::max(norm, col_sum);
     }
 
-    // The loop works by going row-by-row and whittling down each
-    // term added from multiplying the L and U portions, isolating
-    // the value of the cell
-    for (int row = 0; row < mat.rows(); ++row) {
-        // Before the `row` column: L portion
-        for (int col = 0; col < row; ++col) {
-            for (int p = 0; p < col; ++p) {
-                mat[row][col] -= mat[row][p] * mat[p][col];
-            }
+    if (!lu.factor(m)) {
+        return false;
+    }
 
-            mat[row][col] /= mat[col][col];
+    // The systems are tiny, so the inverse norm is computed
+    // exactly rather than estimated
+    double inv_norm = 0;
+    e.assign(n, 0);
+    for (int c = 0; c < n; ++c) {
+        e[c] = 1;
+        lu.solve(e.data(), inv_col);
+        e[c] = 0;
+
+        double col_sum = 0;
+        for (int r = 0; r < n; ++r) {
+            col_sum += std::abs(inv_col[r]);
         }
 
-        // After the `row` column: U portion
-        for (int col = row; col < mat.rows(); ++col) {
-            for (int p = 0; p < row; ++p) {
-                mat[row][col] -= mat[row][p] * mat[p][col];
-            }
+        inv_norm = std::max(inv_norm, col_sum);
+    }
+
+    double cond = norm * inv_norm;
+    return std::isfinite(cond) && cond <= MAX_DOUBLE_COND;
+}
+
+// Solves the system factored by factor_d(), returns false if the solution is
+// not finite
+static bool solve_factored_d(const liftoff::lu_factorization<double> &lu, const std::vector<double> &b,
+                             std::vector<double> &sol) {
+    lu.solve(b.data(), sol);
+    for (double v : sol) {
+        if (!std::isfinite(v)) {
+            return false;
         }
     }
 
-    return pivot_count;
+    return true;
 }
 
-// Doolittle LU decomposition forward/backward substitution linear solver function
-// Adapted from: https://en.wikipedia.org/wiki/LU_decomposition#C_code_examples
-static liftoff::polynomial lup_linsolve(const liftoff::matrix &mat, const std::vector<int> &perm,
-                                        const liftoff::matrix &b) {
-    liftoff::polynomial sol{mat.rows()};
+// Solves the n x n system in double precision, returns false if the
+// condition number estimate is too large to trust the result
+static bool linsolve_d(const liftoff::matrix_d &m, const std::vector<double> &b, std::vector<double> &sol) {
+    liftoff::lu_factorization<double> lu;
+    std::vector<double> e;
+    std::vector<double> inv_col;
+    return factor_d(m, lu, e, inv_col) && solve_factored_d(lu, b, sol);
+}
 
-    for (int row = 0; row < mat.rows(); ++row) {
-        // sol = P*b
-        sol[row] = b[perm[row]][0];
+// Expands q((x - centre) / half_width) into the coefficients of x using GMP so
+// that the translation itself does not lose any precision. The coefficients
+// are written to p, reusing its storage
+static void unscale(const double *q, size_t terms, const poly_scale &scale, std::vector<mpf_class> &p) {
+    mpf_class a{1, REQ_PRECISION};
+    a /= scale.half_width;
+    mpf_class b{-scale.centre, REQ_PRECISION};
+    b /= scale.half_width;
+
+    if (p.size() != terms) {
+        p.assign(terms, mpf_class{0, REQ_PRECISION});
+    }
 
-        // Forward substitution
-        // col < row so we are taking the L portion
-        // sol = P*b = L*y, whittle down sol of terms
-        // from the L portion until we can isolate y
-        for (int col = 0; col < row; col++) {
-            sol[row] -= mat[row][col] * sol[col];
+    // Horner's scheme over polynomials: p = p * (a*x + b) + q[k],
+    // where p has len terms so far
+    p[0] = q[terms - 1];
+    size_t len = 1;
+    for (int k = static_cast<int>(terms) - 2; k >= 0; --k) {
+        p[len++] = 0;
+        for (int j = static_cast<int>(len) - 1; j > 0; --j) {
+            p[j] = p[j] * b + p[j - 1] * a;
         }
+
+        p[0] *= b;
+        p[0] += q[k];
     }
+}
 
-    for (int row = mat.rows() - 1; row >= 0; --row) {
-        // Backwards substitution
-        // row < col, so we are taking the U portion
-        // sol = y = U*x, whittle down sol until we can
-        // isolate x -> return
-        for (int col = row + 1; col < mat.columns(); col++) {
-            sol[row] -= mat[row][col] * sol[col];
+static liftoff::polynomial unscale(const std::vector<double> &q, const poly_scale &scale) {
+    liftoff::gmp_arena_scope arena;
+    std::vector<mpf_class> p;
+    unscale(q.data(), q.size(), scale, p);
+
+    liftoff::gmp_heap_scope heap;
+    return liftoff::polynomial{p};
+}
+
+static bool lip_d(const std::vector<std::pair<double, double>> &forced_points, liftoff::polynomial &out) {
+    int n = forced_points.size();
+    if (n == 0) {
+        return false;
+    }
+
+    double min_x = forced_points[0].first;
+    double max_x = min_x;
+    for (const auto &point : forced_points) {
+        min_x = std::min(min_x, point.first);
+        max_x = std::max(max_x, point.first);
+    }
+    poly_scale scale = make_scale(min_x, max_x);
+
+    liftoff::matrix_d m{static_cast<size_t>(n)};
+    std::vector<double> b(n);
+    for (int r = 0; r < n; ++r) {
+        double u = scale.apply(forced_points[r].first);
+        double u_pow = 1;
+        for (int c = 0; c < n; ++c) {
+            m[r][c] = u_pow;
+            u_pow *= u;
         }
 
-        // Since Doolittle gives an identity L portion,
-        // divide by the diagonal for the U portion in order
-        // to determine the solution
-        sol[row] /= mat[row][row];
+        b[r] = forced_points[r].second;
+    }
+
+    std::vector<double> sol;
+    if (!linsolve_d(m, b, sol)) {
+        return false;
     }
 
-    return sol;
+    out = unscale(sol, scale);
+    return true;
 }
 
-static liftoff::polynomial linsolve(liftoff::matrix &m, const liftoff::matrix &b) {
-    std::vector<int> perm;
-    lup(m, perm);
+// Builds the constrained least-squares system given the power sums of the scaled
+// X values, the same system as the GMP path except that the least-squares rows
+// are normalized by the sample count so that they are commensurate with the
+// constraint rows
+static liftoff::matrix_d make_sums_system_d(unsigned int order,
+                                            const std::vector<double> &u_n_sum,
+                                            double n_samples,
+                                            const std::vector<std::pair<double, double>> &forced_points,
+                                            const poly_scale &scale) {
+    unsigned int lsq_bound = order + 1;
+    size_t m_dim = lsq_bound + forced_points.size();
+    liftoff::matrix_d m{m_dim};
+    for (size_t r = 0; r < m_dim; ++r) {
+        for (size_t c = 0; c < m_dim; ++c) {
+            double &cell = m[r][c];
+            if (r < lsq_bound && c < lsq_bound) {
+                cell = u_n_sum[r + c] / n_samples;
+            } else if (r < lsq_bound && c >= lsq_bound) {
+                cell = std::pow(scale.apply(forced_points[c - lsq_bound].first), r) / 2;
+            } else if (r >= lsq_bound && c < lsq_bound) {
+                cell = std::pow(scale.apply(forced_points[r - lsq_bound].first), c);
+            }
+        }
+    }
 
-    return lup_linsolve(m, perm, b);
+    return m;
+}
+
+// Builds the right-hand side of the system of make_sums_system_d() given the Y
+// weighted power sums, reusing the storage of b
+static void make_sums_rhs_d(unsigned int order,
+                            const std::vector<double> &yu_n_sum,
+                            double n_samples,
+                            const std::vector<std::pair<double, double>> &forced_points,
+                            std::vector<double> &b) {
+    unsigned int lsq_bound = order + 1;
+    b.resize(lsq_bound + forced_points.size());
+    for (size_t r = 0; r < b.size(); ++r) {
+        if (r < lsq_bound) {
+            b[r] = yu_n_sum[r] / n_samples;
+        } else {
+            b[r] = forced_points[r - lsq_bound].second;
+        }
+    }
+}
+
+// Solves the constrained least-squares system given the power sums of the scaled X
+// values in double precision, returns false if it is too poorly conditioned
+static bool solve_sums_d(unsigned int order,
+                         const std::vector<double> &u_n_sum,
+                         const std::vector<double> &yu_n_sum,
+                         double n_samples,
+                         const std::vector<std::pair<double, double>> &forced_points,
+                         const poly_scale &scale,
+                         std::vector<double> &sol) {
+    liftoff::matrix_d m = make_sums_system_d(order, u_n_sum, n_samples, forced_points, scale);
+    std::vector<double> b;
+    make_sums_rhs_d(order, yu_n_sum, n_samples, forced_points, b);
+
+    if (!linsolve_d(m, b, sol)) {
+        return false;
+    }
+
+    sol.resize(order + 1);
+    return true;
+}
+
+// Picks the scale of a fit over the given non-empty X values and forced points
+static poly_scale make_fit_scale(const std::vector<double> &x,
+                                 const std::vector<std::pair<double, double>> &forced_points) {
+    auto min_max = std::minmax_element(x.begin(), x.end());
+    double min_x = *min_max.first;
+    double max_x = *min_max.second;
+    for (const auto &point : forced_points) {
+        min_x = std::min(min_x, point.first);
+        max_x = std::max(max_x, point.first);
+    }
+
+    return make_scale(min_x, max_x);
+}
+
+static bool fit_d(unsigned int order,
+                  const std::vector<double> &x,
+                  const std::vector<double> &y,
+                  const std::vector<std::pair<double, double>> &forced_points,
+                  liftoff::thread_pool *pool,
+                  liftoff::polynomial &out) {
+    if (x.empty()) {
+        return false;
+    }
+
+    poly_scale scale = make_fit_scale(x, forced_points);
+
+    // Power sums of the scaled X values, along with the
+    // Y weighted sums for the least-squares portion
+    size_t n_u = 2 * order + 1;
+    std::vector<double> sums(2 * (n_u + order + 1));
+    std::vector<double> chunks;
+    chunked_sums(x.size(), pool, [&](size_t begin, size_t end, double *pairs) {
+        double *yu_pairs = pairs + 2 * n_u;
+        for (size_t i = begin; i < end; ++i) {
+            double u = scale.apply(x[i]);
+            double u_pow = 1;
+            for (size_t k = 0; k < n_u; ++k) {
+                compensated_add(pairs[2 * k], pairs[2 * k + 1], u_pow);
+                if (k <= order) {
+                    compensated_add(yu_pairs[2 * k], yu_pairs[2 * k + 1], u_pow * y[i]);
+                }
+
+                u_pow *= u;
+            }
+        }
+    }, sums, chunks);
+
+    std::vector<double> u_n(n_u);
+    for (size_t k = 0; k < u_n.size(); ++k) {
+        u_n[k] = sums[2 * k] + sums[2 * k + 1];
+    }
+
+    std::vector<double> yu_n(order + 1);
+    for (size_t k = 0; k < yu_n.size(); ++k) {
+        yu_n[k] = sums[2 * (n_u + k)] + sums[2 * (n_u + k) + 1];
+    }
+
+    std::vector<double> sol;
+    if (!solve_sums_d(order, u_n, yu_n, x.size(), forced_points, scale, sol)) {
+        return false;
+    }
+
+    out = unscale(sol, scale);
+    return true;
 }
 
 // https://sameradeeb-new.srv.ualberta.ca/introduction-to-numerical-analysis/polynomial-interpolation/
-liftoff::polynomial liftoff::lip(const std::vector<std::pair<double, double>> &forced_points) {
+static liftoff::polynomial lip_mpf(const std::vector<std::pair<double, double>> &forced_points) {
     unsigned int order = forced_points.size() - 1;
 
+    // The system, its right-hand side and the solution
+    size_t cells = (order + 1) * (order + 3);
+    liftoff::gmp_arena_scope arena{cells * liftoff::mpf_alloc_bytes(REQ_PRECISION)};
+
     liftoff::matrix m{order + 1};
-    for (int r = 0; r <= order; ++r) {
+    for (size_t r = 0; r <= order; ++r) {
         double x = forced_points[r].first;
-        for (int c = 0; c <= order; ++c) {
+        for (size_t c = 0; c <= order; ++c) {
             mpf_class cell{x, REQ_PRECISION};
             mpf_pow_ui(cell.get_mpf_t(), cell.get_mpf_t(), c);
 
@@ -131,97 +412,529 @@ liftoff::polynomial liftoff::lip(const std::vector<std::pair<double, double>> &f
     }
 
     liftoff::matrix b{order + 1, 1};
-    for (int i = 0; i <= order; ++i) {
+    for (size_t i = 0; i <= order; ++i) {
         b[i][0] = forced_points[i].second;
     }
 
-    return linsolve(m, b);
+    liftoff::polynomial sol = linsolve(m, b);
+
+    liftoff::gmp_heap_scope heap;
+    return liftoff::polynomial{sol};
+}
+
+// Sums the powers of the X values from 0 through 2 * order into x_n_sum, unless
+// it is null, and the Y values weighted by the powers from 0 through order into
+// yx_n_sum, in a single pass which only holds the current power. The sums reuse
+// their storage if they are already the right size
+static void make_sums_mpf(unsigned int order,
+                          const std::vector<double> &x,
+                          const std::vector<double> &y,
+                          std::vector<mpf_class> *x_n_sum,
+                          std::vector<mpf_class> &yx_n_sum) {
+    unsigned int max_power = order;
+    if (x_n_sum != nullptr) {
+        max_power = 2 * order;
+        x_n_sum->resize(max_power + 1, mpf_class{0, REQ_PRECISION});
+        for (auto &sum : *x_n_sum) {
+            sum = 0;
+        }
+    }
+
+    yx_n_sum.resize(order + 1, mpf_class{0, REQ_PRECISION});
+    for (auto &sum : yx_n_sum) {
+        sum = 0;
+    }
+
+    mpf_class x_pow{0, REQ_PRECISION};
+    mpf_class term{0, REQ_PRECISION};
+    for (size_t i = 0; i < x.size(); ++i) {
+        x_pow = 1;
+        for (unsigned int r = 0; r <= max_power; ++r) {
+            if (x_n_sum != nullptr) {
+                (*x_n_sum)[r] += x_pow;
+            }
+
+            if (r <= order) {
+                term = x_pow;
+                term *= y[i];
+                yx_n_sum[r] += term;
+            }
+
+            x_pow *= x[i];
+        }
+    }
+}
+
+static liftoff::polynomial fit_mpf(unsigned int order,
+                                   const std::vector<double> &x,
+                                   const std::vector<double> &y,
+                                   const std::vector<std::pair<double, double>> &forced_points) {
+    liftoff::gmp_arena_scope arena;
+
+    std::vector<mpf_class> x_n_sum;
+    std::vector<mpf_class> yx_n_sum;
+    make_sums_mpf(order, x, y, &x_n_sum, yx_n_sum);
+
+    liftoff::kkt_solver kkt;
+    if (!kkt.factor(order, x_n_sum, forced_points)) {
+        throw std::domain_error("the forced points do not determine a fit");
+    }
+
+    std::vector<mpf_class> sol;
+    kkt.solve(yx_n_sum, sol);
+
+    liftoff::gmp_heap_scope heap;
+    return liftoff::polynomial{sol};
+}
+
+liftoff::kkt_solver::kkt_solver() : forced_n(0), normal_forced(0) {
 }
 
 // Adapted from: https://stackoverflow.com/questions/15191088/how-to-do-a-polynomial-fit-with-fixed-points
+//
+// The bordered system is
+//
+//   [ H    F / 2 ] [ a ]   [ b ]
+//   [ F^T  0     ] [ l ] = [ d ]
+//
+// where H holds the power sums x_n_sum[r + c], F the powers of the forced X
+// values, b the Y weighted sums and d the forced Y values. With v = l / 2,
+// a = H^-1 b - H^-1 F v, and substituting into F^T a = d leaves the Schur
+// complement system (F^T H^-1 F) v = F^T H^-1 b - d
+bool liftoff::kkt_solver::factor(unsigned int order,
+                                 const std::vector<mpf_class> &x_n_sum,
+                                 const std::vector<std::pair<double, double>> &forced_points) {
+    terms = order + 1;
+    size_t n_forced = forced_points.size();
+    factored = false;
+    use_bordered = false;
+
+    forced_n = liftoff::matrix{n_forced, terms};
+    forced_y.resize(n_forced);
+    for (size_t j = 0; j < n_forced; ++j) {
+        mpf_class *row = forced_n[j];
+        row[0] = 1;
+        for (size_t c = 1; c < terms; ++c) {
+            row[c] = row[c - 1] * forced_points[j].first;
+        }
+
+        forced_y[j] = forced_points[j].second;
+    }
+
+    // The workspace is created here so that solve() only
+    // assigns to it
+    free_sol.assign(terms, mpf_class{0, REQ_PRECISION});
+    schur_b.assign(n_forced, mpf_class{0, REQ_PRECISION});
+    schur_sol.assign(n_forced, mpf_class{0, REQ_PRECISION});
+
+    liftoff::matrix h{terms};
+    for (size_t r = 0; r < terms; ++r) {
+        for (size_t c = 0; c < terms; ++c) {
+            h[r][c] = x_n_sum[r + c];
+        }
+    }
+
+    if (normal.factor(h)) {
+        normal_forced = liftoff::matrix{n_forced, terms};
+        for (size_t j = 0; j < n_forced; ++j) {
+            normal.solve(forced_n[j], free_sol);
+            std::copy(free_sol.begin(), free_sol.end(), normal_forced[j]);
+        }
+
+        // Only the lower triangle is read
+        liftoff::matrix s{n_forced};
+        for (size_t i = 0; i < n_forced; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                mpf_class &cell = s[i][j];
+                for (size_t c = 0; c < terms; ++c) {
+                    cell += forced_n[i][c] * normal_forced[j][c];
+                }
+            }
+        }
+
+        if (schur.factor(s)) {
+            factored = true;
+            return true;
+        }
+    }
+
+    size_t m_dim = terms + n_forced;
+    liftoff::matrix m{m_dim};
+    for (size_t r = 0; r < m_dim; ++r) {
+        for (size_t c = 0; c < m_dim; ++c) {
+            if (r < terms && c < terms) {
+                m[r][c] = h[r][c];
+            } else if (r < terms && c >= terms) {
+                m[r][c] = forced_n[c - terms][r] / 2;
+            } else if (r >= terms && c < terms) {
+                m[r][c] = forced_n[r - terms][c];
+            }
+        }
+    }
+
+    bordered_b.assign(m_dim, mpf_class{0, REQ_PRECISION});
+    bordered_sol.assign(m_dim, mpf_class{0, REQ_PRECISION});
+    use_bordered = true;
+    factored = bordered.factor(m);
+    return factored;
+}
+
+bool liftoff::kkt_solver::is_factored() const {
+    return factored;
+}
+
+void liftoff::kkt_solver::solve(const std::vector<mpf_class> &yx_n_sum, std::vector<mpf_class> &sol) {
+    if (!factored) {
+        throw std::logic_error("no system has been factored");
+    }
+
+    if (sol.size() != terms) {
+        sol.assign(terms, mpf_class{0, REQ_PRECISION});
+    }
+
+    if (use_bordered) {
+        std::copy(yx_n_sum.begin(), yx_n_sum.begin() + terms, bordered_b.begin());
+        std::copy(forced_y.begin(), forced_y.end(), bordered_b.begin() + terms);
+
+        bordered.solve(bordered_b.data(), bordered_sol);
+        std::copy(bordered_sol.begin(), bordered_sol.begin() + terms, sol.begin());
+        return;
+    }
+
+    normal.solve(yx_n_sum.data(), free_sol);
+    for (size_t j = 0; j < schur_b.size(); ++j) {
+        schur_b[j] = -forced_y[j];
+        for (size_t c = 0; c < terms; ++c) {
+            schur_b[j] += forced_n[j][c] * free_sol[c];
+        }
+    }
+
+    schur.solve(schur_b.data(), schur_sol);
+    for (size_t r = 0; r < terms; ++r) {
+        sol[r] = free_sol[r];
+        for (size_t j = 0; j < schur_sol.size(); ++j) {
+            sol[r] -= normal_forced[j][r] * schur_sol[j];
+        }
+    }
+}
+
+liftoff::polynomial liftoff::lip(const std::vector<std::pair<double, double>> &forced_points) {
+    LIFTOFF_TRACE_SCOPE("lip");
+
+    liftoff::polynomial poly;
+    if (lip_d(forced_points, poly)) {
+        return poly;
+    }
+
+    LIFTOFF_TRACE_COUNT("lip_mpf_fallbacks", 1);
+    return lip_mpf(forced_points);
+}
+
 liftoff::polynomial liftoff::fit(unsigned int order,
                                  const std::vector<double> &x,
                                  const std::vector<double> &y,
-                                 const std::vector<std::pair<double, double>> &forced_points) {
+                                 const std::vector<std::pair<double, double>> &forced_points,
+                                 liftoff::thread_pool *pool) {
+    LIFTOFF_TRACE_SCOPE("fit");
     if (x.size() != y.size()) {
         throw std::invalid_argument("x/y are not the same size");
     }
 
-    liftoff::matrix x_n{2 * order + 1, x.size()};
-    for (int r = 0; r < x_n.rows(); ++r) {
-        for (int c = 0; c < x.size(); ++c) {
-            mpf_class cell{x[c], REQ_PRECISION};
-            mpf_pow_ui(cell.get_mpf_t(), cell.get_mpf_t(), r);
+    liftoff::polynomial poly;
+    if (fit_d(order, x, y, forced_points, pool, poly)) {
+        return poly;
+    }
+
+    LIFTOFF_TRACE_COUNT("fit_mpf_fallbacks", 1);
+    return fit_mpf(order, x, y, forced_points);
+}
 
-            x_n[r][c] = cell;
+liftoff::fit_plan::fit_plan(unsigned int fp_order,
+                            const std::vector<double> &fp_x,
+                            const std::vector<std::pair<double, double>> &fp_forced_points,
+                            liftoff::thread_pool *fp_pool) :
+        order(fp_order), forced_points(fp_forced_points), x(fp_x), pool(fp_pool),
+        yu_n(fp_order + 1), yu_n_sums(2 * (fp_order + 1)) {
+    if (x.empty()) {
+        // fit() falls back to GMP without any samples
+        return;
+    }
+
+    poly_scale scale = make_fit_scale(x, forced_points);
+    centre = scale.centre;
+    half_width = scale.half_width;
+
+    // The power sums in the same chunks and order as
+    // fit_d() so that the systems are identical
+    size_t n_u = 2 * order + 1;
+    std::vector<double> sums(2 * n_u);
+    u.resize(x.size());
+    chunked_sums(x.size(), pool, [&](size_t begin, size_t end, double *pairs) {
+        for (size_t i = begin; i < end; ++i) {
+            u[i] = scale.apply(x[i]);
+
+            double u_pow = 1;
+            for (size_t k = 0; k < n_u; ++k) {
+                compensated_add(pairs[2 * k], pairs[2 * k + 1], u_pow);
+                u_pow *= u[i];
+            }
         }
+    }, sums, chunk_sums);
+
+    std::vector<double> u_n(n_u);
+    for (size_t k = 0; k < u_n.size(); ++k) {
+        u_n[k] = sums[2 * k] + sums[2 * k + 1];
     }
 
-    liftoff::matrix yx_n{2 * order + 1, 1};
-    for (int r = 0; r < order + 1; ++r) {
-        mpf_class sum{0, REQ_PRECISION};
-        for (int c = 0; c < x_n.columns(); ++c) {
-            mpf_class term{x_n[r][c], REQ_PRECISION};
-            term *= y[c];
+    liftoff::matrix_d m = make_sums_system_d(order, u_n, x.size(), forced_points, scale);
+    std::vector<double> e;
+    std::vector<double> inv_col;
+    if (!factor_d(m, lu_d, e, inv_col)) {
+        lu_d = liftoff::lu_factorization<double>{};
+    }
+}
 
-            sum += term;
-        }
+bool liftoff::fit_plan::uses_gmp() const {
+    return !lu_d.is_factored();
+}
 
-        yx_n[r][0] = sum;
+void liftoff::fit_plan::fit(const std::vector<double> &y, liftoff::polynomial &out) {
+    LIFTOFF_TRACE_SCOPE("fit_plan");
+    if (y.size() != x.size()) {
+        throw std::invalid_argument("x/y are not the same size");
     }
 
-    liftoff::matrix x_n_sum{x_n.rows(), 1};
-    for (int r = 0; r < x_n.rows(); ++r) {
-        mpf_class sum{0, REQ_PRECISION};
-        for (int c = 0; c < x_n.columns(); ++c) {
-            sum += x_n[r][c];
+    if (lu_d.is_factored()) {
+        chunked_sums(u.size(), pool, [&](size_t begin, size_t end, double *pairs) {
+            for (size_t i = begin; i < end; ++i) {
+                double u_pow = 1;
+                for (size_t k = 0; k <= order; ++k) {
+                    compensated_add(pairs[2 * k], pairs[2 * k + 1], u_pow * y[i]);
+                    u_pow *= u[i];
+                }
+            }
+        }, yu_n_sums, chunk_sums);
+
+        for (size_t k = 0; k <= order; ++k) {
+            yu_n[k] = yu_n_sums[2 * k] + yu_n_sums[2 * k + 1];
         }
 
-        x_n_sum[r][0] = sum;
+        make_sums_rhs_d(order, yu_n, x.size(), forced_points, b_d);
+        if (solve_factored_d(lu_d, b_d, sol_d)) {
+            // The coefficients outlive the arena, so they are
+            // created before it
+            if (coefficients.size() != order + 1) {
+                coefficients.assign(order + 1, mpf_class{0, REQ_PRECISION});
+            }
+            {
+                liftoff::gmp_arena_scope arena;
+                unscale(sol_d.data(), order + 1, poly_scale{centre, half_width}, coefficients);
+            }
+
+            out.assign(coefficients);
+            return;
+        }
     }
 
-    liftoff::matrix xf_n{order + 1};
-    for (int r = 0; r < order + 1; ++r) {
-        for (int c = 0; c < forced_points.size(); ++c) {
-            mpf_class cell{forced_points[c].first, REQ_PRECISION};
-            mpf_pow_ui(cell.get_mpf_t(), cell.get_mpf_t(), r);
+    LIFTOFF_TRACE_COUNT("fit_mpf_fallbacks", 1);
+    fit_mpf(y, out);
+}
 
-            xf_n[r][c] = cell;
+liftoff::polynomial liftoff::fit_plan::fit(const std::vector<double> &y) {
+    liftoff::polynomial poly;
+    fit(y, poly);
+    return poly;
+}
+
+void liftoff::fit_plan::fit_mpf(const std::vector<double> &y, liftoff::polynomial &out) {
+    if (!kkt_mpf.is_factored()) {
+        // Everything kept by the plan is created outside of
+        // the arena
+        std::vector<mpf_class> x_n_sum;
+        make_sums_mpf(order, x, y, &x_n_sum, yx_n_sum_mpf);
+        if (!kkt_mpf.factor(order, x_n_sum, forced_points)) {
+            throw std::domain_error("the forced points do not determine a fit");
         }
+    } else {
+        liftoff::gmp_arena_scope arena;
+        make_sums_mpf(order, x, y, nullptr, yx_n_sum_mpf);
     }
 
-    unsigned int lsq_bound = order + 1;
-    unsigned int m_dim = lsq_bound + forced_points.size();
-    liftoff::matrix m{m_dim};
-    liftoff::matrix b{m_dim, 1};
+    if (coefficients.size() != order + 1) {
+        coefficients.assign(order + 1, mpf_class{0, REQ_PRECISION});
+    }
+    {
+        liftoff::gmp_arena_scope arena;
+        kkt_mpf.solve(yx_n_sum_mpf, coefficients);
+    }
 
-    for (int r = 0; r < m_dim; ++r) {
-        for (int c = 0; c < m_dim; ++c) {
-            if (r < lsq_bound && c < lsq_bound) {
-                m[r][c] = x_n_sum[r + c][0];
-            } else if (r < lsq_bound && c >= lsq_bound) {
-                mpf_class k2{2, REQ_PRECISION};
-                m[r][c] = xf_n[r][c - lsq_bound] / k2;
-            } else if (r >= lsq_bound && c < lsq_bound) {
-                m[r][c] = xf_n[c][r - lsq_bound];
-            } else {
-                m[r][c] = 0;
-            }
+    out.assign(coefficients);
+}
+
+liftoff::streaming_fit::streaming_fit(unsigned int sf_order, size_t sf_capacity) :
+        order(sf_order), capacity(sf_capacity),
+        u_n_sum(2 * sf_order + 1), u_n_comp(2 * sf_order + 1),
+        yu_n_sum(sf_order + 1), yu_n_comp(sf_order + 1) {
+    if (sf_capacity == 0) {
+        throw std::invalid_argument("the window must hold at least one sample");
+    }
+}
+
+void liftoff::streaming_fit::accumulate(const std::pair<double, double> &sample, double sign) {
+    double u = (sample.first - centre) / half_width;
+    double u_pow = sign;
+    for (size_t k = 0; k < u_n_sum.size(); ++k) {
+        compensated_add(u_n_sum[k], u_n_comp[k], u_pow);
+        if (k <= order) {
+            compensated_add(yu_n_sum[k], yu_n_comp[k], u_pow * sample.second);
         }
 
-        if (r < lsq_bound) {
-            b[r][0] = yx_n[r][0];
-        } else {
-            b[r][0] = forced_points[r - lsq_bound].second;
+        u_pow *= u;
+    }
+}
+
+bool liftoff::streaming_fit::narrow() const {
+    // The oldest sample has moved past the start of the
+    // window plus STREAMING_SLACK of its span since the
+    // scale was picked, whether newer samples pushed it out
+    // or samples were dropped without new ones taking
+    // their place
+    return !window.empty() && window.front().first > front_limit;
+}
+
+void liftoff::streaming_fit::rebuild() {
+    std::fill(u_n_sum.begin(), u_n_sum.end(), 0);
+    std::fill(u_n_comp.begin(), u_n_comp.end(), 0);
+    std::fill(yu_n_sum.begin(), yu_n_sum.end(), 0);
+    std::fill(yu_n_comp.begin(), yu_n_comp.end(), 0);
+    if (window.empty()) {
+        return;
+    }
+
+    // Leave room for the window to move by a fraction of its
+    // length before the scale has to change, which trades
+    // rebuilds for conditioning of the scaled powers
+    double oldest = window.front().first;
+    double span = window.back().first - oldest;
+    poly_scale scale = make_scale(oldest, window.back().first + span * STREAMING_SLACK);
+    centre = scale.centre;
+    half_width = scale.half_width;
+    front_limit = oldest + span * STREAMING_SLACK;
+
+    for (const auto &sample : window) {
+        accumulate(sample, 1);
+    }
+}
+
+void liftoff::streaming_fit::set_forced_points(const std::vector<std::pair<double, double>> &new_forced_points) {
+    forced_points = new_forced_points;
+    dirty = true;
+}
+
+void liftoff::streaming_fit::push(double x, double y) {
+    if (window.size() == capacity) {
+        accumulate(window.front(), -1);
+        window.pop_front();
+    }
+
+    window.emplace_back(x, y);
+    dirty = true;
+
+    if (!(std::abs((x - centre) / half_width) <= 1) || window.size() == 1 || narrow()) {
+        rebuild();
+    } else {
+        accumulate(window.back(), 1);
+    }
+}
+
+void liftoff::streaming_fit::pop() {
+    if (window.empty()) {
+        return;
+    }
+
+    accumulate(window.front(), -1);
+    window.pop_front();
+    dirty = true;
+
+    if (narrow()) {
+        rebuild();
+    }
+}
+
+void liftoff::streaming_fit::clear() {
+    window.clear();
+    rebuild();
+    dirty = true;
+}
+
+size_t liftoff::streaming_fit::size() const {
+    return window.size();
+}
+
+void liftoff::streaming_fit::solve() {
+    if (window.empty()) {
+        throw std::logic_error("cannot fit an empty window");
+    }
+
+    if (!dirty) {
+        return;
+    }
+
+    std::vector<double> u_n(u_n_sum.size());
+    for (size_t k = 0; k < u_n.size(); ++k) {
+        u_n[k] = u_n_sum[k] + u_n_comp[k];
+    }
+
+    std::vector<double> yu_n(yu_n_sum.size());
+    for (size_t k = 0; k < yu_n.size(); ++k) {
+        yu_n[k] = yu_n_sum[k] + yu_n_comp[k];
+    }
+
+    poly_scale scale{centre, half_width};
+    // Expanding the scaled coefficients is left to get_fit()
+    // so that val() stays in double precision
+    if (solve_sums_d(order, u_n, yu_n, window.size(), forced_points, scale, scaled_fit)) {
+        expanded = false;
+    } else {
+        std::vector<double> x;
+        std::vector<double> y;
+        x.reserve(window.size());
+        y.reserve(window.size());
+        for (const auto &sample : window) {
+            x.push_back(sample.first);
+            y.push_back(sample.second);
         }
+
+        scaled_fit.clear();
+        LIFTOFF_TRACE_COUNT("streaming_fit_mpf_fallbacks", 1);
+        fitted = fit_mpf(order, x, y, forced_points);
+        expanded = true;
     }
 
-    liftoff::polynomial sol = linsolve(m, b);
+    dirty = false;
+}
 
-    liftoff::polynomial poly;
-    for (int i = 0; i < order + 1; ++i) {
-        poly.add_term(sol[i]);
+const liftoff::polynomial &liftoff::streaming_fit::get_fit() {
+    solve();
+    if (!expanded) {
+        fitted = unscale(scaled_fit, poly_scale{centre, half_width});
+        expanded = true;
     }
 
-    return poly;
+    return fitted;
+}
+
+double liftoff::streaming_fit::val(double x) {
+    solve();
+    if (scaled_fit.empty()) {
+        return fitted.val(x);
+    }
+
+    double u = (x - centre) / half_width;
+    double y = 0;
+    for (int k = static_cast<int>(scaled_fit.size()) - 1; k >= 0; --k) {
+        y = y * u + scaled_fit[k];
+    }
+
+    return y;
 }
@@ -6,16 +6,26 @@
 #ifndef LIFTOFF_PHYSICS_LINALG_H
 #define LIFTOFF_PHYSICS_LINALG_H
 
+#include <cstddef>
+#include <deque>
+#include <utility>
 #include <vector>
 #include <gmpxx.h>
+#include "matrix.h"
 #include "polynomial.h"
 
 namespace liftoff {
+    class thread_pool;
+
     /**
      * Computes a Laplace interpolating polynomial which
      * forces a polynomial through the given collection of
      * X-Y coordinates.
      *
+     * The system is solved in double precision over the
+     * X values scaled onto [-1, 1] unless it is too poorly
+     * conditioned, in which case it falls back to GMP.
+     *
      * @param forced_points the points which to force the
      * polynomial through
      * @return the resulting polynomial
@@ -27,17 +37,449 @@ namespace liftoff {
      * points and the given points which the resulting
      * polynomial is forced to pass through.
      *
+     * The power sums over the samples are reduced in
+     * chunks of a fixed size, which are spread over the
+     * pool if one is given. The result does not depend on
+     * the pool or its number of threads.
+     *
      * @param order the order of the computed polynomial
      * @param x the X points to perform regression
      * @param y the Y points to perform regression
      * @param forced_points the points which to force the
      * resulting polynomial through
+     * @param pool the pool to sum long legs on, or nullptr
+     * to sum them on the calling thread
      * @return the polynomial regression of the given order
      */
     liftoff::polynomial fit(unsigned int order,
                             const std::vector<double> &x,
                             const std::vector<double> &y,
-                            const std::vector<std::pair<double, double>> &forced_points);
+                            const std::vector<std::pair<double, double>> &forced_points,
+                            liftoff::thread_pool *pool = nullptr);
+
+    /**
+     * @brief Solves the constrained least-squares systems of
+     * fit() using GMP, whose normal equations are Hankel
+     * matrices of the power sums of the X values bordered
+     * by the forced points.
+     *
+     * The normal equations are symmetric positive definite,
+     * so they are factored by LDL^T and the forced points
+     * are eliminated through their Schur complement, rather
+     * than factoring the whole bordered system by LU. That
+     * is only done when either is not positive definite,
+     * e.g. with fewer distinct X values than terms.
+     */
+    class kkt_solver {
+    private:
+        /**
+         * The number of terms of the fitted polynomial.
+         */
+        size_t terms{0};
+        /**
+         * Whether a non-singular system has been factored,
+         * and whether it is the bordered system.
+         */
+        bool factored{false};
+        bool use_bordered{false};
+        /**
+         * The powers of the forced X values, one row for
+         * each forced point, and the forced Y values.
+         */
+        liftoff::matrix forced_n;
+        std::vector<double> forced_y;
+
+        /**
+         * The factored normal equations.
+         */
+        liftoff::ldlt_factorization<mpf_class> normal;
+        /**
+         * The normal equations solved for each row of
+         * forced_n.
+         */
+        liftoff::matrix normal_forced;
+        /**
+         * The factored Schur complement of the normal
+         * equations, forced x forced.
+         */
+        liftoff::ldlt_factorization<mpf_class> schur;
+        /**
+         * The factored bordered system, only used if the
+         * above are not positive definite.
+         */
+        liftoff::lu_factorization<mpf_class> bordered;
+
+        /**
+         * The workspace of solve().
+         */
+        std::vector<mpf_class> free_sol;
+        std::vector<mpf_class> schur_b;
+        std::vector<mpf_class> schur_sol;
+        std::vector<mpf_class> bordered_b;
+        std::vector<mpf_class> bordered_sol;
+
+    public:
+        /**
+         * Creates an empty solver.
+         */
+        kkt_solver();
+
+        /**
+         * Factors the system of a fit, replacing the
+         * previous one.
+         *
+         * @param order the order of the fitted polynomial
+         * @param x_n_sum the sums of the powers of the X
+         * values from 0 through 2 * order
+         * @param forced_points the points which the fit is
+         * forced through
+         * @return false if the system is singular
+         */
+        bool factor(unsigned int order,
+                    const std::vector<mpf_class> &x_n_sum,
+                    const std::vector<std::pair<double, double>> &forced_points);
+
+        /**
+         * Determines whether a non-singular system has been
+         * factored.
+         *
+         * @return true if solve() can be used
+         */
+        bool is_factored() const;
+
+        /**
+         * Solves the factored system for the coefficients
+         * of the fit.
+         *
+         * @param yx_n_sum the sums of the Y values weighted
+         * by the powers of the X values from 0 through order
+         * @param sol the output coefficients, resized to
+         * order + 1
+         */
+        void solve(const std::vector<mpf_class> &yx_n_sum, std::vector<mpf_class> &sol);
+    };
+
+    /**
+     * @brief A polynomial regression over fixed X values
+     * and forced points which is repeated for different Y
+     * values, such as the same leg across dispersions.
+     *
+     * The system only depends on the X values and the
+     * forced points, so it is built, factored and checked
+     * for conditioning once. Each fit then costs
+     * O(n * order) for the right-hand side and a solve of
+     * the factored system, and it reuses the workspace of
+     * the previous fit rather than allocating.
+     *
+     * The results are the same as fit() over the same
+     * points, including the fall back to GMP if the system
+     * is too poorly conditioned.
+     */
+    class fit_plan {
+    private:
+        /**
+         * The order of the fitted polynomial.
+         */
+        unsigned int order;
+        /**
+         * The points which the fits are forced through.
+         */
+        std::vector<std::pair<double, double>> forced_points;
+        /**
+         * The X values of the samples.
+         */
+        std::vector<double> x;
+        /**
+         * The pool which the power sums are spread over, or
+         * nullptr.
+         */
+        liftoff::thread_pool *pool;
+        /**
+         * The X values mapped onto [-1, 1].
+         */
+        std::vector<double> u;
+        /**
+         * The X value mapped onto 0 by the scale.
+         */
+        double centre{0};
+        /**
+         * The distance from the centre mapped onto 1 by the
+         * scale.
+         */
+        double half_width{1};
+
+        /**
+         * The factored double precision system, which is
+         * not factored if it is too poorly conditioned.
+         */
+        liftoff::lu_factorization<double> lu_d;
+        /**
+         * The factored GMP system, which is only factored
+         * once a fit needs it.
+         */
+        liftoff::kkt_solver kkt_mpf;
+
+        /**
+         * The sums of the Y values weighted by the powers of
+         * the scaled X values, and the (sum, compensation)
+         * pairs they are reduced from.
+         */
+        std::vector<double> yu_n;
+        std::vector<double> yu_n_sums;
+        /**
+         * The per-chunk pairs of the power sums, only used
+         * for more than one chunk.
+         */
+        std::vector<double> chunk_sums;
+        /**
+         * The right-hand side and solution of the double
+         * precision system.
+         */
+        std::vector<double> b_d;
+        std::vector<double> sol_d;
+        /**
+         * The right-hand side of the GMP system.
+         */
+        std::vector<mpf_class> yx_n_sum_mpf;
+        /**
+         * The coefficients of the fit in terms of the X
+         * values.
+         */
+        std::vector<mpf_class> coefficients;
+
+        /**
+         * Fits the given Y values using GMP, factoring the
+         * GMP system first if it has not been.
+         *
+         * @param y the Y values
+         * @param out the polynomial to write the fit to
+         */
+        void fit_mpf(const std::vector<double> &y, liftoff::polynomial &out);
+
+    public:
+        /**
+         * Builds and factors the system of the fits.
+         *
+         * @param fp_order the order of the fitted
+         * polynomials
+         * @param fp_x the X values of the samples
+         * @param fp_forced_points the points which the fits
+         * are forced through
+         * @param fp_pool the pool to sum long legs on, see
+         * fit(), which must outlive the plan
+         */
+        fit_plan(unsigned int fp_order,
+                 const std::vector<double> &fp_x,
+                 const std::vector<std::pair<double, double>> &fp_forced_points,
+                 liftoff::thread_pool *fp_pool = nullptr);
+
+        /**
+         * Determines whether the fits are solved using GMP
+         * because the double precision system is too poorly
+         * conditioned.
+         *
+         * @return true if the fits are slow
+         */
+        bool uses_gmp() const;
+
+        /**
+         * Fits the given Y values.
+         *
+         * @param y the Y values, one for each X value
+         * @param out the polynomial to write the fit to,
+         * whose storage is reused
+         */
+        void fit(const std::vector<double> &y, liftoff::polynomial &out);
+
+        /**
+         * Fits the given Y values.
+         *
+         * @param y the Y values, one for each X value
+         * @return the polynomial regression
+         */
+        liftoff::polynomial fit(const std::vector<double> &y);
+    };
+
+    /**
+     * @brief Polynomial regression over a sliding window of
+     * samples which is updated as samples arrive instead of
+     * being recomputed from every sample.
+     *
+     * The window keeps running power sums of its X values,
+     * so pushing a sample and dropping the oldest one costs
+     * O(order). Solving the fit costs O((order + forced)^3)
+     * and is only done when the fit is requested after the
+     * window changed.
+     *
+     * The sums are kept over X values scaled onto [-1, 1],
+     * with room for the window to move by a quarter of its
+     * length. Once it has, or a sample falls outside of that
+     * range, the sums are rebuilt from the window with a new
+     * scale. This happens a few times per window length and
+     * so adds O(order) per sample on average.
+     *
+     * The fit is the same as fit() over the samples in the
+     * window, including the fall back to GMP if the system
+     * is too poorly conditioned.
+     */
+    class streaming_fit {
+    private:
+        /**
+         * The order of the fitted polynomial.
+         */
+        unsigned int order;
+        /**
+         * The most samples that the window holds.
+         */
+        size_t capacity;
+        /**
+         * The X-Y samples in the window, oldest first.
+         */
+        std::deque<std::pair<double, double>> window;
+        /**
+         * The points which the fit is forced through.
+         */
+        std::vector<std::pair<double, double>> forced_points;
+
+        /**
+         * The X value mapped onto 0 by the scale.
+         */
+        double centre{0};
+        /**
+         * The distance from the centre mapped onto 1 by the
+         * scale.
+         */
+        double half_width{1};
+        /**
+         * The X value which the oldest sample may reach
+         * before the scale is picked again.
+         */
+        double front_limit{0};
+        /**
+         * The sums of the powers up to 2 * order of the
+         * scaled X values and their compensations.
+         */
+        std::vector<double> u_n_sum;
+        std::vector<double> u_n_comp;
+        /**
+         * The sums of the Y values weighted by the powers up
+         * to order of the scaled X values and their
+         * compensations.
+         */
+        std::vector<double> yu_n_sum;
+        std::vector<double> yu_n_comp;
+
+        /**
+         * Whether the fit needs to be solved again.
+         */
+        bool dirty{true};
+        /**
+         * The coefficients of the fit in terms of the scaled
+         * X values, empty if it fell back to GMP.
+         */
+        std::vector<double> scaled_fit;
+        /**
+         * The fit in terms of the X values.
+         */
+        liftoff::polynomial fitted;
+        /**
+         * Whether the fit has been expanded into the X values
+         * since it was last solved.
+         */
+        bool expanded{false};
+
+        /**
+         * Adds the given sample to the power sums with the
+         * given sign.
+         *
+         * @param sample the sample
+         * @param sign 1 to add the sample, -1 to remove it
+         */
+        void accumulate(const std::pair<double, double> &sample, double sign);
+
+        /**
+         * Checks whether the window has moved away from the
+         * lower end of the scale, which leaves the scaled
+         * powers poorly conditioned.
+         *
+         * @return true if the sums should be rebuilt
+         */
+        bool narrow() const;
+
+        /**
+         * Picks a scale around the newest sample and
+         * recomputes the power sums over the window.
+         */
+        void rebuild();
+
+        /**
+         * Solves the fit if the window or the forced points
+         * have changed since it was last solved.
+         */
+        void solve();
+
+    public:
+        /**
+         * Creates an empty window.
+         *
+         * @param sf_order the order of the fitted polynomial
+         * @param sf_capacity the most samples in the window,
+         * after which pushing a sample drops the oldest
+         */
+        streaming_fit(unsigned int sf_order, size_t sf_capacity);
+
+        /**
+         * Sets the points which the fit is forced through.
+         *
+         * @param new_forced_points the forced points
+         */
+        void set_forced_points(const std::vector<std::pair<double, double>> &new_forced_points);
+
+        /**
+         * Adds a sample to the window, dropping the oldest
+         * sample if the window is full.
+         *
+         * @param x the X value of the sample
+         * @param y the Y value of the sample
+         */
+        void push(double x, double y);
+
+        /**
+         * Drops the oldest sample from the window, if any.
+         */
+        void pop();
+
+        /**
+         * Drops every sample from the window.
+         */
+        void clear();
+
+        /**
+         * Obtains the number of samples in the window.
+         *
+         * @return the sample count
+         */
+        size_t size() const;
+
+        /**
+         * Obtains the fit of the samples in the window.
+         *
+         * @return the polynomial regression of the window
+         * @throws std::logic_error if the window is empty
+         */
+        const liftoff::polynomial &get_fit();
+
+        /**
+         * Evaluates the fit of the samples in the window at
+         * the given X value without expanding the scaled
+         * coefficients.
+         *
+         * @param x the X value
+         * @return the fitted Y value
+         * @throws std::logic_error if the window is empty
+         */
+        double val(double x);
+    };
 }
 
 #endif // LIFTOFF_PHYSICS_LINALG_H
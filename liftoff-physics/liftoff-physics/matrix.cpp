@@ -1,54 +1,161 @@
 #include "matrix.h"
 
+#include <algorithm>
+#include <cmath>
+
 // Required precision for floating point values in order to perform the necessary polynomial
 // regressions
 // (pretty sure this is actually around 80, but 256 just to be safe :>)
 static const int REQ_PRECISION = 256;
 
-liftoff::matrix::matrix(size_t size) : liftoff::matrix(size, size) {
+template<typename T>
+static T zero_cell() {
+    return T(0);
 }
 
-liftoff::matrix::matrix(size_t rows, size_t columns) {
-    cells.reserve(rows);
-    for (int r = 0; r < rows; ++r) {
-        std::vector<mpf_class> row;
-        row.reserve(columns);
+template<>
+mpf_class zero_cell<mpf_class>() {
+    return mpf_class{0, REQ_PRECISION};
+}
 
-        for (int c = 0; c < columns; ++c) {
-            row.emplace_back(0, REQ_PRECISION);
-        }
+static double to_double(const mpf_class &value) {
+    return value.get_d();
+}
+
+static double to_double(long double value) {
+    return static_cast<double>(value);
+}
+
+static double to_double(double value) {
+    return value;
+}
+
+template<typename T>
+liftoff::basic_matrix_view<T>::basic_matrix_view(T *view_origin, size_t rows, size_t columns,
+                                                 size_t row_stride, size_t col_stride) :
+        origin(view_origin), n_rows(rows), n_columns(columns), r_stride(row_stride), c_stride(col_stride) {
+}
+
+template<typename T>
+size_t liftoff::basic_matrix_view<T>::rows() const {
+    return n_rows;
+}
+
+template<typename T>
+size_t liftoff::basic_matrix_view<T>::columns() const {
+    return n_columns;
+}
+
+template<typename T>
+size_t liftoff::basic_matrix_view<T>::row_stride() const {
+    return r_stride;
+}
+
+template<typename T>
+size_t liftoff::basic_matrix_view<T>::col_stride() const {
+    return c_stride;
+}
+
+template<typename T>
+T &liftoff::basic_matrix_view<T>::operator()(size_t row, size_t column) const {
+    return origin[row * r_stride + column * c_stride];
+}
+
+template<typename T>
+liftoff::basic_matrix<T>::basic_matrix(size_t size) : liftoff::basic_matrix<T>(size, size) {
+}
+
+// mpf_class copies keep the precision of the source, so every
+// cell ends up with REQ_PRECISION
+template<typename T>
+liftoff::basic_matrix<T>::basic_matrix(size_t rows, size_t columns) :
+        n_rows(rows), n_columns(columns), cells(rows * columns, zero_cell<T>()) {
+}
+
+template<typename T>
+unsigned int liftoff::basic_matrix<T>::rows() const {
+    return n_rows;
+}
+
+template<typename T>
+unsigned int liftoff::basic_matrix<T>::columns() const {
+    return n_columns;
+}
+
+template<typename T>
+T *liftoff::basic_matrix<T>::operator[](size_t row) {
+    return cells.data() + row * n_columns;
+}
 
-        cells.push_back(row);
+template<typename T>
+const T *liftoff::basic_matrix<T>::operator[](size_t row) const {
+    return cells.data() + row * n_columns;
+}
+
+template<typename T>
+T *liftoff::basic_matrix<T>::data() {
+    return cells.data();
+}
+
+template<typename T>
+const T *liftoff::basic_matrix<T>::data() const {
+    return cells.data();
+}
+
+template<typename T>
+void liftoff::basic_matrix<T>::swap_rows(size_t a, size_t b) {
+    if (a == b) {
+        return;
     }
+
+    T *row_a = (*this)[a];
+    std::swap_ranges(row_a, row_a + n_columns, (*this)[b]);
 }
 
-unsigned int liftoff::matrix::rows() const {
-    return cells.size();
+template<typename T>
+liftoff::basic_matrix_view<T> liftoff::basic_matrix<T>::row_view(size_t row) {
+    return submatrix(row, 0, 1, n_columns);
 }
 
-unsigned int liftoff::matrix::columns() const {
-    return cells[0].size();
+template<typename T>
+liftoff::basic_matrix_view<const T> liftoff::basic_matrix<T>::row_view(size_t row) const {
+    return submatrix(row, 0, 1, n_columns);
 }
 
-std::vector<std::vector<mpf_class>>::reference &liftoff::matrix::operator[](size_t row) {
-    return cells[row];
+template<typename T>
+liftoff::basic_matrix_view<T> liftoff::basic_matrix<T>::col_view(size_t column) {
+    return submatrix(0, column, n_rows, 1);
 }
 
-const std::vector<mpf_class> &liftoff::matrix::operator[](size_t row) const {
-    return cells[row];
+template<typename T>
+liftoff::basic_matrix_view<const T> liftoff::basic_matrix<T>::col_view(size_t column) const {
+    return submatrix(0, column, n_rows, 1);
 }
 
-std::string liftoff::matrix::to_matlab() const {
-    unsigned long rows = cells.size();
+template<typename T>
+liftoff::basic_matrix_view<T> liftoff::basic_matrix<T>::submatrix(size_t row, size_t column,
+                                                                  size_t rows, size_t columns) {
+    return {(*this)[row] + column, rows, columns, n_columns, 1};
+}
+
+template<typename T>
+liftoff::basic_matrix_view<const T> liftoff::basic_matrix<T>::submatrix(size_t row, size_t column,
+                                                                        size_t rows, size_t columns) const {
+    return {(*this)[row] + column, rows, columns, n_columns, 1};
+}
+
+template<typename T>
+std::string liftoff::basic_matrix<T>::to_matlab() const {
+    unsigned long rows = n_rows;
     std::string result;
     if (rows > 1) {
         result += "[";
     }
 
-    for (int r = 0; r < rows; ++r) {
+    for (size_t r = 0; r < rows; ++r) {
         result += "[";
-        for (int c = 0; c < columns(); ++c) {
-            result += std::to_string(cells[r][c].get_d());
+        for (size_t c = 0; c < columns(); ++c) {
+            result += std::to_string(to_double((*this)[r][c]));
             result += " ";
         }
         result += "]";
@@ -64,3 +171,253 @@ std::string liftoff::matrix::to_matlab() const {
 
     return result;
 }
+
+// Doolittle LU decomposition with partial pivot (L is the identity diagonal)
+// Adapted from: https://en.wikipedia.org/wiki/LU_decomposition#C_code_examples
+// Adapted from: https://www.codewithc.com/lu-decomposition-algorithm-flowchart/
+//
+// Right-looking elimination so the innermost loop walks a single row of the
+// contiguous buffer, which can be vectorized for the hardware types
+template<typename T>
+int liftoff::lup(liftoff::basic_matrix<T> &mat, std::vector<int> &perm) {
+    using std::abs;
+
+    int n = mat.rows();
+    int pivot_count = 0;
+
+    // Each element of the permutation vector represents a row of the permutation matrix
+    // The integer is the index on that row at which the 1 is located
+    perm.resize(n);
+    for (int i = 0; i < n; ++i) {
+        perm[i] = i;
+    }
+
+    for (int k = 0; k < n; ++k) {
+        // Find the greatest magnitude cell in the current column
+        int max_row = k;
+        T max_cell = abs(mat[k][k]);
+        for (int r = k + 1; r < n; ++r) {
+            T cell_mag = abs(mat[r][k]);
+            if (max_cell < cell_mag) {
+                max_cell = cell_mag;
+                max_row = r;
+            }
+        }
+
+        if (max_cell == 0) {
+            return -1;
+        }
+
+        // max_row has the greatest magnitude, swap into this row
+        if (max_row != k) {
+            mat.swap_rows(k, max_row);
+            std::swap(perm[k], perm[max_row]);
+
+            ++pivot_count;
+        }
+
+        // Whittle down the rows below so that only the U portion
+        // remains, storing the L multiplier in the eliminated cell
+        const T *pivot_row = mat[k];
+        for (int r = k + 1; r < n; ++r) {
+            T *row = mat[r];
+            row[k] /= pivot_row[k];
+
+            const T &l = row[k];
+            for (int c = k + 1; c < n; ++c) {
+                row[c] -= l * pivot_row[c];
+            }
+        }
+    }
+
+    return pivot_count;
+}
+
+// Doolittle LU decomposition forward/backward substitution linear solver function
+// Adapted from: https://en.wikipedia.org/wiki/LU_decomposition#C_code_examples
+template<typename T>
+void liftoff::lup_linsolve(const liftoff::basic_matrix<T> &lu, const std::vector<int> &perm, const T *b,
+                           std::vector<T> &sol) {
+    int n = lu.rows();
+    sol.resize(n, zero_cell<T>());
+
+    for (int row = 0; row < n; ++row) {
+        // sol = P*b
+        sol[row] = b[perm[row]];
+
+        // Forward substitution
+        // col < row so we are taking the L portion
+        // sol = P*b = L*y, whittle down sol of terms
+        // from the L portion until we can isolate y
+        const T *lu_row = lu[row];
+        for (int col = 0; col < row; col++) {
+            sol[row] -= lu_row[col] * sol[col];
+        }
+    }
+
+    for (int row = n - 1; row >= 0; --row) {
+        // Backwards substitution
+        // row < col, so we are taking the U portion
+        // sol = y = U*x, whittle down sol until we can
+        // isolate x -> return
+        const T *lu_row = lu[row];
+        for (int col = row + 1; col < n; col++) {
+            sol[row] -= lu_row[col] * sol[col];
+        }
+
+        // Since Doolittle gives an identity L portion,
+        // divide by the diagonal for the U portion in order
+        // to determine the solution
+        sol[row] /= lu_row[row];
+    }
+}
+
+template<typename T>
+liftoff::lu_factorization<T>::lu_factorization() : lu(0) {
+}
+
+template<typename T>
+bool liftoff::lu_factorization<T>::factor(const liftoff::basic_matrix<T> &mat) {
+    // Assigning a matrix of the same size reuses the cells
+    lu = mat;
+    swaps = liftoff::lup(lu, perm);
+    return swaps >= 0;
+}
+
+template<typename T>
+bool liftoff::lu_factorization<T>::is_factored() const {
+    return swaps >= 0;
+}
+
+template<typename T>
+size_t liftoff::lu_factorization<T>::size() const {
+    return lu.rows();
+}
+
+template<typename T>
+int liftoff::lu_factorization<T>::get_swaps() const {
+    return swaps;
+}
+
+template<typename T>
+void liftoff::lu_factorization<T>::solve(const T *b, std::vector<T> &sol) const {
+    liftoff::lup_linsolve(lu, perm, b, sol);
+}
+
+template<typename T>
+const liftoff::basic_matrix<T> &liftoff::lu_factorization<T>::get_lu() const {
+    return lu;
+}
+
+template<typename T>
+const std::vector<int> &liftoff::lu_factorization<T>::get_perm() const {
+    return perm;
+}
+
+template<typename T>
+liftoff::ldlt_factorization<T>::ldlt_factorization() : ld(0) {
+}
+
+// Row by row, each L cell is the matching cell of the matrix less the products
+// of the L cells already found on both rows, over the D between them
+template<typename T>
+bool liftoff::ldlt_factorization<T>::factor(const liftoff::basic_matrix<T> &mat) {
+    // Assigning a matrix of the same size reuses the cells
+    ld = mat;
+    factored = false;
+
+    int n = ld.rows();
+    for (int i = 0; i < n; ++i) {
+        T *row_i = ld[i];
+        for (int j = 0; j <= i; ++j) {
+            const T *row_j = ld[j];
+            for (int k = 0; k < j; ++k) {
+                row_i[j] -= row_i[k] * row_j[k] * ld[k][k];
+            }
+
+            if (j < i) {
+                row_i[j] /= row_j[j];
+            }
+        }
+
+        if (!(row_i[i] > 0)) {
+            return false;
+        }
+    }
+
+    factored = true;
+    return true;
+}
+
+template<typename T>
+bool liftoff::ldlt_factorization<T>::is_factored() const {
+    return factored;
+}
+
+template<typename T>
+size_t liftoff::ldlt_factorization<T>::size() const {
+    return ld.rows();
+}
+
+template<typename T>
+void liftoff::ldlt_factorization<T>::solve(const T *b, std::vector<T> &sol) const {
+    int n = ld.rows();
+    sol.resize(n, zero_cell<T>());
+
+    // Forward substitution through L, then D
+    for (int row = 0; row < n; ++row) {
+        sol[row] = b[row];
+
+        const T *ld_row = ld[row];
+        for (int col = 0; col < row; ++col) {
+            sol[row] -= ld_row[col] * sol[col];
+        }
+    }
+
+    for (int row = 0; row < n; ++row) {
+        sol[row] /= ld[row][row];
+    }
+
+    // Backward substitution through L^T, which walks the
+    // columns of L
+    for (int row = n - 1; row >= 0; --row) {
+        for (int col = row + 1; col < n; ++col) {
+            sol[row] -= ld[col][row] * sol[col];
+        }
+    }
+}
+
+template<typename T>
+const liftoff::basic_matrix<T> &liftoff::ldlt_factorization<T>::get_ld() const {
+    return ld;
+}
+
+template class liftoff::basic_matrix_view<mpf_class>;
+template class liftoff::basic_matrix_view<const mpf_class>;
+template class liftoff::basic_matrix_view<double>;
+template class liftoff::basic_matrix_view<const double>;
+template class liftoff::basic_matrix_view<long double>;
+template class liftoff::basic_matrix_view<const long double>;
+
+template class liftoff::basic_matrix<mpf_class>;
+template class liftoff::basic_matrix<double>;
+template class liftoff::basic_matrix<long double>;
+
+template class liftoff::lu_factorization<mpf_class>;
+template class liftoff::lu_factorization<double>;
+template class liftoff::lu_factorization<long double>;
+
+template class liftoff::ldlt_factorization<mpf_class>;
+template class liftoff::ldlt_factorization<double>;
+template class liftoff::ldlt_factorization<long double>;
+
+template int liftoff::lup(liftoff::basic_matrix<mpf_class> &, std::vector<int> &);
+template int liftoff::lup(liftoff::basic_matrix<double> &, std::vector<int> &);
+template int liftoff::lup(liftoff::basic_matrix<long double> &, std::vector<int> &);
+
+template void liftoff::lup_linsolve(const liftoff::basic_matrix<mpf_class> &, const std::vector<int> &,
+                                    const mpf_class *, std::vector<mpf_class> &);
+template void liftoff::lup_linsolve(const liftoff::basic_matrix<double> &, const std::vector<int> &,
+                                    const double *, std::vector<double> &);
+template void liftoff::lup_linsolve(const liftoff::basic_matrix<long double> &, const std::vector<int> &,
+                                    const long double *, std::vector<long double> &);
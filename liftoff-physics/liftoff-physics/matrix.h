@@ -6,20 +6,122 @@
 #define LIFTOFF_PHYSICS_MATRIX_H
 
 #include <gmpxx.h>
+#include <string>
 #include <vector>
 
 namespace liftoff {
     /**
-     * @brief Represents a matrix of values consisting of
-     * GNU Multiprecision Library values.
+     * @brief Represents a strided, non-owning window into
+     * the cells of a basic_matrix.
+     *
+     * @tparam T the cell type, const-qualified for a
+     * read-only view
      */
-    class matrix {
+    template<typename T>
+    class basic_matrix_view {
     private:
         /**
-         * A dense matrix of cells organized by rows
-         * and then columns.
+         * Pointer to the first cell in the view.
          */
-        std::vector<std::vector<mpf_class>> cells;
+        T *origin;
+        /**
+         * The number of rows in the view.
+         */
+        size_t n_rows;
+        /**
+         * The number of columns in the view.
+         */
+        size_t n_columns;
+        /**
+         * The distance in cells between two consecutive
+         * rows.
+         */
+        size_t r_stride;
+        /**
+         * The distance in cells between two consecutive
+         * columns.
+         */
+        size_t c_stride;
+
+    public:
+        /**
+         * Creates a new view over the given cells.
+         *
+         * @param view_origin the first cell in the view
+         * @param rows the number of rows
+         * @param columns the number of columns
+         * @param row_stride the number of cells between
+         * consecutive rows
+         * @param col_stride the number of cells between
+         * consecutive columns
+         */
+        basic_matrix_view(T *view_origin, size_t rows, size_t columns, size_t row_stride, size_t col_stride);
+
+        /**
+         * Determines the number of rows in this view.
+         *
+         * @return the number of rows
+         */
+        size_t rows() const;
+
+        /**
+         * Determines the number of columns in this view.
+         *
+         * @return the number of columns
+         */
+        size_t columns() const;
+
+        /**
+         * Obtains the distance in cells between two
+         * consecutive rows.
+         *
+         * @return the row stride
+         */
+        size_t row_stride() const;
+
+        /**
+         * Obtains the distance in cells between two
+         * consecutive columns.
+         *
+         * @return the column stride
+         */
+        size_t col_stride() const;
+
+        /**
+         * Cell access operator.
+         *
+         * @param row the row index in this view
+         * @param column the column index in this view
+         * @return the reference to the cell
+         */
+        T &operator()(size_t row, size_t column) const;
+    };
+
+    /**
+     * @brief Represents a dense matrix of values stored
+     * contiguously in row-major order.
+     *
+     * Instantiated for GNU Multiprecision Library values,
+     * double and long double.
+     *
+     * @tparam T the cell type
+     */
+    template<typename T>
+    class basic_matrix {
+    private:
+        /**
+         * The number of rows in this matrix.
+         */
+        size_t n_rows;
+        /**
+         * The number of columns in this matrix.
+         */
+        size_t n_columns;
+        /**
+         * The cells organized by rows and then columns in
+         * a single buffer.
+         */
+        std::vector<T> cells;
 
     public:
         /**
@@ -29,7 +131,7 @@ namespace liftoff {
          * @param size the number of rows and columns for
          * this matrix
          */
-        explicit matrix(size_t size);
+        explicit basic_matrix(size_t size);
 
         /**
          * Creates a new matrix with the given number of
@@ -38,7 +140,7 @@ namespace liftoff {
          * @param rows the number of rows
          * @param columns the number of columns
          */
-        matrix(size_t rows, size_t columns);
+        basic_matrix(size_t rows, size_t columns);
 
         /**
          * Determines the number of rows in this matrix.
@@ -59,18 +161,97 @@ namespace liftoff {
          * syntax.
          *
          * @param row the row index to obtain
-         * @return the reference to the row
+         * @return the pointer to the first cell of the row
          */
-        std::vector<std::vector<mpf_class>>::reference &operator[](size_t row);
+        T *operator[](size_t row);
 
         /**
          * Const row access operator using the array
          * bracket syntax.
          *
          * @param row the row to access
-         * @return a const reference to the row
+         * @return a const pointer to the first cell of the
+         * row
+         */
+        const T *operator[](size_t row) const;
+
+        /**
+         * Obtains the underlying row-major buffer.
+         *
+         * @return the pointer to the first cell
+         */
+        T *data();
+
+        /**
+         * Obtains the underlying row-major buffer.
+         *
+         * @return the const pointer to the first cell
+         */
+        const T *data() const;
+
+        /**
+         * Swaps the contents of the two given rows.
+         *
+         * @param a the first row index
+         * @param b the second row index
+         */
+        void swap_rows(size_t a, size_t b);
+
+        /**
+         * Obtains a view of the given row.
+         *
+         * @param row the row index
+         * @return a 1 x columns() view
+         */
+        basic_matrix_view<T> row_view(size_t row);
+
+        /**
+         * Obtains a read-only view of the given row.
+         *
+         * @param row the row index
+         * @return a 1 x columns() view
+         */
+        basic_matrix_view<const T> row_view(size_t row) const;
+
+        /**
+         * Obtains a view of the given column.
+         *
+         * @param column the column index
+         * @return a rows() x 1 view
+         */
+        basic_matrix_view<T> col_view(size_t column);
+
+        /**
+         * Obtains a read-only view of the given column.
+         *
+         * @param column the column index
+         * @return a rows() x 1 view
+         */
+        basic_matrix_view<const T> col_view(size_t column) const;
+
+        /**
+         * Obtains a view of the block of cells starting
+         * at the given row and column.
+         *
+         * @param row the first row of the block
+         * @param column the first column of the block
+         * @param rows the number of rows in the block
+         * @param columns the number of columns in the block
+         * @return the view of the block
+         */
+        basic_matrix_view<T> submatrix(size_t row, size_t column, size_t rows, size_t columns);
+
+        /**
+         * Obtains a read-only view of the block of cells
+         * starting at the given row and column.
+         *
+         * @param row the first row of the block
+         * @param column the first column of the block
+         * @param rows the number of rows in the block
+         * @param columns the number of columns in the block
+         * @return the view of the block
          */
-        const std::vector<mpf_class> &operator[](size_t row) const;
+        basic_matrix_view<const T> submatrix(size_t row, size_t column, size_t rows, size_t columns) const;
 
         /**
          * Obtains the string format of the data in this
@@ -81,6 +262,229 @@ namespace liftoff {
          */
         std::string to_matlab() const;
     };
+
+    /**
+     * A matrix of GNU Multiprecision Library values.
+     */
+    typedef basic_matrix<mpf_class> matrix;
+    /**
+     * A matrix of hardware double values.
+     */
+    typedef basic_matrix<double> matrix_d;
+    /**
+     * A matrix of hardware long double values.
+     */
+    typedef basic_matrix<long double> matrix_ld;
+
+    /**
+     * Performs a Doolittle LU decomposition with partial
+     * pivoting of the given square matrix in place. The
+     * resulting matrix holds the unit-diagonal L below the
+     * diagonal and U on and above it.
+     *
+     * @param mat the matrix to factor
+     * @param perm the output row permutation, where each
+     * element is the source row of that row of the result
+     * @return the number of row swaps, or -1 if the matrix
+     * is singular
+     */
+    template<typename T>
+    int lup(basic_matrix<T> &mat, std::vector<int> &perm);
+
+    /**
+     * Solves the system factored by lup() for the given
+     * right-hand side using forward and backward
+     * substitution.
+     *
+     * @param lu the factored matrix
+     * @param perm the row permutation produced by lup()
+     * @param b the right-hand side, rows() values
+     * @param sol the output solution, resized to rows()
+     */
+    template<typename T>
+    void lup_linsolve(const basic_matrix<T> &lu, const std::vector<int> &perm, const T *b, std::vector<T> &sol);
+
+    /**
+     * @brief The LU decomposition of a square matrix, which
+     * is computed once and then solved against any number
+     * of right-hand sides.
+     *
+     * The storage is kept when another matrix of the same
+     * size is factored, so refactoring and solving do not
+     * allocate for the hardware types.
+     */
+    template<typename T>
+    class lu_factorization {
+    private:
+        /**
+         * The factored matrix as produced by lup().
+         */
+        basic_matrix<T> lu;
+        /**
+         * The row permutation produced by lup().
+         */
+        std::vector<int> perm;
+        /**
+         * The number of row swaps, or -1 if nothing has
+         * been factored or the matrix was singular.
+         */
+        int swaps{-1};
+
+    public:
+        /**
+         * Creates an empty factorization.
+         */
+        lu_factorization();
+
+        /**
+         * Factors a copy of the given square matrix,
+         * replacing the previous factorization.
+         *
+         * @param mat the matrix to factor
+         * @return false if the matrix is singular
+         */
+        bool factor(const basic_matrix<T> &mat);
+
+        /**
+         * Determines whether a non-singular matrix has been
+         * factored.
+         *
+         * @return true if solve() can be used
+         */
+        bool is_factored() const;
+
+        /**
+         * Obtains the number of rows of the factored
+         * matrix.
+         *
+         * @return the size of the system
+         */
+        size_t size() const;
+
+        /**
+         * Obtains the number of row swaps done while
+         * factoring, whose parity is the sign of the
+         * determinant.
+         *
+         * @return the row swap count
+         */
+        int get_swaps() const;
+
+        /**
+         * Solves the factored system for the given
+         * right-hand side.
+         *
+         * @param b the right-hand side, size() values
+         * @param sol the output solution, resized to size()
+         */
+        void solve(const T *b, std::vector<T> &sol) const;
+
+        /**
+         * Obtains the factored matrix, see lup().
+         *
+         * @return the L and U portions
+         */
+        const basic_matrix<T> &get_lu() const;
+
+        /**
+         * Obtains the row permutation, see lup().
+         *
+         * @return the source row of each row
+         */
+        const std::vector<int> &get_perm() const;
+    };
+
+    /**
+     * @brief The LDL^T decomposition of a symmetric positive
+     * definite matrix, which needs neither pivoting nor
+     * square roots and takes half the work of
+     * lu_factorization.
+     *
+     * Only the lower triangle of the matrix is read. The
+     * storage is kept when another matrix of the same size
+     * is factored.
+     */
+    template<typename T>
+    class ldlt_factorization {
+    private:
+        /**
+         * The unit-diagonal L below the diagonal and D on
+         * it.
+         */
+        basic_matrix<T> ld;
+        /**
+         * Whether a positive definite matrix has been
+         * factored.
+         */
+        bool factored{false};
+
+    public:
+        /**
+         * Creates an empty factorization.
+         */
+        ldlt_factorization();
+
+        /**
+         * Factors a copy of the given symmetric matrix,
+         * replacing the previous factorization.
+         *
+         * @param mat the matrix to factor
+         * @return false if the matrix is not positive
+         * definite
+         */
+        bool factor(const basic_matrix<T> &mat);
+
+        /**
+         * Determines whether a positive definite matrix has
+         * been factored.
+         *
+         * @return true if solve() can be used
+         */
+        bool is_factored() const;
+
+        /**
+         * Obtains the number of rows of the factored
+         * matrix.
+         *
+         * @return the size of the system
+         */
+        size_t size() const;
+
+        /**
+         * Solves the factored system for the given
+         * right-hand side.
+         *
+         * @param b the right-hand side, size() values
+         * @param sol the output solution, resized to size()
+         */
+        void solve(const T *b, std::vector<T> &sol) const;
+
+        /**
+         * Obtains the factored matrix.
+         *
+         * @return the L and D portions
+         */
+        const basic_matrix<T> &get_ld() const;
+    };
+
+    extern template class basic_matrix_view<mpf_class>;
+    extern template class basic_matrix_view<const mpf_class>;
+    extern template class basic_matrix_view<double>;
+    extern template class basic_matrix_view<const double>;
+    extern template class basic_matrix_view<long double>;
+    extern template class basic_matrix_view<const long double>;
+
+    extern template class basic_matrix<mpf_class>;
+    extern template class basic_matrix<double>;
+    extern template class basic_matrix<long double>;
+
+    extern template class lu_factorization<mpf_class>;
+    extern template class lu_factorization<double>;
+    extern template class lu_factorization<long double>;
+
+    extern template class ldlt_factorization<mpf_class>;
+    extern template class ldlt_factorization<double>;
+    extern template class ldlt_factorization<long double>;
 }
 
 #endif // LIFTOFF_PHYSICS_MATRIX_H
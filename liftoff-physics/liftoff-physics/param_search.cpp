@@ -0,0 +1,204 @@
+#include "param_search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "thread_pool.h"
+#include "trace.h"
+
+// The reflection, expansion, contraction and shrink coefficients of the simplex
+static const double NM_REFLECT = 1;
+static const double NM_EXPAND = 2;
+static const double NM_CONTRACT = 0.5;
+static const double NM_SHRINK = 0.5;
+
+namespace {
+    /**
+     * @brief A vertex of the simplex.
+     */
+    struct vertex {
+        std::vector<double> x;
+        double cost;
+    };
+}
+
+// Evaluates the objective on every candidate with the same bound, in parallel if there is a pool
+static void evaluate(const liftoff::objective_fn &objective, std::vector<vertex> &candidates, double bound,
+                     liftoff::thread_pool *pool) {
+    if (pool == nullptr) {
+        for (vertex &v : candidates) {
+            v.cost = objective(v.x, bound);
+        }
+
+        return;
+    }
+
+    pool->parallel_for(candidates.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            candidates[i].cost = objective(candidates[i].x, bound);
+        }
+    });
+}
+
+// Computes a + k * (a - b)
+static std::vector<double> extrapolate(const std::vector<double> &a, const std::vector<double> &b, double k) {
+    std::vector<double> result(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        result[i] = a[i] + k * (a[i] - b[i]);
+    }
+
+    return result;
+}
+
+liftoff::search_result liftoff::grid_search(const objective_fn &objective, const std::vector<double> &lower,
+                                            const std::vector<double> &upper, size_t points, thread_pool *pool) {
+    LIFTOFF_TRACE_SCOPE("grid_search");
+
+    size_t n = lower.size();
+    points = std::max<size_t>(points, 1);
+
+    size_t total = 1;
+    for (size_t i = 0; i < n; ++i) {
+        total *= points;
+    }
+
+    auto point = [&](size_t idx) {
+        std::vector<double> x(n);
+        for (size_t i = 0; i < n; ++i) {
+            size_t k = idx % points;
+            idx /= points;
+
+            x[i] = points == 1 ? lower[i] : lower[i] + (upper[i] - lower[i]) * k / (points - 1);
+        }
+
+        return x;
+    };
+
+    std::vector<double> costs(total);
+    std::atomic<double> best{INFINITY};
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t idx = begin; idx < end; ++idx) {
+            double cost = objective(point(idx), best.load());
+            costs[idx] = cost;
+
+            double cur = best.load();
+            while (cost < cur && !best.compare_exchange_weak(cur, cost)) {
+            }
+        }
+    };
+
+    if (pool == nullptr) {
+        run(0, total);
+    } else {
+        pool->parallel_for(total, 1, run);
+    }
+
+    // A point is only cut short if it is worse than another,
+    // so the first of the lowest costs is exact
+    size_t best_idx = std::min_element(costs.begin(), costs.end()) - costs.begin();
+    return {point(best_idx), costs[best_idx], total};
+}
+
+liftoff::search_result liftoff::nelder_mead(const objective_fn &objective, const std::vector<double> &start,
+                                            const std::vector<double> &step, const nelder_mead_params &params,
+                                            thread_pool *pool) {
+    LIFTOFF_TRACE_SCOPE("nelder_mead");
+
+    size_t n = start.size();
+    bool speculate = pool != nullptr && pool->size() > 1;
+
+    std::vector<vertex> simplex(n + 1, {start, 0});
+    for (size_t i = 0; i < n; ++i) {
+        simplex[i + 1].x[i] += step[i];
+    }
+    evaluate(objective, simplex, INFINITY, pool);
+    size_t evaluations = n + 1;
+
+    auto by_cost = [](const vertex &a, const vertex &b) {
+        return a.cost < b.cost;
+    };
+
+    std::vector<vertex> candidates(4);
+    std::vector<vertex> single(1);
+    while (true) {
+        std::stable_sort(simplex.begin(), simplex.end(), by_cost);
+        const vertex &best = simplex[0];
+        const vertex &worst = simplex[n];
+
+        double spread = 0;
+        for (size_t i = 1; i <= n; ++i) {
+            for (size_t k = 0; k < n; ++k) {
+                spread = std::max(spread, std::abs(simplex[i].x[k] - best.x[k]));
+            }
+        }
+
+        if (evaluations >= params.max_evaluations ||
+            (worst.cost - best.cost <= params.cost_tolerance && spread <= params.step_tolerance)) {
+            break;
+        }
+
+        std::vector<double> centroid(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = 0; k < n; ++k) {
+                centroid[k] += simplex[i].x[k] / n;
+            }
+        }
+
+        // Reflected, expanded, outside and inside contracted
+        // candidates
+        candidates[0].x = extrapolate(centroid, worst.x, NM_REFLECT);
+        candidates[1].x = extrapolate(centroid, worst.x, NM_EXPAND);
+        candidates[2].x = extrapolate(centroid, worst.x, NM_CONTRACT);
+        candidates[3].x = extrapolate(centroid, worst.x, -NM_CONTRACT);
+
+        // Evaluates a candidate unless it already was. Only
+        // the candidates the method takes are counted, so that
+        // it stops at the same point on any number of threads
+        auto cost_of = [&](size_t c) {
+            if (!speculate) {
+                single[0].x = candidates[c].x;
+                evaluate(objective, single, worst.cost, nullptr);
+                candidates[c].cost = single[0].cost;
+            }
+
+            ++evaluations;
+            return candidates[c].cost;
+        };
+
+        if (speculate) {
+            evaluate(objective, candidates, worst.cost, pool);
+        }
+
+        const vertex *accepted = nullptr;
+        double reflected = cost_of(0);
+        if (reflected < best.cost) {
+            accepted = cost_of(1) < reflected ? &candidates[1] : &candidates[0];
+        } else if (reflected < simplex[n - 1].cost) {
+            accepted = &candidates[0];
+        } else if (reflected < worst.cost) {
+            if (cost_of(2) <= reflected) {
+                accepted = &candidates[2];
+            }
+        } else if (cost_of(3) < worst.cost) {
+            accepted = &candidates[3];
+        }
+
+        if (accepted != nullptr) {
+            simplex[n] = *accepted;
+            continue;
+        }
+
+        // Shrink towards the best vertex, whose costs are
+        // all needed exactly
+        std::vector<vertex> shrunk(simplex.begin() + 1, simplex.end());
+        for (vertex &v : shrunk) {
+            v.x = extrapolate(best.x, v.x, -NM_SHRINK);
+        }
+        evaluate(objective, shrunk, INFINITY, pool);
+        evaluations += n;
+        std::copy(shrunk.begin(), shrunk.end(), simplex.begin() + 1);
+    }
+
+    return {simplex[0].x, simplex[0].cost, evaluations};
+}
@@ -0,0 +1,119 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_PARAM_SEARCH_H
+#define LIFTOFF_PHYSICS_PARAM_SEARCH_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace liftoff {
+    class thread_pool;
+
+    /**
+     * The cost of a candidate parameter vector, lower being
+     * better, which may be called from several threads at
+     * once.
+     *
+     * The bound is the cost above which the candidate is of
+     * no use to the search. An objective which accumulates
+     * its cost may stop as soon as it exceeds the bound and
+     * return the partial cost, or any value above the
+     * bound.
+     */
+    typedef std::function<double(const std::vector<double> &x, double bound)> objective_fn;
+
+    /**
+     * @brief The best candidate found by a search.
+     */
+    struct search_result {
+        /**
+         * The parameter vector.
+         */
+        std::vector<double> x;
+        /**
+         * The cost of the parameter vector.
+         */
+        double cost;
+        /**
+         * The number of objective evaluations the search
+         * needed, excluding the speculative ones it did not
+         * use.
+         */
+        size_t evaluations;
+    };
+
+    /**
+     * @brief The tuning of nelder_mead().
+     */
+    struct nelder_mead_params {
+        /**
+         * The maximum number of objective evaluations.
+         */
+        size_t max_evaluations{200};
+        /**
+         * The search stops once the costs of the simplex
+         * are within this of each other...
+         */
+        double cost_tolerance{1e-9};
+        /**
+         * ...and every vertex is within this distance of the
+         * best one in each parameter.
+         */
+        double step_tolerance{1e-9};
+    };
+
+    /**
+     * Evaluates the objective on every point of a regular
+     * grid, spread across the given pool.
+     *
+     * Each evaluation is bounded by the best cost found so
+     * far, and the result is the same however many threads
+     * run the search: ties go to the first point, ordered
+     * with the first parameter varying fastest.
+     *
+     * @param objective the function to minimize
+     * @param lower the lowest value of each parameter
+     * @param upper the highest value of each parameter
+     * @param points the number of points along each
+     * parameter, at least 1, where a single point is placed
+     * at the lowest value
+     * @param pool the pool to evaluate on, or nullptr to
+     * evaluate on the calling thread
+     * @return the best grid point
+     */
+    search_result grid_search(const objective_fn &objective, const std::vector<double> &lower,
+                              const std::vector<double> &upper, size_t points, thread_pool *pool = nullptr);
+
+    /**
+     * Minimizes the objective using the Nelder-Mead simplex
+     * method, starting with a simplex offset from the given
+     * point by the step along each parameter.
+     *
+     * With more than one worker in the pool, the reflected,
+     * expanded and both contracted candidates of each
+     * iteration are evaluated at once, and the vertices of
+     * a shrink in parallel. The candidates other than the
+     * shrunk vertices are bounded by the cost of the worst
+     * vertex, which is all the method compares them to, so
+     * the result is the same however many threads run the
+     * search.
+     *
+     * @param objective the function to minimize
+     * @param start the initial parameter vector
+     * @param step the initial offset of the simplex along
+     * each parameter
+     * @param params the termination criteria
+     * @param pool the pool to evaluate on, or nullptr to
+     * evaluate on the calling thread
+     * @return the best vertex of the final simplex
+     */
+    search_result nelder_mead(const objective_fn &objective, const std::vector<double> &start,
+                              const std::vector<double> &step,
+                              const nelder_mead_params &params = nelder_mead_params{},
+                              thread_pool *pool = nullptr);
+}
+
+#endif // LIFTOFF_PHYSICS_PARAM_SEARCH_H
@@ -0,0 +1,41 @@
+#include "piecewise_polynomial.h"
+
+#include <algorithm>
+
+void liftoff::piecewise_polynomial::add_segment(double begin, double end, const polynomial &poly, double floor) {
+    segments.push_back({begin, end, poly, floor});
+}
+
+size_t liftoff::piecewise_polynomial::size() const {
+    return segments.size();
+}
+
+bool liftoff::piecewise_polynomial::empty() const {
+    return segments.empty();
+}
+
+void liftoff::piecewise_polynomial::clear() {
+    segments.clear();
+}
+
+size_t liftoff::piecewise_polynomial::find(double x) const {
+    // The last segment beginning at or before x
+    auto it = std::upper_bound(segments.begin(), segments.end(), x, [](double value, const segment &seg) {
+        return value < seg.begin;
+    });
+    if (it == segments.begin() || !(x < (it - 1)->end)) {
+        return npos;
+    }
+
+    return it - 1 - segments.begin();
+}
+
+double liftoff::piecewise_polynomial::val(size_t idx, double x) const {
+    const segment &seg = segments[idx];
+    double value = seg.poly.val(x);
+    if (value < seg.floor) {
+        value = seg.floor;
+    }
+
+    return value;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_PIECEWISE_POLYNOMIAL_H
+#define LIFTOFF_PHYSICS_PIECEWISE_POLYNOMIAL_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "polynomial.h"
+
+namespace liftoff {
+    /**
+     * @brief A function made of polynomials, each over its
+     * own half-open interval, which are evaluated only when
+     * a value is asked for.
+     */
+    class piecewise_polynomial {
+    private:
+        /**
+         * @brief A polynomial over [begin, end).
+         */
+        struct segment {
+            /** The lowest value covered by the segment, inclusive. */
+            double begin;
+            /** The end of the covered values, exclusive. */
+            double end;
+            /** The polynomial evaluated over the segment. */
+            polynomial poly;
+            /**
+             * The lowest value returned by the segment.
+             */
+            double floor;
+        };
+
+        /**
+         * The segments ordered by their beginning, which do
+         * not overlap.
+         */
+        std::vector<segment> segments;
+
+    public:
+        /**
+         * The index returned when no segment covers a
+         * value.
+         */
+        static const size_t npos = static_cast<size_t>(-1);
+
+        /**
+         * Appends a segment after every existing one.
+         *
+         * @param begin the lowest value covered by the
+         * segment, which must not be below the end of the
+         * last segment
+         * @param end the value after the highest one covered
+         * by the segment
+         * @param poly the polynomial of the segment
+         * @param floor the values of the polynomial below
+         * this are raised to it
+         */
+        void add_segment(double begin, double end, const polynomial &poly, double floor = -INFINITY);
+
+        /**
+         * Obtains the number of segments.
+         *
+         * @return the segment count
+         */
+        size_t size() const;
+
+        /**
+         * Determines whether there are no segments.
+         *
+         * @return true if there are no segments
+         */
+        bool empty() const;
+
+        /**
+         * Removes every segment.
+         */
+        void clear();
+
+        /**
+         * Finds the segment covering the given value.
+         *
+         * @param x the value to look up
+         * @return the index of the segment, or npos if none
+         * covers it
+         */
+        size_t find(double x) const;
+
+        /**
+         * Evaluates the given segment.
+         *
+         * @param idx the index of the segment
+         * @param x the value at which to evaluate it
+         * @return the value of its polynomial, no lower than
+         * its floor
+         */
+        double val(size_t idx, double x) const;
+    };
+}
+
+#endif // LIFTOFF_PHYSICS_PIECEWISE_POLYNOMIAL_H
@@ -1,27 +1,80 @@
 #include "polynomial.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 // Required precision for floating point values in order to perform the necessary polynomial
 // regressions
 // (pretty sure this is actually around 80, but 256 just to be safe :>)
 static const int REQ_PRECISION = 256;
 
+// Horner's scheme over the n coefficients ordered by lowest power first
+static double horner(const double *coefficients, size_t n, double x) {
+    double val = 0;
+    for (size_t i = n; i-- > 0;) {
+        val = val * x + coefficients[i];
+    }
+
+    return val;
+}
+
+static void horner_batch(const double *coefficients, size_t n, const double *xs, double *out, size_t count) {
+    size_t i = 0;
+    if (n != 0) {
+#if defined(__AVX2__)
+        for (; i + 4 <= count; i += 4) {
+            __m256d x = _mm256_loadu_pd(xs + i);
+            __m256d val = _mm256_set1_pd(coefficients[n - 1]);
+            for (size_t k = n - 1; k-- > 0;) {
+#if defined(__FMA__)
+                val = _mm256_fmadd_pd(val, x, _mm256_set1_pd(coefficients[k]));
+#else
+                val = _mm256_add_pd(_mm256_mul_pd(val, x), _mm256_set1_pd(coefficients[k]));
+#endif
+            }
+
+            _mm256_storeu_pd(out + i, val);
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        for (; i + 2 <= count; i += 2) {
+            float64x2_t x = vld1q_f64(xs + i);
+            float64x2_t val = vdupq_n_f64(coefficients[n - 1]);
+            for (size_t k = n - 1; k-- > 0;) {
+                val = vfmaq_f64(vdupq_n_f64(coefficients[k]), val, x);
+            }
+
+            vst1q_f64(out + i, val);
+        }
+#endif
+    }
+
+    for (; i < count; ++i) {
+        out[i] = horner(coefficients, n, xs[i]);
+    }
+}
+
 liftoff::polynomial::polynomial() = default;
 
-liftoff::polynomial::polynomial(size_t terms) {
+liftoff::polynomial::polynomial(size_t terms) : d_coefficients(terms, 0) {
     coefficients.reserve(terms);
-    for (int i = 0; i < terms; ++i) {
+    for (size_t i = 0; i < terms; ++i) {
         coefficients.emplace_back(0, REQ_PRECISION);
     }
 }
 
 liftoff::polynomial::polynomial(const std::vector<mpf_class> &poly) {
     coefficients.reserve(poly.size());
+    d_coefficients.reserve(poly.size());
     for (const auto &coeff : poly) {
         coefficients.emplace_back(coeff, REQ_PRECISION);
+        d_coefficients.push_back(coeff.get_d());
     }
 }
 
-liftoff::polynomial::polynomial(const std::vector<double> &poly) {
+liftoff::polynomial::polynomial(const std::vector<double> &poly) : d_coefficients(poly) {
     coefficients.reserve(poly.size());
     for (const auto &coeff : poly) {
         coefficients.emplace_back(coeff, REQ_PRECISION);
@@ -30,27 +83,62 @@ liftoff::polynomial::polynomial(const std::vector<double> &poly) {
 
 void liftoff::polynomial::add_term(const mpf_class &coefficient) {
     coefficients.emplace_back(coefficient, REQ_PRECISION);
+    d_coefficients.push_back(coefficient.get_d());
+}
+
+void liftoff::polynomial::assign(const std::vector<mpf_class> &poly) {
+    if (coefficients.size() != poly.size()) {
+        *this = polynomial{poly};
+        return;
+    }
+
+    // Same precision, so the limbs are reused
+    d_coefficients.resize(poly.size());
+    for (size_t i = 0; i < poly.size(); ++i) {
+        coefficients[i] = poly[i];
+        d_coefficients[i] = poly[i].get_d();
+    }
+    d_stale = false;
 }
 
 double liftoff::polynomial::val(double x) const {
-    mpf_class val{0, REQ_PRECISION};
-    for (int i = 0; i < coefficients.size(); ++i) {
-        mpf_class x_pow{x, REQ_PRECISION};
-        mpf_pow_ui(x_pow.get_mpf_t(), x_pow.get_mpf_t(), i);
+    if (d_stale) {
+        double val = 0;
+        for (auto it = coefficients.rbegin(); it != coefficients.rend(); ++it) {
+            val = val * x + it->get_d();
+        }
+
+        return val;
+    }
 
-        val += coefficients[i] * x_pow;
+    return horner(d_coefficients.data(), d_coefficients.size(), x);
+}
+
+void liftoff::polynomial::val_batch(const double *xs, double *out, size_t count) const {
+    if (d_stale) {
+        std::vector<double> cur_coefficients;
+        cur_coefficients.reserve(coefficients.size());
+        for (const auto &coeff : coefficients) {
+            cur_coefficients.push_back(coeff.get_d());
+        }
+
+        horner_batch(cur_coefficients.data(), cur_coefficients.size(), xs, out, count);
+        return;
     }
 
-    return val.get_d();
+    horner_batch(d_coefficients.data(), d_coefficients.size(), xs, out, count);
+}
+
+void liftoff::polynomial::val_batch(const std::vector<double> &xs, std::vector<double> &out) const {
+    out.resize(xs.size());
+    val_batch(xs.data(), out.data(), xs.size());
 }
 
 mpf_class liftoff::polynomial::val(const mpf_class &x) const {
     mpf_class val{0, REQ_PRECISION};
-    for (int i = 0; i < coefficients.size(); ++i) {
-        mpf_class x_pow{x, REQ_PRECISION};
-        mpf_pow_ui(x_pow.get_mpf_t(), x_pow.get_mpf_t(), i);
-
-        val += coefficients[i] * x_pow;
+    for (auto it = coefficients.rbegin(); it != coefficients.rend(); ++it) {
+        val *= x;
+        val += *it;
     }
 
     return val;
@@ -61,6 +149,7 @@ std::vector<mpf_class> liftoff::polynomial::get_coefficients() const {
 }
 
 std::vector<mpf_class>::reference &liftoff::polynomial::operator[](size_t idx) {
+    d_stale = true;
     return coefficients[idx];
 }
 
@@ -69,7 +158,7 @@ std::string liftoff::polynomial::to_matlab(char suffix) const {
     result += suffix;
     result += " = ";
 
-    for (int i = 0; i < coefficients.size(); ++i) {
+    for (size_t i = 0; i < coefficients.size(); ++i) {
         result += std::to_string(coefficients[i].get_d());
         result += "*x";
         result += suffix;
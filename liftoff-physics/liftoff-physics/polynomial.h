@@ -19,6 +19,18 @@ namespace liftoff {
          * first.
          */
         std::vector<mpf_class> coefficients;
+        /**
+         * Double precision copies of the coefficients used
+         * to evaluate the polynomial with hardware floating
+         * point.
+         */
+        std::vector<double> d_coefficients;
+        /**
+         * Whether the double precision coefficients may no
+         * longer match the coefficients because a mutable
+         * reference to one of them was handed out.
+         */
+        bool d_stale{false};
 
     public:
         /**
@@ -63,15 +75,50 @@ namespace liftoff {
          */
         void add_term(const mpf_class &coefficient);
 
+        /**
+         * Replaces the coefficients of this polynomial,
+         * reusing their storage if it has the same number
+         * of terms.
+         *
+         * @param poly the coefficients, from the constant
+         * term up
+         */
+        void assign(const std::vector<mpf_class> &poly);
+
         /**
          * Computes the value of the function with the
-         * given value of X substituted.
+         * given value of X substituted using Horner's scheme
+         * over the double precision coefficients.
          *
          * @param x the function input
          * @return the function output
          */
         double val(double x) const;
 
+        /**
+         * Computes the value of the function for each of
+         * the given values of X. This uses the double
+         * precision coefficients and evaluates several inputs
+         * at once using AVX2 or NEON when the library is
+         * compiled for a target that supports it.
+         *
+         * @param xs the function inputs
+         * @param out the output for the function values,
+         * must hold count values
+         * @param count the number of inputs to evaluate
+         */
+        void val_batch(const double *xs, double *out, size_t count) const;
+
+        /**
+         * Computes the value of the function for each of
+         * the given values of X.
+         *
+         * @param xs the function inputs
+         * @param out the function outputs, resized to the
+         * number of inputs
+         */
+        void val_batch(const std::vector<double> &xs, std::vector<double> &out) const;
+
         /**
          * Computes the value of the function with the
          * given value of X substituted.
@@ -95,6 +142,11 @@ namespace liftoff {
          * Obtains the coefficient at the given order in
          * this polynomial.
          *
+         * Evaluations in double precision fall back to
+         * converting the GMP coefficients on every call after
+         * this is used, so prefer add_term() or the
+         * constructors to build a polynomial.
+         *
          * @param idx the order of the coefficient
          * @return the coefficient value
          */
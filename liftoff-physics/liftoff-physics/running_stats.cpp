@@ -0,0 +1,78 @@
+#include "running_stats.h"
+
+#include <cmath>
+
+void liftoff::running_stats::add(double x) {
+    if (n == 0) {
+        min_value = x;
+        max_value = x;
+    } else {
+        if (x < min_value) {
+            min_value = x;
+        }
+        if (x > max_value) {
+            max_value = x;
+        }
+    }
+
+    ++n;
+    double delta = x - mean;
+    mean += delta / static_cast<double>(n);
+    m2 += delta * (x - mean);
+}
+
+// Chan et al.'s pairwise combination of the partial results
+void liftoff::running_stats::merge(const liftoff::running_stats &other) {
+    if (other.n == 0) {
+        return;
+    }
+
+    if (n == 0) {
+        *this = other;
+        return;
+    }
+
+    auto n_a = static_cast<double>(n);
+    auto n_b = static_cast<double>(other.n);
+    double total = n_a + n_b;
+    double delta = other.mean - mean;
+
+    mean += delta * n_b / total;
+    m2 += other.m2 + delta * delta * n_a * n_b / total;
+    n += other.n;
+
+    if (other.min_value < min_value) {
+        min_value = other.min_value;
+    }
+    if (other.max_value > max_value) {
+        max_value = other.max_value;
+    }
+}
+
+size_t liftoff::running_stats::count() const {
+    return n;
+}
+
+double liftoff::running_stats::get_mean() const {
+    return mean;
+}
+
+double liftoff::running_stats::variance() const {
+    if (n < 2) {
+        return 0;
+    }
+
+    return m2 / static_cast<double>(n - 1);
+}
+
+double liftoff::running_stats::stddev() const {
+    return std::sqrt(variance());
+}
+
+double liftoff::running_stats::get_min() const {
+    return min_value;
+}
+
+double liftoff::running_stats::get_max() const {
+    return max_value;
+}
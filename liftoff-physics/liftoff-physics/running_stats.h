@@ -0,0 +1,104 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_RUNNING_STATS_H
+#define LIFTOFF_PHYSICS_RUNNING_STATS_H
+
+#include <cstddef>
+
+namespace liftoff {
+    /**
+     * @brief Accumulates the mean and variance of a stream
+     * of values in a single pass using Welford's method.
+     *
+     * Accumulators filled on different threads can be
+     * merged, giving the same result as if every value had
+     * been added to one accumulator.
+     */
+    class running_stats {
+    private:
+        /**
+         * The number of values added.
+         */
+        size_t n{0};
+        /**
+         * The mean of the values added.
+         */
+        double mean{0};
+        /**
+         * The sum of squared differences from the mean.
+         */
+        double m2{0};
+        /**
+         * The smallest value added.
+         */
+        double min_value{0};
+        /**
+         * The largest value added.
+         */
+        double max_value{0};
+
+    public:
+        /**
+         * Adds the given value to the statistics.
+         *
+         * @param x the value to add
+         */
+        void add(double x);
+
+        /**
+         * Adds every value accumulated by the given
+         * statistics to these statistics.
+         *
+         * @param other the statistics to merge
+         */
+        void merge(const running_stats &other);
+
+        /**
+         * Obtains the number of values added.
+         *
+         * @return the value count
+         */
+        size_t count() const;
+
+        /**
+         * Obtains the mean of the values added.
+         *
+         * @return the mean, or 0 if there are no values
+         */
+        double get_mean() const;
+
+        /**
+         * Obtains the sample variance of the values added.
+         *
+         * @return the variance, or 0 if there are fewer
+         * than 2 values
+         */
+        double variance() const;
+
+        /**
+         * Obtains the sample standard deviation of the
+         * values added.
+         *
+         * @return the standard deviation
+         */
+        double stddev() const;
+
+        /**
+         * Obtains the smallest value added.
+         *
+         * @return the minimum, or 0 if there are no values
+         */
+        double get_min() const;
+
+        /**
+         * Obtains the largest value added.
+         *
+         * @return the maximum, or 0 if there are no values
+         */
+        double get_max() const;
+    };
+}
+
+#endif // LIFTOFF_PHYSICS_RUNNING_STATS_H
@@ -0,0 +1,196 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_STATIC_DRIVEN_BODY_H
+#define LIFTOFF_PHYSICS_STATIC_DRIVEN_BODY_H
+
+#include <array>
+#include <type_traits>
+
+#include "body.h"
+#include "vector.h"
+
+namespace liftoff {
+    /**
+     * @brief Represents a driven body whose number of
+     * derivatives and driver derivative are fixed at compile
+     * time.
+     *
+     * The motion is held in fixed-size arrays and the
+     * integration and differentiation chains are unrolled,
+     * so stepping neither allocates nor goes through virtual
+     * calls. It steps exactly like a driven_body with the
+     * same derivatives and driver.
+     *
+     * @tparam N the number of derivatives to store
+     * @tparam DriverIdx the index of the derivative that
+     * drives the motion of this body
+     */
+    template<d_idx_t N, d_idx_t DriverIdx>
+    class static_driven_body {
+        static_assert(DriverIdx < N, "The driver must be one of the stored derivatives");
+
+    public:
+        /**
+         * The collection of motion vectors of a body.
+         */
+        typedef std::array<liftoff::vector, N> state_type;
+
+    private:
+        /**
+         * Whether or not the computation has started (i.e.
+         * whether pre_compute() has been called).
+         */
+        bool initial{true};
+        /**
+         * The mass of this body.
+         */
+        double mass;
+        /**
+         * The time step between update calls to the body's
+         * motion.
+         */
+        double time_step;
+        /**
+         * The motion vectors describing the movement of this
+         * body.
+         */
+        state_type d_mot;
+        /**
+         * A snapshot of the motion vectors from the previous
+         * step.
+         */
+        state_type prev_state;
+
+        template<d_idx_t I>
+        void drive_integrals(std::integral_constant<d_idx_t, I>) {
+            // Walking up from the position advances every
+            // integral by its derivative from before this step
+            d_mot[I] += d_mot[I + 1] * time_step;
+            drive_integrals(std::integral_constant<d_idx_t, I + 1>{});
+        }
+
+        void drive_integrals(std::integral_constant<d_idx_t, DriverIdx>) {
+        }
+
+        template<d_idx_t I>
+        void drive_derivatives(std::integral_constant<d_idx_t, I>) {
+            d_mot[I] = (d_mot[I - 1] - prev_state[I - 1]) / time_step;
+            drive_derivatives(std::integral_constant<d_idx_t, I + 1>{});
+        }
+
+        void drive_derivatives(std::integral_constant<d_idx_t, N>) {
+        }
+
+    public:
+        /**
+         * Creates a new body at rest at the origin.
+         *
+         * @param sdb_mass the mass of the body
+         * @param sdb_time_step the time step between calls
+         * to the computation methods
+         */
+        explicit static_driven_body(double sdb_mass, double sdb_time_step = 1) :
+                mass(sdb_mass), time_step(sdb_time_step) {
+        }
+
+        /**
+         * Obtains the mass of this body.
+         *
+         * @return the body mass
+         */
+        double get_mass() const {
+            return mass;
+        }
+
+        /**
+         * Updates the mass for this body.
+         *
+         * @param new_mass the new body mass
+         */
+        void set_mass(double new_mass) {
+            mass = new_mass;
+        }
+
+        /**
+         * Obtains the collection of motion vectors for
+         * this body.
+         *
+         * @return the constant view of motion vectors
+         */
+        const state_type &get_d_mot() const {
+            return d_mot;
+        }
+
+        /**
+         * Sets the motion vector for the given derivative,
+         * updating the higher derivatives if the computation
+         * has started.
+         *
+         * @tparam Derivative the index of the derivative
+         * @param component the new value of the motion
+         * vector
+         */
+        template<d_idx_t Derivative>
+        void set_component(const liftoff::vector &component) {
+            static_assert(Derivative < N, "The derivative must be stored");
+
+            d_mot[Derivative].set(component);
+            if (!initial) {
+                drive_derivatives(std::integral_constant<d_idx_t, Derivative + 1>{});
+            }
+        }
+
+        /**
+         * Sets the position vector of this body.
+         *
+         * @param position the new position
+         */
+        void set_position(const liftoff::vector &position) {
+            set_component<0>(position);
+        }
+
+        /**
+         * Sets the velocity vector of this body.
+         *
+         * @param velocity the new velocity
+         */
+        void set_velocity(const liftoff::vector &velocity) {
+            set_component<1>(velocity);
+        }
+
+        /**
+         * The pre-computation method for updating the
+         * motion derivatives.
+         */
+        void pre_compute() {
+            initial = false;
+        }
+
+        /**
+         * The computation method for updating the motion
+         * derivatives.
+         */
+        void compute_motion() {
+            drive_integrals(std::integral_constant<d_idx_t, 0>{});
+        }
+
+        /**
+         * The post-computation method for updating the
+         * motion derivatives.
+         */
+        void post_compute() {
+            prev_state = d_mot;
+        }
+    };
+
+    /**
+     * @brief A static_driven_body storing up to the jerk
+     * whose motion is controlled by the velocity vector, as
+     * a velocity_driven_body.
+     */
+    typedef static_driven_body<4, 1> static_velocity_driven_body;
+}
+
+#endif // LIFTOFF_PHYSICS_STATIC_DRIVEN_BODY_H
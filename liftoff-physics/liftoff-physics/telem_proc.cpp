@@ -1,59 +1,177 @@
 #include "telem_proc.h"
+#include "trace.h"
 
+#include <algorithm>
 #include <vector>
 
-std::map<double, double>::const_iterator liftoff::find_event_time(std::map<double, double>::const_iterator begin,
-                                                                  const std::map<double, double> &velocities,
-                                                                  bool negative_dv) {
-    double prev_v = begin->second;
-    for (auto it = begin; it != velocities.end(); ++it) {
-        double v = it->second;
+size_t liftoff::find_event_time(size_t begin, const liftoff::time_series &velocities, bool negative_dv) {
+    size_t n = velocities.size();
+    if (begin >= n) {
+        return n;
+    }
+
+    const double *v_data = velocities.value_data();
+    double prev_v = v_data[begin];
+    for (size_t i = begin; i < n; ++i) {
+        double v = v_data[i];
         if (negative_dv && v < prev_v || !negative_dv && v > prev_v) {
-            return it;
+            return i;
         }
 
         prev_v = v;
     }
 
-    return velocities.end();
+    return n;
 }
 
-void liftoff::interp_lin(std::map<double, double> &out, const std::map<double, double> &in) {
-    std::vector<double> st;
+void liftoff::interp_lin(liftoff::time_series &out, const liftoff::time_series &in) {
+    LIFTOFF_TRACE_SCOPE("interp_lin");
+
+    size_t n = in.size();
+    const double *in_t = in.time_data();
+    const double *in_v = in.value_data();
+
+    // Samples [run_begin, i) repeat the last unique value and
+    // are interpolated once the next unique value is found, which
+    // keeps the output written in time order
+    size_t run_begin = 0;
     double last_unique_time = -1;
     double last_unique_value = -1;
 
-    for (auto it = in.begin(); it != in.end(); it++) {
-        double t = it->first;
-        double v = it->second;
-        if (v != last_unique_value || it == --in.end()) {
-            out[t] = v;
-
-            if (!st.empty()) {
+    out.reserve(out.size() + n);
+    for (size_t i = 0; i < n; ++i) {
+        double t = in_t[i];
+        double v = in_v[i];
+        if (v != last_unique_value || i == n - 1) {
+            if (run_begin != i) {
                 double slope = (v - last_unique_value) / (t - last_unique_time);
-                for (const auto &interp_t : st) {
-                    double dt = interp_t - last_unique_time;
-                    out[interp_t] = last_unique_value + slope * dt;
+                for (size_t k = run_begin; k < i; ++k) {
+                    double dt = in_t[k] - last_unique_time;
+                    out.put(in_t[k], last_unique_value + slope * dt);
                 }
-                st.clear();
             }
 
+            out.put(t, v);
+
             last_unique_time = t;
             last_unique_value = v;
+            run_begin = i + 1;
+        }
+    }
+}
+
+void liftoff::channel_interp::interp_columns(size_t n, const double *in_t) {
+    // Same as interp_lin() for each channel, except that the
+    // repeated values are back-filled by index
+    for (channel_run &r : runs) {
+        r.run_begin = 0;
+        r.last_unique_time = -1;
+        r.last_unique_value = -1;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        double t = in_t[i];
+        for (channel_run &r : runs) {
+            double v = r.in_v[i];
+            if (v != r.last_unique_value || i == n - 1) {
+                if (r.run_begin != i) {
+                    double slope = (v - r.last_unique_value) / (t - r.last_unique_time);
+                    for (size_t k = r.run_begin; k < i; ++k) {
+                        double dt = in_t[k] - r.last_unique_time;
+                        r.out_v[k] = r.last_unique_value + slope * dt;
+                    }
+                }
+
+                r.out_v[i] = v;
+
+                r.last_unique_time = t;
+                r.last_unique_value = v;
+                r.run_begin = i + 1;
+            }
+        }
+    }
+}
+
+void liftoff::channel_interp::resample(size_t n, const double *in_t, const double *col) {
+    // Both the grid and the samples are sorted, so the
+    // interval holding each grid time is found by walking
+    // forward
+    grid_values.resize(grid_times.size());
+    size_t i = 0;
+    for (size_t k = 0; k < grid_times.size(); ++k) {
+        double t = grid_times[k];
+        while (i + 2 < n && in_t[i + 1] <= t) {
+            ++i;
+        }
+
+        if (n == 1 || t <= in_t[i]) {
+            grid_values[k] = col[i];
         } else {
-            st.push_back(t);
+            double frac = (t - in_t[i]) / (in_t[i + 1] - in_t[i]);
+            grid_values[k] = col[i] + (col[i + 1] - col[i]) * std::min(frac, 1.0);
+        }
+    }
+}
+
+void liftoff::channel_interp::run(const std::vector<liftoff::time_series *> &out,
+                                  const std::vector<const liftoff::time_series *> &in,
+                                  double grid_step) {
+    LIFTOFF_TRACE_SCOPE("channel_interp");
+
+    if (in.empty()) {
+        return;
+    }
+
+    size_t n = in[0]->size();
+    const double *in_t = in[0]->time_data();
+    if (columns.size() < in.size()) {
+        columns.resize(in.size());
+    }
+
+    // Interpolate every channel on the shared timeline in
+    // one walk over it
+    std::vector<bool> shared(in.size());
+    runs.clear();
+    for (size_t c = 0; c < in.size(); ++c) {
+        shared[c] = in[c]->size() == n &&
+                    (in[c]->time_data() == in_t || std::equal(in_t, in_t + n, in[c]->time_data()));
+        if (shared[c]) {
+            columns[c].resize(n);
+            runs.push_back({in[c]->value_data(), columns[c].data(), 0, -1, -1});
+        }
+    }
+    interp_columns(n, in_t);
+
+    bool resampled = grid_step > 0 && n != 0;
+    if (resampled) {
+        auto count = static_cast<size_t>((in_t[n - 1] - in_t[0]) / grid_step) + 1;
+        grid_times.resize(count);
+        for (size_t k = 0; k < count; ++k) {
+            grid_times[k] = in_t[0] + static_cast<double>(k) * grid_step;
+        }
+    }
+
+    for (size_t c = 0; c < in.size(); ++c) {
+        if (!shared[c]) {
+            out[c]->clear();
+            liftoff::interp_lin(*out[c], *in[c]);
+        } else if (!resampled) {
+            out[c]->assign(in_t, columns[c].data(), n);
+        } else {
+            resample(n, in_t, columns[c].data());
+            out[c]->assign(grid_times.data(), grid_values.data(), grid_times.size());
         }
     }
 }
 
 void liftoff::force(std::vector<std::pair<double, double>> &out,
-                    const std::map<double, double> &in,
+                    const liftoff::time_series &in,
                     const std::vector<double> &times,
                     int count) {
     int added = 0;
     if (count >= 0) {
         for (double t : times) {
-            double value = in.find(t)->second;
+            double value = in.value_at(in.find(t));
             out.emplace_back(t, value);
 
             if (++added == count) {
@@ -63,7 +181,7 @@ void liftoff::force(std::vector<std::pair<double, double>> &out,
     } else {
         for (auto it = times.rbegin(); it != times.rend(); ++it) {
             double t = *it;
-            double value = in.find(t)->second;
+            double value = in.value_at(in.find(t));
             out.emplace_back(t, value);
 
             if (++added == -count) {
@@ -75,8 +193,10 @@ void liftoff::force(std::vector<std::pair<double, double>> &out,
 
 void liftoff::collect(std::vector<std::vector<double>> &times,
                       std::vector<std::vector<double>> &legs,
-                      const std::map<double, double> &in,
+                      const liftoff::time_series &in,
                       const std::vector<double> &event_times) {
+    LIFTOFF_TRACE_SCOPE("collect");
+
     int n_events = event_times.size();
 
     times.reserve(n_events);
@@ -86,9 +206,11 @@ void liftoff::collect(std::vector<std::vector<double>> &times,
         legs.emplace_back();
     }
 
-    for (const auto &it : in) {
-        double t = it.first;
-        double alt = it.second;
+    const double *in_t = in.time_data();
+    const double *in_v = in.value_data();
+    for (size_t k = 0; k < in.size(); ++k) {
+        double t = in_t[k];
+        double alt = in_v[k];
         for (int i = 0; i < n_events; ++i) {
             if (t < event_times[i]) {
                 times[i].push_back(t);
@@ -7,34 +7,132 @@
 #ifndef LIFTOFF_PHYSICS_TELEM_PROC_H
 #define LIFTOFF_PHYSICS_TELEM_PROC_H
 
-#include <map>
 #include <vector>
 
+#include "time_series.h"
+
 namespace liftoff {
     /**
-     * Obtains the iterator pointing to the position of the
-     * event at which the velocity experiences a local min
-     * or max.
+     * Obtains the index of the event at which the velocity
+     * experiences a local min or max.
      *
-     * @param begin the beginning iterator, inclusive
+     * @param begin the beginning index, inclusive
      * @param velocities the velocity values
      * @param negative_dv whether the delta should be
      * negative
-     * @return the pointer to the event, or to the end if
-     * no event was found
+     * @return the index of the event, or velocities.size()
+     * if no event was found
      */
-    std::map<double, double>::const_iterator find_event_time(std::map<double, double>::const_iterator begin,
-                                                             const std::map<double, double> &velocities,
-                                                             bool negative_dv);
+    size_t find_event_time(size_t begin, const liftoff::time_series &velocities, bool negative_dv);
 
     /**
      * Performs linear interpolation between the values
      * which are the same.
      *
-     * @param out the output map
-     * @param in the input map of data to interpolate
+     * @param out the output series
+     * @param in the input series of data to interpolate
+     */
+    void interp_lin(liftoff::time_series &out, const liftoff::time_series &in);
+
+    /**
+     * @brief Performs the same interpolation as
+     * interp_lin() on several channels sharing a timeline
+     * in a single pass over it.
+     *
+     * The channels are interpolated into contiguous columns
+     * which are kept between calls, so interpolating
+     * profiles of a similar size again does not allocate.
+     * The result can optionally be resampled onto a uniform
+     * grid, on which every lookup of a time_series hits the
+     * index it first tries.
      */
-    void interp_lin(std::map<double, double> &out, const std::map<double, double> &in);
+    class channel_interp {
+    private:
+        /**
+         * @brief The interpolation state of a channel while
+         * walking the shared timeline.
+         */
+        struct channel_run {
+            /**
+             * The values of the channel.
+             */
+            const double *in_v;
+            /**
+             * The column to write the interpolated values.
+             */
+            double *out_v;
+            /**
+             * The first sample repeating the last unique
+             * value, which is yet to be interpolated.
+             */
+            size_t run_begin;
+            /**
+             * The time of the last unique value.
+             */
+            double last_unique_time;
+            /**
+             * The last unique value.
+             */
+            double last_unique_value;
+        };
+
+        /**
+         * The interpolated values of each channel over the
+         * shared timeline.
+         */
+        std::vector<std::vector<double>> columns;
+        /**
+         * The state of each channel on the shared timeline.
+         */
+        std::vector<channel_run> runs;
+        /**
+         * The times of the uniform grid.
+         */
+        std::vector<double> grid_times;
+        /**
+         * The values of a channel resampled onto the grid.
+         */
+        std::vector<double> grid_values;
+
+        /**
+         * Interpolates every channel in runs into its
+         * column in a single pass over the shared timeline.
+         *
+         * @param n the number of samples
+         * @param in_t the shared sample times
+         */
+        void interp_columns(size_t n, const double *in_t);
+
+        /**
+         * Resamples a column onto the uniform grid, writing
+         * grid_values.
+         *
+         * @param n the number of samples
+         * @param in_t the shared sample times
+         * @param col the interpolated column
+         */
+        void resample(size_t n, const double *in_t, const double *col);
+
+    public:
+        /**
+         * Interpolates each input channel into the output
+         * channel at the same position, replacing its
+         * samples.
+         *
+         * Channels whose timeline differs from the first
+         * one's are interpolated separately with
+         * interp_lin() and are not resampled.
+         *
+         * @param out the output series of each channel
+         * @param in the input series of each channel
+         * @param grid_step the spacing of the uniform grid to
+         * resample onto starting from the first sample, or 0
+         * to keep the input timeline
+         */
+        void run(const std::vector<liftoff::time_series *> &out,
+                 const std::vector<const liftoff::time_series *> &in,
+                 double grid_step = 0);
+    };
 
     /**
      * Collects points into an indexed collection of event
@@ -49,13 +147,13 @@ namespace liftoff {
      */
     void collect(std::vector<std::vector<double>> &times,
                  std::vector<std::vector<double>> &legs,
-                 const std::map<double, double> &in,
+                 const liftoff::time_series &in,
                  const std::vector<double> &event_times);
 
     /**
      * Collects points into the output vector of points
      * to force fit a polynomial regression based on the
-     * input mapping of values, the time subset and the
+     * input series of values, the time subset and the
      * number points ot select.
      *
      * @param out the output collection
@@ -65,7 +163,7 @@ namespace liftoff {
      * beginning to select, or from the end if negative
      */
     void force(std::vector<std::pair<double, double>> &out,
-               const std::map<double, double> &in,
+               const liftoff::time_series &in,
                const std::vector<double> &times,
                int count);
 }
@@ -0,0 +1,246 @@
+#include "thread_pool.h"
+
+#include "trace.h"
+
+// The number of chunks per worker that parallel_for() aims for when picking the
+// grain size, so that workers which finish early can steal the remainder
+static const size_t CHUNKS_PER_WORKER = 8;
+
+// The pool and the index of the worker running on the current thread, used to
+// submit tasks from a worker to its own queue
+static thread_local const liftoff::thread_pool *current_pool = nullptr;
+static thread_local size_t current_worker = 0;
+
+liftoff::thread_pool::thread_pool(size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+        if (threads == 0) {
+            threads = 1;
+        }
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        queues.emplace_back(new worker_queue);
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&thread_pool::work, this, i);
+    }
+}
+
+liftoff::thread_pool::~thread_pool() {
+    {
+        std::unique_lock<std::mutex> lock{state_mutex};
+        all_done.wait(lock, [this] { return outstanding.load() == 0; });
+        stopping = true;
+    }
+    task_available.notify_all();
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+size_t liftoff::thread_pool::size() const {
+    return workers.size();
+}
+
+void liftoff::thread_pool::submit(std::function<void()> task) {
+    size_t idx;
+    if (current_pool == this) {
+        idx = current_worker;
+    } else {
+        idx = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+
+#ifdef LIFTOFF_ENABLE_TRACE
+    // Stages of the task belong to the submitter's context
+    task = liftoff::trace::bind_context(std::move(task));
+#endif
+
+    // Counted before it is published, so that take() never
+    // drops the count below the number of queued tasks
+    outstanding.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock{state_mutex};
+        queued.fetch_add(1);
+    }
+
+    {
+        worker_queue &queue = *queues[idx];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        queue.tasks.push_back(std::move(task));
+    }
+    task_available.notify_one();
+}
+
+void liftoff::thread_pool::wait() {
+    std::unique_lock<std::mutex> lock{state_mutex};
+    all_done.wait(lock, [this] { return outstanding.load() == 0; });
+
+    if (failure) {
+        std::exception_ptr thrown = failure;
+        failure = nullptr;
+        std::rethrow_exception(thrown);
+    }
+}
+
+void liftoff::thread_pool::parallel_for(size_t count, size_t grain,
+                                        const std::function<void(size_t, size_t)> &body) {
+    if (count == 0) {
+        return;
+    }
+
+    if (grain == 0) {
+        grain = count / (workers.size() * CHUNKS_PER_WORKER);
+        if (grain == 0) {
+            grain = 1;
+        }
+    }
+
+    // Waits for its own chunks only, so that it may be
+    // called from a task while other work is outstanding
+    task_group chunks{*this};
+    for (size_t begin = 0; begin < count; begin += grain) {
+        size_t end = begin + grain < count ? begin + grain : count;
+        chunks.run([&body, begin, end] {
+            body(begin, end);
+        });
+    }
+
+    chunks.wait();
+}
+
+bool liftoff::thread_pool::take(size_t idx, std::function<void()> &task) {
+    {
+        worker_queue &own = *queues[idx];
+        std::lock_guard<std::mutex> lock{own.mutex};
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size(); ++i) {
+        worker_queue &victim = *queues[(idx + i) % queues.size()];
+        std::lock_guard<std::mutex> lock{victim.mutex};
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void liftoff::thread_pool::work(size_t idx) {
+    current_pool = this;
+    current_worker = idx;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{state_mutex};
+            task_available.wait(lock, [this] { return stopping || queued.load() != 0; });
+            if (stopping && queued.load() == 0) {
+                return;
+            }
+        }
+
+        std::function<void()> task;
+        if (!take(idx, task)) {
+            // Another worker got to it first, or it is about
+            // to be published, so wait for the next one
+            continue;
+        }
+        execute(task);
+    }
+}
+
+void liftoff::thread_pool::execute(std::function<void()> &task) {
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock{state_mutex};
+        if (!failure) {
+            failure = std::current_exception();
+        }
+    }
+
+    if (outstanding.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock{state_mutex};
+        all_done.notify_all();
+    }
+}
+
+bool liftoff::task_group::run_pending(group_state &state) {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock{state.mutex};
+        if (state.tasks.empty()) {
+            return false;
+        }
+
+        task = std::move(state.tasks.front());
+        state.tasks.pop_front();
+    }
+
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock{state.mutex};
+        if (!state.failure) {
+            state.failure = std::current_exception();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock{state.mutex};
+    if (--state.pending == 0) {
+        state.done.notify_all();
+    }
+
+    return true;
+}
+
+liftoff::task_group::task_group(thread_pool &tg_pool) : pool(tg_pool), state(std::make_shared<group_state>()) {
+}
+
+liftoff::task_group::~task_group() {
+    std::unique_lock<std::mutex> lock{state->mutex};
+    state->done.wait(lock, [this] { return state->pending == 0; });
+}
+
+void liftoff::task_group::run(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock{state->mutex};
+        state->tasks.push_back(std::move(task));
+        ++state->pending;
+    }
+
+    // Runs one task of the group unless the waiting thread
+    // has already taken them all
+    std::shared_ptr<group_state> shared = state;
+    pool.submit([shared] {
+        run_pending(*shared);
+    });
+}
+
+void liftoff::task_group::wait() {
+    // Every task of this group is either queued, which this
+    // thread runs itself, or already being run by another
+    // thread which will complete it
+    while (run_pending(*state)) {
+    }
+
+    std::unique_lock<std::mutex> lock{state->mutex};
+    state->done.wait(lock, [this] { return state->pending == 0; });
+
+    if (state->failure) {
+        std::exception_ptr thrown = state->failure;
+        state->failure = nullptr;
+        std::rethrow_exception(thrown);
+    }
+}
@@ -0,0 +1,291 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_THREAD_POOL_H
+#define LIFTOFF_PHYSICS_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace liftoff {
+    /**
+     * @brief A fixed set of worker threads which execute
+     * submitted tasks using work stealing.
+     *
+     * Each worker has its own queue. Tasks submitted from a
+     * worker go to the back of its own queue and are taken
+     * from there first, which keeps related work on the
+     * same core, while an idle worker steals from the front
+     * of the other queues.
+     */
+    class thread_pool {
+    private:
+        /**
+         * @brief The tasks queued for a single worker.
+         */
+        struct worker_queue {
+            /**
+             * Guards the tasks.
+             */
+            std::mutex mutex;
+            /**
+             * The queued tasks, the owner works from the back
+             * and thieves from the front.
+             */
+            std::deque<std::function<void()>> tasks;
+        };
+
+        /**
+         * The queue of each worker.
+         */
+        std::vector<std::unique_ptr<worker_queue>> queues;
+        /**
+         * The worker threads.
+         */
+        std::vector<std::thread> workers;
+
+        /**
+         * Guards sleeping and waking the workers and the
+         * threads blocked in wait().
+         */
+        std::mutex state_mutex;
+        /**
+         * Notified when a task is queued or the pool stops.
+         */
+        std::condition_variable task_available;
+        /**
+         * Notified when the last outstanding task completes.
+         */
+        std::condition_variable all_done;
+
+        /**
+         * The number of tasks which are queued but not yet
+         * taken by a worker. Incremented before a task is
+         * pushed and decremented under the queue lock when
+         * it is taken, so it is never 0 while a task is
+         * queued.
+         */
+        std::atomic<size_t> queued{0};
+        /**
+         * The number of tasks which have been submitted but
+         * not yet completed.
+         */
+        std::atomic<size_t> outstanding{0};
+        /**
+         * The queue used for the next task submitted from
+         * outside of the pool.
+         */
+        std::atomic<size_t> next_queue{0};
+        /**
+         * Whether the workers should exit.
+         */
+        bool stopping{false};
+
+        /**
+         * The first exception thrown by a task since the
+         * last call to wait().
+         */
+        std::exception_ptr failure;
+
+        /**
+         * Runs the worker loop for the worker with the given
+         * index.
+         *
+         * @param idx the worker index
+         */
+        void work(size_t idx);
+
+        /**
+         * Takes a task from the given worker's own queue or
+         * steals one from another worker, removing it from
+         * the queued count.
+         *
+         * @param idx the index of the worker looking for a
+         * task
+         * @param task the task to write the result
+         * @return true if a task was taken
+         */
+        bool take(size_t idx, std::function<void()> &task);
+
+        /**
+         * Executes a task taken from the queues, recording
+         * its exception and marking it as completed.
+         *
+         * @param task the task to execute
+         */
+        void execute(std::function<void()> &task);
+
+    public:
+        /**
+         * Starts a pool with the given number of workers.
+         *
+         * @param threads the number of workers, or 0 to use
+         * one per hardware thread
+         */
+        explicit thread_pool(size_t threads = 0);
+
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        /**
+         * Completes every outstanding task and then stops
+         * the workers.
+         */
+        ~thread_pool();
+
+        /**
+         * Obtains the number of workers in this pool.
+         *
+         * @return the worker count
+         */
+        size_t size() const;
+
+        /**
+         * Queues the given task to be executed by one of the
+         * workers.
+         *
+         * @param task the task to execute
+         */
+        void submit(std::function<void()> task);
+
+        /**
+         * Blocks until every submitted task has completed.
+         * This must not be called from a task.
+         *
+         * @throws the first exception thrown by a task
+         * since the last call to wait()
+         */
+        void wait();
+
+        /**
+         * Executes the given body over the range [0, count)
+         * split into chunks of at most grain indices and
+         * waits for all of them to complete.
+         *
+         * The chunks run as a task_group, so this waits for
+         * them only and may be called from a task, e.g. a
+         * dispersion run nested under a mission.
+         *
+         * @param count the number of indices
+         * @param grain the maximum number of indices per
+         * task, or 0 to pick one which gives each worker
+         * several chunks to balance the load
+         * @param body the function called with the
+         * [begin, end) range of each chunk
+         * @throws the first exception thrown by a chunk
+         */
+        void parallel_for(size_t count, size_t grain,
+                          const std::function<void(size_t, size_t)> &body);
+    };
+
+    /**
+     * @brief A set of tasks executed on a thread pool which
+     * can be waited for separately from the rest of the
+     * pool's work.
+     *
+     * Unlike thread_pool::wait(), waiting for a group may be
+     * done from inside of a task: the waiting thread executes
+     * the queued tasks of the group itself until none are
+     * left, so nested groups cannot starve the pool of
+     * workers. It never runs any other work of the pool,
+     * which may block on the task that is waiting.
+     */
+    class task_group {
+    private:
+        /**
+         * @brief The tasks of a group, shared with the pool
+         * tasks which run them, which may only get to run
+         * after the group has completed.
+         */
+        struct group_state {
+            /**
+             * Guards the tasks and the completion state.
+             */
+            std::mutex mutex;
+            /**
+             * Notified when the last task of the group
+             * completes.
+             */
+            std::condition_variable done;
+            /**
+             * The tasks which no thread has taken yet.
+             */
+            std::deque<std::function<void()>> tasks;
+            /**
+             * The number of tasks which have been run but not
+             * yet completed.
+             */
+            size_t pending{0};
+            /**
+             * The first exception thrown by a task of the
+             * group.
+             */
+            std::exception_ptr failure;
+        };
+
+        /**
+         * The pool executing the tasks.
+         */
+        thread_pool &pool;
+        /**
+         * The tasks and the completion state.
+         */
+        std::shared_ptr<group_state> state;
+
+        /**
+         * Takes the oldest queued task of the group and
+         * executes it on the calling thread.
+         *
+         * @param state the state of the group
+         * @return false if there was no queued task
+         */
+        static bool run_pending(group_state &state);
+
+    public:
+        /**
+         * Creates an empty group on the given pool.
+         *
+         * @param tg_pool the pool to execute the tasks on
+         */
+        explicit task_group(thread_pool &tg_pool);
+
+        task_group(const task_group &) = delete;
+
+        task_group &operator=(const task_group &) = delete;
+
+        /**
+         * Waits for the tasks of the group to complete.
+         */
+        ~task_group();
+
+        /**
+         * Queues the given task on the pool as part of this
+         * group.
+         *
+         * @param task the task to execute
+         */
+        void run(std::function<void()> task);
+
+        /**
+         * Blocks until every task of this group has
+         * completed, executing the queued tasks of this
+         * group in the meantime.
+         *
+         * @throws the first exception thrown by a task of
+         * this group
+         */
+        void wait();
+    };
+}
+
+#endif // LIFTOFF_PHYSICS_THREAD_POOL_H
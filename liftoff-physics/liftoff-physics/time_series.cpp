@@ -0,0 +1,189 @@
+#include "time_series.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The number of samples to step from the uniform sampling guess before
+// resorting to a binary search
+static const int MAX_GUESS_WALK = 4;
+
+liftoff::time_series::time_series() = default;
+
+liftoff::time_series liftoff::time_series::view(const double *times, const double *values, size_t size,
+                                                std::shared_ptr<const void> owner) {
+    time_series series;
+    series.view_times = times;
+    series.view_values = values;
+    series.view_size = size;
+    series.view_owner = std::move(owner);
+
+    return series;
+}
+
+bool liftoff::time_series::is_view() const {
+    return view_times != nullptr;
+}
+
+void liftoff::time_series::own() {
+    if (view_times == nullptr) {
+        return;
+    }
+
+    times.assign(view_times, view_times + view_size);
+    values.assign(view_values, view_values + view_size);
+
+    view_times = nullptr;
+    view_values = nullptr;
+    view_size = 0;
+    view_owner.reset();
+}
+
+void liftoff::time_series::reserve(size_t samples) {
+    own();
+    times.reserve(samples);
+    values.reserve(samples);
+}
+
+size_t liftoff::time_series::size() const {
+    return view_times != nullptr ? view_size : times.size();
+}
+
+bool liftoff::time_series::empty() const {
+    return size() == 0;
+}
+
+void liftoff::time_series::clear() {
+    own();
+    times.clear();
+    values.clear();
+}
+
+void liftoff::time_series::assign(const double *new_times, const double *new_values, size_t size) {
+    // The columns may be this series' own, in which case
+    // they only need to be truncated
+    if (new_times != times.data()) {
+        times.assign(new_times, new_times + size);
+    }
+    if (new_values != values.data()) {
+        values.assign(new_values, new_values + size);
+    }
+    times.resize(size);
+    values.resize(size);
+
+    view_times = nullptr;
+    view_values = nullptr;
+    view_size = 0;
+    view_owner.reset();
+}
+
+void liftoff::time_series::put(double time, double value) {
+    own();
+    if (times.empty() || times.back() < time) {
+        times.push_back(time);
+        values.push_back(value);
+        return;
+    }
+
+    size_t idx = lower_bound(time);
+    if (times[idx] == time) {
+        values[idx] = value;
+        return;
+    }
+
+    times.insert(times.begin() + idx, time);
+    values.insert(values.begin() + idx, value);
+}
+
+double liftoff::time_series::time_at(size_t idx) const {
+    return time_data()[idx];
+}
+
+double liftoff::time_series::value_at(size_t idx) const {
+    return value_data()[idx];
+}
+
+void liftoff::time_series::set_value_at(size_t idx, double value) {
+    own();
+    values[idx] = value;
+}
+
+const double *liftoff::time_series::time_data() const {
+    return view_times != nullptr ? view_times : times.data();
+}
+
+const double *liftoff::time_series::value_data() const {
+    return view_values != nullptr ? view_values : values.data();
+}
+
+size_t liftoff::time_series::lower_bound(double time) const {
+    const double *times = time_data();
+    size_t n = size();
+    if (n == 0 || time <= times[0]) {
+        return 0;
+    }
+
+    if (!(time <= times[n - 1])) {
+        return n;
+    }
+
+    // times[0] < time <= times[n - 1] from here on, so the walk
+    // never leaves the series
+
+    // Uniformly sampled data places the time exactly at this
+    // index; jittered data is usually only a sample or two off
+    double span = times[n - 1] - times[0];
+    auto guess = static_cast<size_t>((time - times[0]) / span * static_cast<double>(n - 1));
+    if (guess >= n) {
+        guess = n - 1;
+    }
+
+    for (int i = 0; i < MAX_GUESS_WALK; ++i) {
+        if (times[guess] < time) {
+            if (times[guess + 1] >= time) {
+                return guess + 1;
+            }
+
+            ++guess;
+        } else {
+            if (guess == 0 || times[guess - 1] < time) {
+                return guess;
+            }
+
+            --guess;
+        }
+    }
+
+    return std::lower_bound(times, times + n, time) - times;
+}
+
+size_t liftoff::time_series::find(double time) const {
+    size_t idx = lower_bound(time);
+    if (idx == size() || time_data()[idx] != time) {
+        return npos;
+    }
+
+    return idx;
+}
+
+size_t liftoff::time_series::nearest(double time) const {
+    const double *times = time_data();
+    size_t idx = lower_bound(time);
+    if (idx == size()) {
+        return npos;
+    }
+
+    if (idx != 0 && std::abs(times[idx - 1] - time) < std::abs(times[idx] - time)) {
+        return idx - 1;
+    }
+
+    return idx;
+}
+
+double liftoff::time_series::nearest_value(double time) const {
+    size_t idx = nearest(time);
+    if (idx == npos) {
+        return NAN;
+    }
+
+    return value_data()[idx];
+}
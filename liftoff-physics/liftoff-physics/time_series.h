@@ -0,0 +1,227 @@
+/**
+ * @file
+ */
+
+#ifndef LIFTOFF_PHYSICS_TIME_SERIES_H
+#define LIFTOFF_PHYSICS_TIME_SERIES_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace liftoff {
+    /**
+     * @brief Represents a channel of telemetry values
+     * ordered by time, stored as contiguous columns of
+     * times and values.
+     *
+     * Appending a sample later than every other sample is
+     * amortized O(1). Lookups start from the index that
+     * uniformly sampled data would have (index = t / dt) and
+     * only fall back to a binary search if the samples are
+     * irregular.
+     *
+     * A series can also be a read-only view over columns
+     * owned by someone else, such as a memory mapped file,
+     * in which case the first modification copies them.
+     */
+    class time_series {
+    private:
+        /**
+         * The sorted, unique sample times.
+         */
+        std::vector<double> times;
+        /**
+         * The sample values, parallel to times.
+         */
+        std::vector<double> values;
+
+        /**
+         * The external column of sample times if this series
+         * is a view, otherwise nullptr.
+         */
+        const double *view_times{nullptr};
+        /**
+         * The external column of sample values if this
+         * series is a view.
+         */
+        const double *view_values{nullptr};
+        /**
+         * The number of samples in the external columns.
+         */
+        size_t view_size{0};
+        /**
+         * Keeps the memory backing the external columns
+         * alive for as long as a view refers to it.
+         */
+        std::shared_ptr<const void> view_owner;
+
+        /**
+         * Copies the external columns into owned storage if
+         * this series is a view so that it can be modified.
+         */
+        void own();
+
+    public:
+        /**
+         * Index returned by lookups which find no sample.
+         */
+        static const size_t npos = static_cast<size_t>(-1);
+
+        /**
+         * Creates a new, empty time series.
+         */
+        time_series();
+
+        /**
+         * Creates a read-only view over the given columns of
+         * sample times and values, which must already be
+         * sorted by time with no duplicates.
+         *
+         * @param times the sample times
+         * @param values the sample values
+         * @param size the number of samples
+         * @param owner the handle which keeps the columns
+         * alive
+         * @return the series viewing the columns
+         */
+        static time_series view(const double *times, const double *values, size_t size,
+                                std::shared_ptr<const void> owner);
+
+        /**
+         * Determines whether this series is still a view
+         * over external columns.
+         *
+         * @return true if the samples are not owned
+         */
+        bool is_view() const;
+
+        /**
+         * Reserves storage for the given number of samples.
+         *
+         * @param samples the number of samples to reserve
+         */
+        void reserve(size_t samples);
+
+        /**
+         * Determines the number of samples in this series.
+         *
+         * @return the number of samples
+         */
+        size_t size() const;
+
+        /**
+         * Determines whether this series has no samples.
+         *
+         * @return true if there are no samples
+         */
+        bool empty() const;
+
+        /**
+         * Removes all samples from this series.
+         */
+        void clear();
+
+        /**
+         * Replaces every sample in this series with copies of
+         * the given columns.
+         *
+         * @param new_times the sorted, unique sample times
+         * @param new_values the sample values, parallel to
+         * new_times
+         * @param size the number of samples
+         */
+        void assign(const double *new_times, const double *new_values, size_t size);
+
+        /**
+         * Records the given value at the given time,
+         * replacing the value if a sample already exists at
+         * exactly that time.
+         *
+         * @param time the sample time
+         * @param value the sample value
+         */
+        void put(double time, double value);
+
+        /**
+         * Obtains the time of the sample at the given index.
+         *
+         * @param idx the sample index
+         * @return the sample time
+         */
+        double time_at(size_t idx) const;
+
+        /**
+         * Obtains the value of the sample at the given
+         * index.
+         *
+         * @param idx the sample index
+         * @return the sample value
+         */
+        double value_at(size_t idx) const;
+
+        /**
+         * Replaces the value of the sample at the given
+         * index.
+         *
+         * @param idx the sample index
+         * @param value the new sample value
+         */
+        void set_value_at(size_t idx, double value);
+
+        /**
+         * Obtains the contiguous column of sample times.
+         *
+         * @return the pointer to the first sample time
+         */
+        const double *time_data() const;
+
+        /**
+         * Obtains the contiguous column of sample values.
+         *
+         * @return the pointer to the first sample value
+         */
+        const double *value_data() const;
+
+        /**
+         * Obtains the index of the first sample whose time
+         * is not less than the given time.
+         *
+         * @param time the time to search
+         * @return the sample index, or size() if every
+         * sample is earlier
+         */
+        size_t lower_bound(double time) const;
+
+        /**
+         * Obtains the index of the sample recorded at
+         * exactly the given time.
+         *
+         * @param time the time to search
+         * @return the sample index, or npos if absent
+         */
+        size_t find(double time) const;
+
+        /**
+         * Obtains the index of the sample closest to the
+         * given time, preferring the later sample in a tie.
+         *
+         * @param time the time to search
+         * @return the sample index, or npos if the time is
+         * later than every sample
+         */
+        size_t nearest(double time) const;
+
+        /**
+         * Obtains the value of the sample closest to the
+         * given time.
+         *
+         * @param time the time to search
+         * @return the sample value, or NAN if the time is
+         * later than every sample
+         */
+        double nearest_value(double time) const;
+    };
+}
+
+#endif // LIFTOFF_PHYSICS_TIME_SERIES_H
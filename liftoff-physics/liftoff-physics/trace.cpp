@@ -0,0 +1,344 @@
+#include "trace.h"
+
+#ifdef LIFTOFF_ENABLE_TRACE
+
+#include "gmp_arena.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// The number of events each thread keeps, the oldest ones are overwritten
+static const size_t TRACE_RING_CAPACITY = 1 << 16;
+
+// The allocations made on this thread, counted by the replaced operator new. A
+// plain integer so that counting never allocates. The GMP allocations are
+// counted by the GMP memory functions in gmp_arena.cpp
+static thread_local std::uint64_t thread_allocs = 0;
+
+// The context of this thread, 0 if none was entered
+static thread_local std::uint32_t thread_context = 0;
+
+namespace {
+    /**
+     * @brief A completed stage held in a trace ring.
+     */
+    struct trace_event {
+        const char *name;
+        std::uint32_t context;
+        std::uint64_t begin_ns;
+        std::uint64_t duration_ns;
+        std::uint64_t allocs;
+        std::uint64_t gmp_allocs;
+    };
+
+    /**
+     * @brief The totals of a stage in a context.
+     */
+    struct stage_total {
+        std::uint64_t calls{0};
+        std::uint64_t wall_ns{0};
+        std::uint64_t allocs{0};
+        std::uint64_t gmp_allocs{0};
+    };
+
+    /**
+     * Orders the stages and counters of each context by
+     * name, since the same name may be at different
+     * addresses in different translation units.
+     */
+    struct key_less {
+        bool operator()(const std::pair<std::uint32_t, const char *> &a,
+                        const std::pair<std::uint32_t, const char *> &b) const {
+            if (a.first != b.first) {
+                return a.first < b.first;
+            }
+
+            return std::strcmp(a.second, b.second) < 0;
+        }
+    };
+
+    typedef std::pair<std::uint32_t, const char *> trace_key;
+
+    /**
+     * @brief What a single thread recorded, shared with the
+     * registry so it outlives the thread.
+     */
+    struct thread_state {
+        /**
+         * Guards everything below against the exporters,
+         * the owning thread is the only writer.
+         */
+        std::mutex mutex;
+        std::uint32_t tid{0};
+
+        std::vector<trace_event> ring;
+        size_t ring_next{0};
+        std::uint64_t overwritten{0};
+
+        std::map<trace_key, stage_total, key_less> stages;
+        std::map<trace_key, std::uint64_t, key_less> counters;
+    };
+
+    /**
+     * @brief Every thread state and context label.
+     */
+    struct registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<thread_state>> threads;
+        std::vector<std::string> contexts{""};
+    };
+}
+
+static registry &get_registry() {
+    // Never destroyed, threads may still record while
+    // static objects are destroyed at exit
+    static registry *instance = new registry;
+    return *instance;
+}
+
+static thread_state &get_thread_state() {
+    static thread_local std::shared_ptr<thread_state> state;
+    if (!state) {
+        state = std::make_shared<thread_state>();
+
+        registry &reg = get_registry();
+        std::lock_guard<std::mutex> lock{reg.mutex};
+        state->tid = static_cast<std::uint32_t>(reg.threads.size() + 1);
+        reg.threads.push_back(state);
+    }
+
+    return *state;
+}
+
+static std::uint64_t now_ns() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void *operator new(std::size_t size) {
+    ++thread_allocs;
+
+    while (true) {
+        void *ptr = std::malloc(size != 0 ? size : 1);
+        if (ptr != nullptr) {
+            return ptr;
+        }
+
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc{};
+        }
+        handler();
+    }
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+liftoff::trace::scope::scope(const char *sc_name) :
+        name(sc_name), begin_ns(now_ns()), begin_allocs(thread_allocs),
+        begin_gmp_allocs(liftoff::gmp_heap_allocations()) {
+}
+
+liftoff::trace::scope::~scope() {
+    trace_event event{name, thread_context, begin_ns, now_ns() - begin_ns,
+                      thread_allocs - begin_allocs, liftoff::gmp_heap_allocations() - begin_gmp_allocs};
+
+    // The bookkeeping allocates as well, which is not
+    // counted against the stages enclosing this one
+    std::uint64_t allocs = thread_allocs;
+    thread_state &state = get_thread_state();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    if (state.ring.size() < TRACE_RING_CAPACITY) {
+        state.ring.push_back(event);
+    } else {
+        state.ring[state.ring_next] = event;
+        state.ring_next = (state.ring_next + 1) % TRACE_RING_CAPACITY;
+        ++state.overwritten;
+    }
+
+    stage_total &total = state.stages[trace_key{event.context, name}];
+    ++total.calls;
+    total.wall_ns += event.duration_ns;
+    total.allocs += event.allocs;
+    total.gmp_allocs += event.gmp_allocs;
+
+    thread_allocs = allocs;
+}
+
+liftoff::trace::context_scope::context_scope(const std::string &cs_label) : prev(thread_context) {
+    registry &reg = get_registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+
+    auto it = std::find(reg.contexts.begin(), reg.contexts.end(), cs_label);
+    if (it == reg.contexts.end()) {
+        it = reg.contexts.insert(it, cs_label);
+    }
+    thread_context = static_cast<std::uint32_t>(it - reg.contexts.begin());
+}
+
+liftoff::trace::context_scope::~context_scope() {
+    thread_context = prev;
+}
+
+void liftoff::trace::count(const char *name, std::uint64_t n) {
+    std::uint64_t allocs = thread_allocs;
+    {
+        thread_state &state = get_thread_state();
+        std::lock_guard<std::mutex> lock{state.mutex};
+        state.counters[trace_key{thread_context, name}] += n;
+    }
+    thread_allocs = allocs;
+}
+
+std::function<void()> liftoff::trace::bind_context(std::function<void()> task) {
+    std::uint32_t context = thread_context;
+    return [context, task] {
+        std::uint32_t prev = thread_context;
+        thread_context = context;
+        try {
+            task();
+        } catch (...) {
+            thread_context = prev;
+            throw;
+        }
+        thread_context = prev;
+    };
+}
+
+// Writes the string as a JSON string literal
+static void write_json_string(std::ostream &out, const std::string &str) {
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+bool liftoff::trace::enabled() {
+    return true;
+}
+
+bool liftoff::trace::write_chrome_trace(const std::string &path) {
+    std::ofstream out{path};
+    if (!out) {
+        return false;
+    }
+
+    registry &reg = get_registry();
+    std::lock_guard<std::mutex> reg_lock{reg.mutex};
+
+    // Chrome trace timestamps are in microseconds
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto &state : reg.threads) {
+        std::lock_guard<std::mutex> lock{state->mutex};
+
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << state->tid << ",\"args\":{\"name\":\"thread " << state->tid << "\"}}";
+        first = false;
+
+        for (const trace_event &event : state->ring) {
+            out << ",\n{\"name\":";
+            write_json_string(out, event.name);
+            out << ",\"cat\":";
+            write_json_string(out, reg.contexts[event.context]);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << state->tid
+                << ",\"ts\":" << event.begin_ns / 1e3
+                << ",\"dur\":" << event.duration_ns / 1e3
+                << ",\"args\":{\"allocs\":" << event.allocs
+                << ",\"gmp_allocs\":" << event.gmp_allocs << "}}";
+        }
+    }
+    out << "\n]}\n";
+
+    return static_cast<bool>(out);
+}
+
+void liftoff::trace::print_report(std::ostream &out) {
+    std::map<trace_key, stage_total, key_less> stages;
+    std::map<trace_key, std::uint64_t, key_less> counters;
+    std::uint64_t events = 0;
+    std::uint64_t overwritten = 0;
+
+    registry &reg = get_registry();
+    std::lock_guard<std::mutex> reg_lock{reg.mutex};
+    for (const auto &state : reg.threads) {
+        std::lock_guard<std::mutex> lock{state->mutex};
+        for (const auto &entry : state->stages) {
+            stage_total &total = stages[entry.first];
+            total.calls += entry.second.calls;
+            total.wall_ns += entry.second.wall_ns;
+            total.allocs += entry.second.allocs;
+            total.gmp_allocs += entry.second.gmp_allocs;
+        }
+
+        for (const auto &entry : state->counters) {
+            counters[entry.first] += entry.second;
+        }
+
+        events += state->ring.size() + state->overwritten;
+        overwritten += state->overwritten;
+    }
+
+    out << "Trace: " << events << " stages recorded, " << overwritten << " overwritten in the rings" << std::endl;
+    out << std::left << std::setw(20) << "Context" << std::setw(20) << "Stage" << std::right
+        << std::setw(10) << "Calls" << std::setw(14) << "Wall ms"
+        << std::setw(14) << "Allocs" << std::setw(14) << "GMP allocs" << std::endl;
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    for (const auto &entry : stages) {
+        const std::string &label = reg.contexts[entry.first.first];
+        out << std::left << std::setw(20) << (label.empty() ? "-" : label)
+            << std::setw(20) << entry.first.second << std::right
+            << std::setw(10) << entry.second.calls << std::setw(14) << entry.second.wall_ns / 1e6
+            << std::setw(14) << entry.second.allocs << std::setw(14) << entry.second.gmp_allocs << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+
+    for (const auto &entry : counters) {
+        const std::string &label = reg.contexts[entry.first.first];
+        out << std::left << std::setw(20) << (label.empty() ? "-" : label) << std::setw(20) << entry.first.second
+            << std::right << std::setw(10) << entry.second << std::endl;
+    }
+}
+
+#else
+
+bool liftoff::trace::enabled() {
+    return false;
+}
+
+bool liftoff::trace::write_chrome_trace(const std::string &) {
+    return false;
+}
+
+void liftoff::trace::print_report(std::ostream &) {
+}
+
+#endif
@@ -0,0 +1,172 @@
+/**
+ * @file
+ *
+ * Instrumentation of the hot paths, compiled in only when
+ * LIFTOFF_ENABLE_TRACE is defined. Otherwise the macros
+ * below expand to nothing and their arguments are not
+ * evaluated.
+ *
+ *   - LIFTOFF_TRACE_SCOPE(name) times the rest of the
+ *     enclosing block as the stage with the given name
+ *   - LIFTOFF_TRACE_CONTEXT(label) attributes the stages
+ *     of the rest of the block, including the tasks it
+ *     submits to a thread_pool, to the given label, e.g.
+ *     the name of a mission
+ *   - LIFTOFF_TRACE_COUNT(name, n) adds n to the counter
+ *     with the given name
+ *
+ * Stage and counter names must be string literals.
+ */
+
+#ifndef LIFTOFF_PHYSICS_TRACE_H
+#define LIFTOFF_PHYSICS_TRACE_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace liftoff {
+    namespace trace {
+        /**
+         * Determines whether the library was built with
+         * LIFTOFF_ENABLE_TRACE, in which case the functions
+         * below report what was recorded.
+         *
+         * @return true if tracing is compiled in
+         */
+        bool enabled();
+
+        /**
+         * Writes every event still held in the per-thread
+         * trace rings as Chrome trace event JSON, which
+         * chrome://tracing and the Perfetto UI open.
+         *
+         * @param path the path of the file to write
+         * @return false if tracing is not compiled in or the
+         * file could not be written
+         */
+        bool write_chrome_trace(const std::string &path);
+
+        /**
+         * Prints the wall time, call count, allocations and
+         * GMP allocations of each stage and the value of
+         * each counter, summed over every thread, for each
+         * context.
+         *
+         * The allocations of a stage are the ones made on
+         * the thread that entered it, including those made
+         * by any stages nested in it.
+         *
+         * @param out the stream to print to
+         */
+        void print_report(std::ostream &out);
+
+#ifdef LIFTOFF_ENABLE_TRACE
+        /**
+         * @brief Records the block it lives in as a stage.
+         */
+        class scope {
+        private:
+            /**
+             * The name of the stage.
+             */
+            const char *name;
+            /**
+             * When the stage began, ns since the trace epoch.
+             */
+            std::uint64_t begin_ns;
+            /**
+             * The allocations on this thread when the stage
+             * began.
+             */
+            std::uint64_t begin_allocs;
+            /**
+             * The GMP allocations on this thread when the
+             * stage began.
+             */
+            std::uint64_t begin_gmp_allocs;
+
+        public:
+            /**
+             * Begins the stage with the given name.
+             *
+             * @param sc_name the name of the stage
+             */
+            explicit scope(const char *sc_name);
+
+            scope(const scope &) = delete;
+
+            scope &operator=(const scope &) = delete;
+
+            /**
+             * Ends the stage and records it.
+             */
+            ~scope();
+        };
+
+        /**
+         * @brief Sets the context of the current thread for
+         * the block it lives in.
+         */
+        class context_scope {
+        private:
+            /**
+             * The context which is restored on exit.
+             */
+            std::uint32_t prev;
+
+        public:
+            /**
+             * Enters the context with the given label.
+             *
+             * @param cs_label the label of the context
+             */
+            explicit context_scope(const std::string &cs_label);
+
+            context_scope(const context_scope &) = delete;
+
+            context_scope &operator=(const context_scope &) = delete;
+
+            /**
+             * Restores the previous context.
+             */
+            ~context_scope();
+        };
+
+        /**
+         * Adds to a counter in the current context.
+         *
+         * @param name the name of the counter
+         * @param n the amount to add
+         */
+        void count(const char *name, std::uint64_t n);
+
+        /**
+         * Wraps the given task so that it runs in the
+         * context of the calling thread, whichever thread
+         * runs it.
+         *
+         * @param task the task to wrap
+         * @return the wrapped task
+         */
+        std::function<void()> bind_context(std::function<void()> task);
+#endif
+    }
+}
+
+#ifdef LIFTOFF_ENABLE_TRACE
+#define LIFTOFF_TRACE_CONCAT_(a, b) a##b
+#define LIFTOFF_TRACE_CONCAT(a, b) LIFTOFF_TRACE_CONCAT_(a, b)
+#define LIFTOFF_TRACE_SCOPE(name) \
+    liftoff::trace::scope LIFTOFF_TRACE_CONCAT(liftoff_trace_scope_, __LINE__){name}
+#define LIFTOFF_TRACE_CONTEXT(label) \
+    liftoff::trace::context_scope LIFTOFF_TRACE_CONCAT(liftoff_trace_context_, __LINE__){label}
+#define LIFTOFF_TRACE_COUNT(name, n) liftoff::trace::count(name, n)
+#else
+#define LIFTOFF_TRACE_SCOPE(name) static_cast<void>(0)
+#define LIFTOFF_TRACE_CONTEXT(label) static_cast<void>(0)
+#define LIFTOFF_TRACE_COUNT(name, n) static_cast<void>(0)
+#endif
+
+#endif // LIFTOFF_PHYSICS_TRACE_H
@@ -1,5 +1,4 @@
 #include <string>
-#include <cmath>
 #include "vector.h"
 
 namespace liftoff {
@@ -9,88 +8,77 @@ namespace liftoff {
     vector::vector(double k) : vector(k, k, k) {
     }
 
-    vector::vector(double vec_x, double vec_y, double vec_z) : x(vec_x), y(vec_y), z(vec_z) {
+    vector::vector(double vec_x, double vec_y, double vec_z) : lanes{vec_x, vec_y, vec_z, 0} {
     }
 
     double vector::get_x() const {
-        return x;
+        return lanes[0];
     }
 
     vector &vector::set_x(double new_x) {
-        x = new_x;
+        lanes[0] = new_x;
         return *this;
     }
 
     double vector::get_y() const {
-        return y;
+        return lanes[1];
     }
 
     vector &vector::set_y(double new_y) {
-        y = new_y;
+        lanes[1] = new_y;
         return *this;
     }
 
     double vector::get_z() const {
-        return z;
+        return lanes[2];
     }
 
     vector &vector::set_z(double new_z) {
-        z = new_z;
+        lanes[2] = new_z;
         return *this;
     }
 
     vector &vector::set(const vector &vec) {
-        set_x(vec.x);
-        set_y(vec.y);
-        set_z(vec.z);
-        return *this;
+        return *this = vec;
     }
 
     vector &vector::add(const vector &vec) {
-        set_x(vector::x + vec.x);
-        set_y(vector::y + vec.y);
-        set_z(vector::z + vec.z);
-        return *this;
+        return *this += vec;
     }
 
     vector &vector::sub(const vector &vec) {
-        set_x(vector::x - vec.x);
-        set_y(vector::y - vec.y);
-        set_z(vector::z - vec.z);
-        return *this;
+        return *this -= vec;
     }
 
     vector &vector::mul(const vector &vec) {
-        set_x(vector::x * vec.x);
-        set_y(vector::y * vec.y);
-        set_z(vector::z * vec.z);
+        // The padding lane is left alone, the divisor in
+        // div() would make it NaN
+        for (int i = 0; i < 3; ++i) {
+            lanes[i] *= vec.lanes[i];
+        }
         return *this;
     }
 
     vector &vector::div(const vector &vec) {
-        set_x(vector::x / vec.x);
-        set_y(vector::y / vec.y);
-        set_z(vector::z / vec.z);
+        for (int i = 0; i < 3; ++i) {
+            lanes[i] /= vec.lanes[i];
+        }
         return *this;
     }
 
-    double vector::magnitude() const {
-        return std::sqrt((x * x) + (y * y) + (z * z));
-    }
-
     bool vector::operator==(const vector &rhs) const {
-        return x == rhs.x &&
-               y == rhs.y &&
-               z == rhs.z;
+        return lanes[0] == rhs.lanes[0] &&
+               lanes[1] == rhs.lanes[1] &&
+               lanes[2] == rhs.lanes[2];
     }
 
     vector::operator std::string() const {
         std::string result = "vector(";
-        result += std::to_string(x);
+        result += std::to_string(lanes[0]);
         result += ",";
-        result += std::to_string(y);
+        result += std::to_string(lanes[1]);
         result += ",";
-        result += std::to_string(z);
+        result += std::to_string(lanes[2]);
         result += ")";
 
         return result;
@@ -5,27 +5,170 @@
 #ifndef LIFTOFF_PHYSICS_VECTOR_H
 #define LIFTOFF_PHYSICS_VECTOR_H
 
+#include <cmath>
 #include <string>
 
 namespace liftoff {
+    /**
+     * @brief The base of the vector expression templates,
+     * which are only evaluated, lane by lane in a single
+     * pass, once they are assigned to a vector.
+     *
+     * Every operation is lane-wise, so an expression may
+     * read the vector it is assigned to. An expression
+     * refers to the vectors it operates on, so it must not
+     * outlive the statement which built it, e.g. by being
+     * kept in an auto variable.
+     *
+     * @tparam E the expression type
+     */
+    template<typename E>
+    class vector_expr {
+    public:
+        /**
+         * Evaluates a lane of the expression.
+         *
+         * @param i the lane, 0 through 3
+         * @return the value of the lane
+         */
+        double lane(int i) const {
+            return static_cast<const E &>(*this).lane(i);
+        }
+    };
+
+    class vector;
+
+    /**
+     * @brief The way an expression holds an operand: a
+     * vector by reference, and the nodes of a subexpression,
+     * which are temporaries, by value.
+     */
+    template<typename E>
+    struct vector_operand {
+        typedef const E type;
+    };
+
+    template<>
+    struct vector_operand<vector> {
+        typedef const vector &type;
+    };
+
+    /**
+     * @brief The lane-wise operations of the expressions.
+     */
+    struct vector_add_op {
+        static double apply(double a, double b) {
+            return a + b;
+        }
+    };
+
+    struct vector_sub_op {
+        static double apply(double a, double b) {
+            return a - b;
+        }
+    };
+
+    struct vector_mul_op {
+        static double apply(double a, double b) {
+            return a * b;
+        }
+    };
+
+    struct vector_div_op {
+        static double apply(double a, double b) {
+            return a / b;
+        }
+    };
+
+    /**
+     * @brief The lane-wise operation of two vector
+     * expressions.
+     */
+    template<typename L, typename R, typename Op>
+    class vector_binary : public vector_expr<vector_binary<L, R, Op>> {
+    private:
+        typename vector_operand<L>::type lhs;
+        typename vector_operand<R>::type rhs;
+
+    public:
+        vector_binary(const L &vb_lhs, const R &vb_rhs) : lhs(vb_lhs), rhs(vb_rhs) {
+        }
+
+        double lane(int i) const {
+            return Op::apply(lhs.lane(i), rhs.lane(i));
+        }
+    };
+
+    /**
+     * @brief The operation of each lane of a vector
+     * expression with a scalar.
+     */
+    template<typename E, typename Op>
+    class vector_scalar : public vector_expr<vector_scalar<E, Op>> {
+    private:
+        typename vector_operand<E>::type expr;
+        double k;
+
+    public:
+        vector_scalar(const E &vs_expr, double vs_k) : expr(vs_expr), k(vs_k) {
+        }
+
+        double lane(int i) const {
+            return Op::apply(expr.lane(i), k);
+        }
+    };
+
     /**
      * @brief Represents a tuple of 3 floating-point values
      * in a physical vector.
+     *
+     * The components are packed into 4 lanes so that a
+     * vector is loaded, stored and operated on as a whole
+     * by the SIMD units. The alignment stays at 16 bytes,
+     * which is all that std::allocator honours before
+     * C++17.
      */
-    class vector {
+    class alignas(16) vector : public vector_expr<vector> {
     private:
         /**
-         * X coordinate of the vector.
+         * The X, Y and Z coordinates of the vector, followed
+         * by a padding lane which is always 0.
          */
-        double x;
+        double lanes[4];
+
         /**
-         * Y coordinate of the vector.
+         * Evaluates the given expression into this vector.
+         *
+         * @param expr the expression to evaluate
+         * @param op the operation combining each lane of
+         * this vector with that of the expression
          */
-        double y;
+        template<typename E, typename Op>
+        void evaluate(const vector_expr<E> &expr, Op) {
+            // Evaluated into a local first, which tells the
+            // compiler that the expression may read this
+            // vector but does not alias the result
+            double result[4];
+            for (int i = 0; i < 4; ++i) {
+                result[i] = Op::apply(lanes[i], expr.lane(i));
+            }
+            // A scalar division by 0 or multiplication by an
+            // infinity makes the padding lane NaN
+            result[3] = 0;
+            for (int i = 0; i < 4; ++i) {
+                lanes[i] = result[i];
+            }
+        }
+
         /**
-         * Z coordinate of the vector.
+         * @brief Overwrites each lane with that of the
+         * expression.
          */
-        double z;
+        struct assign_op {
+            static double apply(double, double b) {
+                return b;
+            }
+        };
 
     public:
         /**
@@ -51,6 +194,94 @@ namespace liftoff {
          */
         vector(double vec_x, double vec_y, double vec_z);
 
+        /**
+         * Creates a new vector holding the value of the
+         * given expression.
+         *
+         * @param expr the expression to evaluate
+         */
+        template<typename E>
+        vector(const vector_expr<E> &expr) : lanes{0, 0, 0, 0} {
+            evaluate(expr, assign_op{});
+        }
+
+        /**
+         * Sets this vector to the value of the given
+         * expression.
+         *
+         * @param expr the expression to evaluate
+         * @return the instance of this vector
+         */
+        template<typename E>
+        vector &operator=(const vector_expr<E> &expr) {
+            evaluate(expr, assign_op{});
+            return *this;
+        }
+
+        /**
+         * Adds the value of the given expression to this
+         * vector.
+         *
+         * @param expr the expression to evaluate
+         * @return the instance of this vector
+         */
+        template<typename E>
+        vector &operator+=(const vector_expr<E> &expr) {
+            evaluate(expr, vector_add_op{});
+            return *this;
+        }
+
+        /**
+         * Subtracts the value of the given expression from
+         * this vector.
+         *
+         * @param expr the expression to evaluate
+         * @return the instance of this vector
+         */
+        template<typename E>
+        vector &operator-=(const vector_expr<E> &expr) {
+            evaluate(expr, vector_sub_op{});
+            return *this;
+        }
+
+        /**
+         * Multiplies each component of this vector by the
+         * given scalar.
+         *
+         * @param k the scalar
+         * @return the instance of this vector
+         */
+        vector &operator*=(double k) {
+            for (int i = 0; i < 3; ++i) {
+                lanes[i] *= k;
+            }
+            return *this;
+        }
+
+        /**
+         * Divides each component of this vector by the
+         * given scalar.
+         *
+         * @param k the scalar
+         * @return the instance of this vector
+         */
+        vector &operator/=(double k) {
+            for (int i = 0; i < 3; ++i) {
+                lanes[i] /= k;
+            }
+            return *this;
+        }
+
+        /**
+         * Obtains a lane of this vector, see vector_expr.
+         *
+         * @param i the lane, 0 through 3
+         * @return the value of the lane
+         */
+        double lane(int i) const {
+            return lanes[i];
+        }
+
         /**
          * Obtains the X component of the vector.
          *
@@ -154,7 +385,31 @@ namespace liftoff {
          *
          * @return the vector magnitude
          */
-        double magnitude() const;
+        double magnitude() const {
+            return std::sqrt(magnitude_sq());
+        }
+
+        /**
+         * Obtains the square of the magnitude of this
+         * vector, which skips the square root for
+         * comparisons.
+         *
+         * @return the squared vector magnitude
+         */
+        double magnitude_sq() const {
+            return lanes[0] * lanes[0] + lanes[1] * lanes[1] + lanes[2] * lanes[2];
+        }
+
+        /**
+         * Computes the dot product of this vector with the
+         * given vector.
+         *
+         * @param vec the other vector
+         * @return the dot product
+         */
+        double dot(const vector &vec) const {
+            return lanes[0] * vec.lanes[0] + lanes[1] * vec.lanes[1] + lanes[2] * vec.lanes[2];
+        }
 
         /**
          * Creates a new string representing the values
@@ -174,6 +429,53 @@ namespace liftoff {
          */
         bool operator==(const vector &rhs) const;
     };
+
+    template<typename L, typename R>
+    vector_binary<L, R, vector_add_op> operator+(const vector_expr<L> &lhs, const vector_expr<R> &rhs) {
+        return {static_cast<const L &>(lhs), static_cast<const R &>(rhs)};
+    }
+
+    template<typename L, typename R>
+    vector_binary<L, R, vector_sub_op> operator-(const vector_expr<L> &lhs, const vector_expr<R> &rhs) {
+        return {static_cast<const L &>(lhs), static_cast<const R &>(rhs)};
+    }
+
+    template<typename E>
+    vector_scalar<E, vector_mul_op> operator*(const vector_expr<E> &expr, double k) {
+        return {static_cast<const E &>(expr), k};
+    }
+
+    template<typename E>
+    vector_scalar<E, vector_mul_op> operator*(double k, const vector_expr<E> &expr) {
+        return {static_cast<const E &>(expr), k};
+    }
+
+    template<typename E>
+    vector_scalar<E, vector_div_op> operator/(const vector_expr<E> &expr, double k) {
+        return {static_cast<const E &>(expr), k};
+    }
+
+    template<typename E>
+    vector_scalar<E, vector_mul_op> operator-(const vector_expr<E> &expr) {
+        return {static_cast<const E &>(expr), -1};
+    }
+
+    /**
+     * Builds the expression a * k + c, which is evaluated
+     * lane by lane with the multiply and add fused wherever
+     * the target has FMA and floating point contraction is
+     * enabled (-ffp-contract, the GNU dialect default).
+     *
+     * @param a the scaled vector
+     * @param k the scalar
+     * @param c the added vector
+     * @return the expression
+     */
+    template<typename A, typename C>
+    vector_binary<vector_scalar<A, vector_mul_op>, C, vector_add_op> fma(const vector_expr<A> &a, double k,
+                                                                         const vector_expr<C> &c) {
+        return {vector_scalar<A, vector_mul_op>{static_cast<const A &>(a), k}, static_cast<const C &>(c)};
+    }
 }
 
 #endif // LIFTOFF_PHYSICS_VECTOR_H